@@ -11,6 +11,7 @@ CORE_WASM_EXPORTS = [
     "'_dashql_catalog_drop_script'",
     "'_dashql_catalog_get_statistics'",
     "'_dashql_catalog_flatten'",
+    "'_dashql_catalog_flatten_delta'",
     "'_dashql_parse_vegalite_to_visualize'",
     "'_dashql_script_new'",
     "'_dashql_script_get_catalog_entry_id'",
@@ -1,9 +1,176 @@
+#include <cstring>
+#include <string>
+
 #include "benchmark/benchmark.h"
+#include "dashql/analyzer/completion.h"
 #include "dashql/catalog.h"
+#include "dashql/script.h"
+#include "dashql/text/names.h"
 
 using namespace dashql;
 
-// Schema descriptor benchmarks removed - functionality deprecated
+/// Generate a schema script with many tables and columns
+static std::string generate_schema(size_t table_count, size_t column_count) {
+    std::string out;
+    for (size_t t = 0; t < table_count; ++t) {
+        out += "create table table_" + std::to_string(t) + " (";
+        for (size_t c = 0; c < column_count; ++c) {
+            if (c > 0) out += ", ";
+            out += "column_" + std::to_string(t) + "_" + std::to_string(c) + " integer";
+        }
+        out += ");\n";
+    }
+    return out;
+}
+
+/// Generate a schema descriptor with many tables and columns
+static std::pair<std::unique_ptr<const std::byte[]>, size_t> generate_descriptor(size_t table_count,
+                                                                                size_t column_count) {
+    buffers::catalog::SchemaDescriptorT descriptor;
+    descriptor.database_name = "db";
+    descriptor.schema_name = "schema";
+    for (size_t t = 0; t < table_count; ++t) {
+        auto table = std::make_unique<buffers::catalog::SchemaTableT>();
+        table->table_name = "table_" + std::to_string(t);
+        for (size_t c = 0; c < column_count; ++c) {
+            auto column = std::make_unique<buffers::catalog::SchemaTableColumnT>();
+            column->column_name = "column_" + std::to_string(t) + "_" + std::to_string(c);
+            column->ordinal_position = c;
+            table->columns.push_back(std::move(column));
+        }
+        descriptor.tables.push_back(std::move(table));
+    }
+    flatbuffers::FlatBufferBuilder fb;
+    fb.Finish(buffers::catalog::SchemaDescriptor::Pack(fb, &descriptor));
+    auto buffer = std::make_unique<std::byte[]>(fb.GetSize());
+    std::memcpy(buffer.get(), fb.GetBufferPointer(), fb.GetSize());
+    return {std::move(buffer), fb.GetSize()};
+}
+
+/// Rebuild the name search index of a schema script from scratch
+static void name_index_rebuild(benchmark::State& state) {
+    Catalog catalog;
+    Script schema{catalog};
+    schema.InsertTextAt(0, generate_schema(state.range(0), 20));
+    schema.Analyze();
+    auto& registry = schema.GetScannedScript()->name_registry;
+
+    for (auto _ : state) {
+        NameSearchIndex index{registry};
+        benchmark::DoNotOptimize(index.GetSize());
+    }
+}
+
+/// Derive the name search index of an edited schema script from the previous one
+static void name_index_update(benchmark::State& state) {
+    Catalog catalog;
+    Script schema{catalog};
+    schema.InsertTextAt(0, generate_schema(state.range(0), 20));
+    schema.Analyze();
+    NameSearchIndex previous{schema.GetScannedScript()->name_registry};
+    schema.InsertTextAt(0, "create table edited (edited_column integer);\n");
+    schema.Analyze();
+    auto& registry = schema.GetScannedScript()->name_registry;
+
+    for (auto _ : state) {
+        NameSearchIndex index{registry, previous};
+        benchmark::DoNotOptimize(index.GetSize());
+    }
+}
+
+/// Edit a large schema script and complete in a query that references it
+static void edit_then_complete(benchmark::State& state) {
+    Catalog catalog;
+    Script schema{catalog};
+    schema.InsertTextAt(0, generate_schema(state.range(0), 20));
+    schema.Analyze();
+    catalog.LoadScript(schema, 0);
+
+    std::string_view main_text = "select column_1_ from table_1";
+    Script main{catalog};
+    main.InsertTextAt(0, main_text);
+    main.Analyze();
+    auto cursor_offset = main_text.find(" from");
+    main.MoveCursor(cursor_offset);
+    main.CompleteAtCursor(10);
+
+    std::string_view edit = "-- x\n";
+    bool edited = false;
+    for (auto _ : state) {
+        // Toggle a comment line so that the schema is rescanned and reanalyzed
+        if (edited) {
+            schema.EraseTextRange(0, edit.size());
+        } else {
+            schema.InsertTextAt(0, edit);
+        }
+        edited = !edited;
+        schema.Analyze();
+        catalog.LoadScript(schema, 0);
+        main.MoveCursor(cursor_offset);
+        benchmark::DoNotOptimize(main.CompleteAtCursor(10));
+    }
+}
+
+/// Load a large schema through SQL text
+static void load_schema_script(benchmark::State& state) {
+    auto text = generate_schema(state.range(0), 20);
+    for (auto _ : state) {
+        Catalog catalog;
+        Script schema{catalog};
+        schema.InsertTextAt(0, text);
+        schema.Analyze();
+        catalog.LoadScript(schema, 0);
+        benchmark::DoNotOptimize(schema.GetAnalyzedScript()->GetNameSearchIndex().GetSize());
+    }
+}
+
+/// Load a large schema through a schema descriptor
+static void load_schema_descriptor(benchmark::State& state) {
+    auto [buffer, buffer_size] = generate_descriptor(state.range(0), 20);
+    for (auto _ : state) {
+        state.PauseTiming();
+        auto copy = std::make_unique<std::byte[]>(buffer_size);
+        std::memcpy(copy.get(), buffer.get(), buffer_size);
+        std::span<const std::byte> copy_data{copy.get(), buffer_size};
+        Catalog catalog;
+        state.ResumeTiming();
+
+        catalog.AddDescriptorPool(1, 0);
+        catalog.AddSchemaDescriptor(1, copy_data, std::move(copy), buffer_size);
+        catalog.Iterate([](CatalogEntryID, CatalogEntry& entry) {
+            for (size_t i = 0; i < entry.GetNameSearchIndexCount(); ++i) {
+                benchmark::DoNotOptimize(entry.GetNameSearchIndex(i).GetSize());
+            }
+        });
+    }
+}
+
+/// Complete in a query that references a large descriptor pool
+static void complete_with_descriptor_pool(benchmark::State& state) {
+    Catalog catalog;
+    auto [buffer, buffer_size] = generate_descriptor(state.range(0), 20);
+    std::span<const std::byte> data{buffer.get(), buffer_size};
+    catalog.AddDescriptorPool(1, 0);
+    catalog.AddSchemaDescriptor(1, data, std::move(buffer), buffer_size);
+
+    std::string_view main_text = "select column_1_ from table_1";
+    Script main{catalog};
+    main.InsertTextAt(0, main_text);
+    main.Analyze();
+    auto cursor_offset = main_text.find(" from");
+
+    for (auto _ : state) {
+        main.MoveCursor(cursor_offset);
+        benchmark::DoNotOptimize(main.CompleteAtCursor(10));
+    }
+}
+
+BENCHMARK(name_index_rebuild)->Arg(100)->Arg(1000)->Arg(5000);
+BENCHMARK(name_index_update)->Arg(100)->Arg(1000)->Arg(5000);
+BENCHMARK(edit_then_complete)->Arg(100)->Arg(1000)->Arg(5000);
+BENCHMARK(load_schema_script)->Arg(1000)->Arg(10000)->Arg(100000);
+BENCHMARK(load_schema_descriptor)->Arg(1000)->Arg(10000)->Arg(100000);
+BENCHMARK(complete_with_descriptor_pool)->Arg(1000)->Arg(10000)->Arg(100000);
 
 int main(int argc, char** argv) {
     benchmark::Initialize(&argc, argv);
@@ -0,0 +1,206 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "dashql/analyzer/completion.h"
+#include "dashql/catalog.h"
+#include "dashql/script.h"
+
+using namespace dashql;
+
+/// The number of allocations in this process
+static std::atomic<size_t> allocation_count{0};
+
+void* operator new(size_t size) {
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (auto* ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void* ptr) noexcept { std::free(ptr); }
+void operator delete(void* ptr, size_t) noexcept { std::free(ptr); }
+
+/// The number of completion candidates
+static constexpr size_t COMPLETION_LIMIT = 10;
+
+/// Resolve the directory with the example scripts.
+/// `bazel run` starts the binary in the runfiles of the main repository, DASHQL_EXAMPLES_DIR overrides this.
+static std::filesystem::path get_examples_dir() {
+    if (const char* dir = std::getenv("DASHQL_EXAMPLES_DIR"); dir != nullptr && dir[0] != '\0') {
+        return dir;
+    }
+    return "packages/dashql-app/static/examples";
+}
+
+/// Read a file
+static std::string read_file(const std::filesystem::path& path) {
+    std::ifstream in{path};
+    std::stringstream buffer;
+    buffer << in.rdbuf();
+    return buffer.str();
+}
+
+/// The example workload
+struct Workload {
+    /// The TPC-DS schema
+    std::string tpcds_schema;
+    /// The TPC-H schema
+    std::string tpch_schema;
+    /// The TPC-DS queries
+    std::vector<std::string> tpcds_queries;
+
+    /// Load the workload, returns false if the example scripts are missing
+    bool Load() {
+        auto dir = get_examples_dir();
+        if (!std::filesystem::exists(dir / "tpcds" / "schema.sql")) {
+            return false;
+        }
+        tpcds_schema = read_file(dir / "tpcds" / "schema.sql");
+        tpch_schema = read_file(dir / "tpch" / "schema.sql");
+        std::vector<std::filesystem::path> query_paths;
+        for (auto& entry : std::filesystem::directory_iterator(dir / "tpcds")) {
+            if (entry.path().extension() == ".sql" && entry.path().stem() != "schema") {
+                query_paths.push_back(entry.path());
+            }
+        }
+        std::sort(query_paths.begin(), query_paths.end());
+        for (auto& path : query_paths) {
+            tpcds_queries.push_back(read_file(path));
+        }
+        return true;
+    }
+};
+
+/// Get the workload
+static const Workload* get_workload() {
+    static std::unique_ptr<Workload> workload = []() {
+        auto w = std::make_unique<Workload>();
+        return w->Load() ? std::move(w) : nullptr;
+    }();
+    return workload.get();
+}
+
+/// Load the TPC-DS and TPC-H schemas into a catalog
+static std::vector<std::unique_ptr<Script>> load_schemas(Catalog& catalog, const Workload& workload) {
+    std::vector<std::unique_ptr<Script>> schemas;
+    for (std::string_view text : {std::string_view{workload.tpcds_schema}, std::string_view{workload.tpch_schema}}) {
+        auto& schema = schemas.emplace_back(std::make_unique<Script>(catalog));
+        schema->InsertTextAt(0, text);
+        schema->Analyze();
+        catalog.LoadScript(*schema, schemas.size() - 1);
+    }
+    return schemas;
+}
+
+/// Latencies and allocations of completions
+struct CompletionSamples {
+    /// The latencies in microseconds
+    std::vector<double> latencies;
+    /// The allocations
+    size_t allocations = 0;
+
+    /// Move the cursor and complete, recording the latency and allocations
+    void Complete(Script& script, size_t text_offset) {
+        auto allocations_before = allocation_count.load(std::memory_order_relaxed);
+        auto time_before = std::chrono::steady_clock::now();
+        auto* cursor = script.MoveCursor(text_offset);
+        // Offsets without scanner token cannot be completed
+        if (!cursor->scanner_location.has_value()) {
+            return;
+        }
+        auto completion = script.CompleteAtCursor(COMPLETION_LIMIT);
+        benchmark::DoNotOptimize(completion);
+        auto elapsed = std::chrono::steady_clock::now() - time_before;
+        allocations += allocation_count.load(std::memory_order_relaxed) - allocations_before;
+        latencies.push_back(std::chrono::duration<double, std::micro>(elapsed).count());
+    }
+    /// Get the latency percentile
+    double GetPercentile(double p) const {
+        if (latencies.empty()) return 0;
+        auto idx = static_cast<size_t>(p * static_cast<double>(latencies.size() - 1));
+        return latencies[idx];
+    }
+    /// Report the samples as benchmark counters
+    void Report(benchmark::State& state) {
+        std::sort(latencies.begin(), latencies.end());
+        auto n = static_cast<double>(latencies.size());
+        state.counters["completions"] = n;
+        state.counters["p50_us"] = GetPercentile(0.50);
+        state.counters["p95_us"] = GetPercentile(0.95);
+        state.counters["p99_us"] = GetPercentile(0.99);
+        state.counters["max_us"] = latencies.empty() ? 0 : latencies.back();
+        state.counters["allocs_per_completion"] = n == 0 ? 0 : static_cast<double>(allocations) / n;
+    }
+};
+
+/// Complete at the begin and end of every token in all TPC-DS queries
+static void complete_tpcds_token_sweep(benchmark::State& state) {
+    auto* workload = get_workload();
+    if (!workload) {
+        state.SkipWithError("example scripts not found, set DASHQL_EXAMPLES_DIR");
+        return;
+    }
+    Catalog catalog;
+    auto schemas = load_schemas(catalog, *workload);
+
+    CompletionSamples samples;
+    for (auto _ : state) {
+        for (auto& query : workload->tpcds_queries) {
+            Script script{catalog};
+            script.InsertTextAt(0, query);
+            script.Analyze();
+
+            std::vector<size_t> offsets;
+            script.scanned_script->GetSymbols().ForEach([&](size_t, const parser::Parser::symbol_type& symbol) {
+                offsets.push_back(symbol.location.offset());
+                offsets.push_back(symbol.location.offset() + symbol.location.length());
+            });
+            for (auto offset : offsets) {
+                samples.Complete(script, offset);
+            }
+        }
+    }
+    samples.Report(state);
+}
+
+/// Type every TPC-DS query character by character and complete after every keystroke
+static void complete_tpcds_typing(benchmark::State& state) {
+    auto* workload = get_workload();
+    if (!workload) {
+        state.SkipWithError("example scripts not found, set DASHQL_EXAMPLES_DIR");
+        return;
+    }
+    Catalog catalog;
+    auto schemas = load_schemas(catalog, *workload);
+
+    CompletionSamples samples;
+    for (auto _ : state) {
+        for (auto& query : workload->tpcds_queries) {
+            Script script{catalog};
+            for (size_t i = 0; i < query.size(); ++i) {
+                script.InsertTextAt(i, std::string_view{query}.substr(i, 1));
+                script.Analyze();
+                samples.Complete(script, i + 1);
+            }
+        }
+    }
+    samples.Report(state);
+}
+
+BENCHMARK(complete_tpcds_token_sweep)->Iterations(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(complete_tpcds_typing)->Iterations(1)->Unit(benchmark::kMillisecond);
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+}
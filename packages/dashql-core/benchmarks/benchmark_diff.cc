@@ -0,0 +1,65 @@
+#include <limits>
+#include <memory>
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "dashql/parser/parser.h"
+#include "dashql/parser/scanner.h"
+#include "dashql/script_diff.h"
+#include "dashql/text/rope.h"
+
+using namespace dashql;
+
+/// Generate a script with many statements
+static std::string generate_script(size_t statement_count,
+                                   size_t changed_statement = std::numeric_limits<size_t>::max()) {
+    std::string out;
+    for (size_t i = 0; i < statement_count; ++i) {
+        auto id = std::to_string(i);
+        if (i == changed_statement) {
+            out += "select a_" + id + ", c from t_" + id + " where x = " + id + " and y = 1;\n";
+        } else {
+            out += "select a_" + id + ", b from t_" + id + " where x = " + id + ";\n";
+        }
+    }
+    return out;
+}
+
+/// Parse a script
+static std::shared_ptr<ParsedScript> parse_script(const std::string& text, CatalogEntryID external_id) {
+    rope::Rope rope{1024, text};
+    auto scanned = parser::Scanner::Scan(rope, 0, external_id);
+    return parser::Parser::Parse(scanned);
+}
+
+/// Diff two identical scripts
+static void diff_unchanged(benchmark::State& state) {
+    auto text = generate_script(state.range(0));
+    auto source = parse_script(text, 1);
+    auto target = parse_script(text, 2);
+
+    for (auto _ : state) {
+        ScriptDiff diff{*source, *target};
+        benchmark::DoNotOptimize(diff.Compute().size());
+    }
+}
+
+/// Diff two scripts that differ in a single statement in the middle
+static void diff_single_update(benchmark::State& state) {
+    auto source = parse_script(generate_script(state.range(0)), 1);
+    auto target = parse_script(generate_script(state.range(0), state.range(0) / 2), 2);
+
+    for (auto _ : state) {
+        ScriptDiff diff{*source, *target};
+        benchmark::DoNotOptimize(diff.Compute().size());
+    }
+}
+
+BENCHMARK(diff_unchanged)->Arg(1000)->Arg(10000);
+BENCHMARK(diff_single_update)->Arg(1000)->Arg(10000);
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    benchmark::SetDefaultTimeUnit(benchmark::TimeUnit::kMillisecond);
+    benchmark::RunSpecifiedBenchmarks();
+}
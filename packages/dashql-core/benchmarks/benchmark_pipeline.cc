@@ -1,3 +1,5 @@
+#include <string>
+
 #include "benchmark/benchmark.h"
 #include "dashql/analyzer/completion.h"
 #include "dashql/buffers/index_generated.h"
@@ -649,6 +651,29 @@ static void move_cursor(benchmark::State& state) {
     }
 }
 
+static void move_cursor_large(benchmark::State& state) {
+    // Repeat the query until the script exceeds 1 MB
+    std::string text;
+    while (text.size() < (1 << 20)) {
+        text += main_script;
+    }
+    Catalog catalog;
+    Script main{catalog};
+    main.InsertTextAt(0, text);
+    main.Analyze();
+
+    // Place the cursor after a table ref at the start, in the middle or at the end of the script
+    std::string_view table_ref = ",customer";
+    size_t text_offset = state.range(0) < 2 ? text.find(table_ref, text.size() * state.range(0) / 2)
+                                            : text.rfind(table_ref);
+    text_offset += table_ref.size();
+    main.MoveCursor(text_offset);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(main.MoveCursor(text_offset));
+    }
+}
+
 static void complete_cursor(benchmark::State& state) {
     Catalog catalog;
     Script main{catalog};
@@ -673,6 +698,7 @@ BENCHMARK(scan_query);
 BENCHMARK(parse_query);
 BENCHMARK(analyze_query);
 BENCHMARK(move_cursor);
+BENCHMARK(move_cursor_large)->Arg(0)->Arg(1)->Arg(2);
 BENCHMARK(complete_cursor);
 
 int main(int argc, char** argv) {
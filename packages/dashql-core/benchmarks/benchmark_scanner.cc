@@ -0,0 +1,114 @@
+#include <cctype>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "dashql/parser/grammar/keywords.h"
+#include "dashql/parser/scanner.h"
+#include "dashql/text/rope.h"
+#include "dashql/utils/string_conversion.h"
+
+using namespace dashql;
+
+/// The casing of the benchmark identifiers
+enum Casing { LOWER = 0, UPPER = 1, MIXED = 2 };
+
+/// Get all keywords of the grammar lists in the requested casing
+static std::vector<std::string> get_keywords(Casing casing) {
+    std::vector<std::string> out;
+    for (auto& keyword : parser::Keyword::GetKeywords()) {
+        std::string text{keyword.name};
+        for (size_t i = 0; i < text.size(); ++i) {
+            if (casing == UPPER || (casing == MIXED && i == 0)) {
+                text[i] = static_cast<char>(std::toupper(static_cast<unsigned char>(text[i])));
+            }
+        }
+        out.push_back(std::move(text));
+    }
+    return out;
+}
+
+/// Get identifiers that are not keywords, resembling the column names of DDL scripts
+static std::vector<std::string> get_identifiers(Casing casing) {
+    std::vector<std::string> out;
+    for (auto& keyword : get_keywords(casing)) {
+        out.push_back((casing == LOWER ? "ss_" : "SS_") + keyword + (casing == LOWER ? "_sk" : "_SK"));
+    }
+    return out;
+}
+
+/// Fold and find byte by byte, as the scanner did before
+static void fold_and_find_scalar(benchmark::State& state, const std::vector<std::string>& words) {
+    std::string buffer;
+    for (auto _ : state) {
+        for (auto& word : words) {
+            buffer = word;
+            bool all_lower = true;
+            for (size_t i = 0; i < buffer.size(); ++i) {
+                buffer[i] = tolower_fuzzy(buffer[i]);
+                all_lower &= buffer[i] == word[i];
+            }
+            benchmark::DoNotOptimize(all_lower);
+            benchmark::DoNotOptimize(parser::Keyword::Find(buffer));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * words.size());
+}
+
+/// Fold and find with the vectorized case folding
+static void fold_and_find_vectorized(benchmark::State& state, const std::vector<std::string>& words) {
+    std::string buffer;
+    for (auto _ : state) {
+        for (auto& word : words) {
+            buffer.resize(word.size());
+            bool all_lower = fold_lower_fuzzy(word, buffer.data());
+            std::string_view folded = all_lower ? std::string_view{word} : std::string_view{buffer};
+            benchmark::DoNotOptimize(parser::Keyword::Find(folded));
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * words.size());
+}
+
+static void keywords_scalar(benchmark::State& state) {
+    fold_and_find_scalar(state, get_keywords(static_cast<Casing>(state.range(0))));
+}
+static void keywords_vectorized(benchmark::State& state) {
+    fold_and_find_vectorized(state, get_keywords(static_cast<Casing>(state.range(0))));
+}
+static void identifiers_scalar(benchmark::State& state) {
+    fold_and_find_scalar(state, get_identifiers(static_cast<Casing>(state.range(0))));
+}
+static void identifiers_vectorized(benchmark::State& state) {
+    fold_and_find_vectorized(state, get_identifiers(static_cast<Casing>(state.range(0))));
+}
+
+/// Scan a DDL script with many identifiers
+static void scan_ddl(benchmark::State& state) {
+    auto columns = get_identifiers(static_cast<Casing>(state.range(0)));
+    std::string text;
+    for (size_t t = 0; t < 100; ++t) {
+        text += "CREATE TABLE table_" + std::to_string(t) + " (\n";
+        for (size_t c = 0; c < columns.size(); c += 7) {
+            text += "    " + columns[(c + t) % columns.size()] + " INTEGER NOT NULL,\n";
+        }
+        text += "    PRIMARY KEY (" + columns[t % columns.size()] + ")\n);\n";
+    }
+    rope::Rope rope{1024, text};
+
+    for (auto _ : state) {
+        auto scanned = parser::Scanner::Scan(rope, 0, 1);
+        benchmark::DoNotOptimize(scanned);
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+BENCHMARK(keywords_scalar)->Arg(LOWER)->Arg(UPPER)->Arg(MIXED);
+BENCHMARK(keywords_vectorized)->Arg(LOWER)->Arg(UPPER)->Arg(MIXED);
+BENCHMARK(identifiers_scalar)->Arg(LOWER)->Arg(UPPER)->Arg(MIXED);
+BENCHMARK(identifiers_vectorized)->Arg(LOWER)->Arg(UPPER)->Arg(MIXED);
+BENCHMARK(scan_ddl)->Arg(LOWER)->Arg(UPPER);
+
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    benchmark::RunSpecifiedBenchmarks();
+}
@@ -32,6 +32,9 @@ struct AnalysisState {
     const CatalogEntryID catalog_entry_id;
     /// The catalog
     Catalog& catalog;
+    /// The catalog snapshot.
+    /// All catalog names are resolved against a single catalog version, even if the catalog is modified meanwhile.
+    std::shared_ptr<const CatalogSnapshot> catalog_snapshot;
     /// A dummy emtpy registered name.
     /// Used to construct qualified column and table identifiers and fill the prefix.
     RegisteredName& empty_name;
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <string>
 #include <type_traits>
+#include <unordered_set>
 
 #include "dashql/buffers/index_generated.h"
 #include "dashql/catalog_object.h"
@@ -11,6 +13,41 @@
 
 namespace dashql {
 
+/// The name index lookups of the previous completion of a script.
+///
+/// Consecutive keystrokes usually extend the typed name (`cust` -> `custo` -> `custom`).
+/// The suffixes matching the extended text are then a sub-range of the suffixes that matched before, so the next
+/// completion narrows the cached ranges instead of searching the name indexes of all catalog entries again.
+/// Catalog entries without matches are skipped entirely.
+struct CompletionCache {
+    /// A lookup in the name search index of a catalog entry
+    struct IndexLookup {
+        /// The name search index
+        const CatalogEntry::NameSearchIndex* index;
+        /// The matching suffixes
+        std::span<const NameSearchIndex::Suffix> suffixes;
+    };
+
+    /// The catalog version of the lookups
+    uint64_t catalog_version = 0;
+    /// The statement of the completed symbol
+    std::optional<uint32_t> statement_id;
+    /// The text offset of the completed symbol
+    uint32_t symbol_offset = 0;
+    /// The completion strategy
+    buffers::completion::CompletionStrategy strategy = buffers::completion::CompletionStrategy::DEFAULT;
+    /// The case-folded search text
+    std::string search_text;
+    /// The lookups with matches in catalog entries, in rank order
+    std::vector<IndexLookup> index_lookups;
+    /// Are the lookups valid?
+    bool valid = false;
+    /// The number of completions that reused the lookups
+    size_t hits = 0;
+    /// The number of completions that searched all indexes
+    size_t misses = 0;
+};
+
 struct Completion {
     /// A score value
     using ScoreValueType = uint32_t;
@@ -84,8 +121,11 @@ struct Completion {
     };
     static_assert(std::is_trivially_destructible_v<Candidate>, "Candidates must be trivially destructable");
 
-    /// Helper to find candidates in an index
-    void findCandidatesInIndex(const CatalogEntry::NameSearchIndex& index, bool through_catalog);
+    /// Helper to find candidates among the matching suffixes of an index
+    /// Matches of unknown names are skipped if `known_names_only` is set.
+    void findCandidatesInIndex(const CatalogEntry::NameSearchIndex& index,
+                               std::span<const NameSearchIndex::Suffix> suffixes, bool through_catalog,
+                               bool known_names_only = false);
     /// Determine whether a real token follows the cursor's feed point (the write-front check).
     /// Uses the same feed/insert-vs-replace logic as the keyword suffix probe.
     bool computeHasPostCursorToken() const;
@@ -93,6 +133,8 @@ struct Completion {
    protected:
     /// The script cursor
     const ScriptCursor& cursor;
+    /// The lookups of the previous completion (if any)
+    CompletionCache* cache = nullptr;
     /// The completion strategy
     const buffers::completion::CompletionStrategy strategy;
     /// Is the target qualified?
@@ -103,6 +145,8 @@ struct Completion {
     bool between_symbols = false;
     /// Is there a real token after the cursor's feed point?
     bool has_post_cursor_token = false;
+    /// Search the name indexes of catalog entries in parallel? (native builds only)
+    bool parallel_index_search = false;
     /// The symbol that we are completing.
     /// Note that we sometimes have a choice here between the current and the previous symbol.
     std::optional<ScannedScript::SymbolLocationInfo> target_scanner_symbol;
@@ -124,6 +168,25 @@ struct Completion {
 
     /// The result heap, holding up to k entries
     TopKHeap<Candidate> candidate_heap;
+
+    /// Is pruning of index matches enabled?
+    bool index_match_pruning_enabled = true;
+    /// Prune index matches that cannot reach the top-k candidates?
+    bool prune_index_matches = false;
+    /// The highest name score of the completion strategy
+    ScoreValueType max_name_score = 0;
+    /// Lower bounds of the final candidate scores, holding up to k entries.
+    /// Once full, a new name whose score bound stays below the minimum can never reach the top-k candidates.
+    TopKHeap<ScoreValueType> score_lower_bounds;
+    /// The case-folded names that local candidates or promotions may touch after the index search.
+    /// Their final score is not bounded by the index match, we therefore never prune them.
+    std::unordered_set<std::string> promotable_names;
+    /// A buffer to case-fold names
+    std::string folded_name_buffer;
+    /// The number of pruned index matches
+    size_t pruned_index_matches = 0;
+    /// The number of indexes where only the matches of known names were added
+    size_t pruned_indexes = 0;
     /// The top result candidates
     std::vector<Candidate> top_candidates;
     /// The top candidate names
@@ -143,6 +206,14 @@ struct Completion {
 
     /// Complete after a dot
     void FindCandidatesForNamePath();
+    /// Prepare pruning index matches by their score bound
+    void PrepareIndexMatchPruning();
+    /// Check if an index match for an unknown name cannot reach the top-k candidates
+    bool isPrunableIndexMatch(const RegisteredName& name, CandidateTags candidate_tags);
+    /// Check if the index matches of all unknown names in an index cannot reach the top-k candidates
+    bool isPrunableIndex(const CatalogEntry::NameSearchIndex& index);
+    /// Check if local candidates or promotions may touch a name
+    bool isPromotableName(const RegisteredName& name);
     /// Find the candidates in completion indexes
     void FindCandidatesInIndexes();
     /// Add CTEs, script-local relations, and their output columns from the current semantic scope.
@@ -155,6 +226,8 @@ struct Completion {
                            sx::parser::SymbolSpan target_location_qualified);
     /// Read the identifier prefix to the left of the cursor in the current scanner symbol.
     std::string_view ReadTargetPrefix() const;
+    /// Read the text that is searched in the name indexes
+    std::string_view ReadSearchText() const;
     /// Promote identifiers that are in the current name scope of in the same statement
     void PromoteIdentifiersInScope();
     /// Promote tables that contain column names that are still unresolved in the current statement
@@ -198,12 +271,17 @@ struct Completion {
     auto& GetHeap() const { return candidate_heap; }
     /// Get the result candidates after finishing
     auto& GetResultCandidates() const { return top_candidates; }
+    /// Get the number of index matches that were pruned
+    auto GetPrunedIndexMatchCount() const { return pruned_index_matches; }
+    /// Get the number of indexes where only the matches of known names were added
+    auto GetPrunedIndexCount() const { return pruned_indexes; }
 
     /// Pack the completion result
     flatbuffers::Offset<buffers::completion::Completion> Pack(flatbuffers::FlatBufferBuilder& builder);
 
     // Compute completion at a cursor (throws Exception on error)
-    static std::unique_ptr<Completion> Compute(const ScriptCursor& cursor, size_t k);
+    static std::unique_ptr<Completion> Compute(const ScriptCursor& cursor, size_t k, CompletionCache* cache = nullptr,
+                                               bool prune_index_matches = true, bool parallel_index_search = false);
 
 };
 
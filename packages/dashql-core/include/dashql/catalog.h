@@ -3,22 +3,31 @@
 #include <flatbuffers/buffer.h>
 #include <flatbuffers/flatbuffer_builder.h>
 
+#include <atomic>
+#include <cassert>
+#include <deque>
 #include <functional>
 #include <limits>
+#include <memory>
+#include <mutex>
 #include <optional>
 #include <span>
+#include <string>
 #include <string_view>
 #include <tuple>
 #include <variant>
+#include <vector>
 
+#include "ankerl/unordered_dense.h"
 #include "dashql/buffers/index_generated.h"
 #include "dashql/catalog_object.h"
 #include "dashql/external.h"
 #include "dashql/text/names.h"
 #include "dashql/utils/btree/map.h"
-#include "dashql/utils/btree/set.h"
 #include "dashql/utils/chunk_buffer.h"
 #include "dashql/utils/hash.h"
+#include "dashql/utils/persistent_hash_map.h"
+#include "dashql/utils/persistent_map.h"
 #include "dashql/utils/string_conversion.h"
 
 namespace dashql {
@@ -49,7 +58,7 @@ class CatalogEntry {
     using NameID = uint32_t;
     using Rank = uint32_t;
 
-    using NameSearchIndex = btree::multimap<fuzzy_ci_string_view, std::reference_wrapper<const RegisteredName>>;
+    using NameSearchIndex = dashql::NameSearchIndex;
 
     /// A qualified table name
     struct QualifiedTableName {
@@ -234,6 +243,44 @@ class CatalogEntry {
         /// Pack as FlatBuffer
         flatbuffers::Offset<buffers::analyzer::TableColumn> Pack(flatbuffers::FlatBufferBuilder& builder) const;
     };
+    struct TableDeclaration;
+    /// The table columns of all tables of an entry in a columnar layout.
+    ///
+    /// Wide schemas declare millions of columns, a column vector and a hash map per table and a multimap per entry
+    /// dominated the memory of the catalog. The store keeps the columns of all tables in chunks where every table
+    /// owns a contiguous range. Column names are interned into dense name ids, the name ids, the order of every
+    /// table range and the order of all columns by name are contiguous arrays of 32 bit integers.
+    struct TableColumnStore {
+        /// The columns of all tables.
+        /// The columns of a table are contiguous and never move since they are referenced.
+        ChunkBuffer<TableColumn, 64> columns;
+        /// The ids of the distinct column names, assigned in insertion order
+        ankerl::unordered_dense::map<std::string_view, uint32_t> name_ids;
+        /// The name ids of the columns
+        std::vector<uint32_t> column_name_ids;
+        /// The column indices of every table range, ordered by <name id, column index>
+        std::vector<uint32_t> table_column_order;
+        /// The positions of all columns, ordered by <name id, position>
+        std::vector<uint32_t> columns_by_name;
+
+        /// Append the columns of a table, links the columns to the table.
+        /// The columns are moved into the store, the table refers to them afterwards.
+        void AppendTable(TableDeclaration& table, std::span<TableColumn> table_columns);
+        /// Order all columns by name, called once the tables of the entry were appended
+        void IndexByName();
+        /// Find a column in the range of a table, returns the column index
+        std::optional<uint32_t> FindColumn(uint32_t begin, uint32_t count, std::string_view name) const;
+        /// Find the positions of all columns with a name
+        std::span<const uint32_t> FindColumns(std::string_view name) const;
+        /// Get the column at a position
+        const TableColumn& GetColumn(uint32_t position) const { return columns[position]; }
+        /// Get the number of columns
+        size_t GetSize() const { return columns.GetSize(); }
+        /// Get the number of bytes of the columns
+        size_t GetColumnByteSize() const;
+        /// Get the number of bytes of the name ids and the column orders
+        size_t GetIndexByteSize() const;
+    };
     /// A table declaration
     struct TableDeclaration : public CatalogObject {
         /// The catalog version
@@ -252,11 +299,12 @@ class CatalogEntry {
         std::optional<uint32_t> ast_scope_root;
         /// The table name
         QualifiedTableName table_name;
-        /// The table columns
-        std::vector<TableColumn> table_columns;
-        /// A mini hash map of all columns.
-        /// Maintaining this spares us from loading all table columns into a naming scope
-        ankerl::unordered_dense::map<std::string_view, std::reference_wrapper<TableColumn>> table_columns_by_name;
+        /// The table columns, owned by the column store of the entry
+        std::span<TableColumn> table_columns;
+        /// The column store of the entry, null as long as the table has no columns
+        const TableColumnStore* column_store = nullptr;
+        /// The begin of the column range in the column store
+        uint32_t column_store_begin = 0;
 
         /// Constructor
         TableDeclaration(QualifiedCatalogObjectID schema, CatalogTableID table, QualifiedTableName table_name)
@@ -265,6 +313,8 @@ class CatalogEntry {
               table_name(std::move(table_name)) {}
         /// Get the table id
         CatalogTableID GetTableID() const { return object_id.UnpackTableID(); }
+        /// Find a column by name
+        const TableColumn* FindColumn(std::string_view column_name) const;
         /// Pack as FlatBuffer
         flatbuffers::Offset<buffers::analyzer::Table> Pack(flatbuffers::FlatBufferBuilder& builder) const;
     };
@@ -351,12 +401,11 @@ class CatalogEntry {
     /// This can be done through a prefix search in this btree.
     btree::multimap<std::pair<std::string_view, std::string_view>, std::reference_wrapper<const TableDeclaration>>
         tables_by_unqualified_schema;
-    /// The table columns indexed by the name.
-    /// Key: (column)
+    /// The table columns of all tables.
     ///
     /// During SQL completion, we also want to find out what tables a column *might* come from.
     /// This is a more costly completion since a columns names might occur in many tables which are not yet in scope.
-    std::unordered_multimap<std::string_view, std::reference_wrapper<const TableColumn>> table_columns_by_name;
+    TableColumnStore table_column_store;
     /// The function declarations
     ChunkBuffer<FunctionDeclaration, 16> function_declarations;
     /// Functions indexed by qualified name
@@ -366,7 +415,7 @@ class CatalogEntry {
     std::unordered_multimap<std::string_view, std::reference_wrapper<const FunctionDeclaration>>
         functions_by_unqualified_name;
     /// The name search index.
-    /// This name search index stores suffixes of all registered names.
+    /// This name search index stores the sorted suffixes of all registered names.
     std::optional<CatalogEntry::NameSearchIndex> name_search_index;
 
    public:
@@ -389,8 +438,8 @@ class CatalogEntry {
     auto& GetTables() const { return table_declarations; }
     /// Get the table declarations by name
     auto& GetTablesByName() const { return tables_by_qualified_name; }
-    /// Get the table columns by name
-    auto& GetTableColumnsByName() const { return table_columns_by_name; }
+    /// Get the table column store
+    auto& GetTableColumnStore() const { return table_column_store; }
     /// Get the function declarations
     auto& GetFunctions() const { return function_declarations; }
     /// Get the functions by qualified name
@@ -399,8 +448,13 @@ class CatalogEntry {
     /// Describe the catalog entry
     virtual flatbuffers::Offset<buffers::catalog::CatalogEntry> DescribeEntry(
         flatbuffers::FlatBufferBuilder& builder) const = 0;
-    /// Get the name search index
-    virtual const NameSearchIndex& GetNameSearchIndex() = 0;
+    /// Get the number of name search indexes.
+    /// Entries that consist of segments keep a separate index per segment.
+    virtual size_t GetNameSearchIndexCount() const { return 1; }
+    /// Get a name search index
+    virtual const NameSearchIndex& GetNameSearchIndex(size_t index = 0) = 0;
+    /// Collect the entries that hold the declarations, the entry itself unless it consists of segments
+    virtual void CollectSegments(std::vector<const CatalogEntry*>& out) const { out.push_back(this); }
 
     virtual ~CatalogEntry() = default;
 
@@ -416,25 +470,166 @@ class CatalogEntry {
     void ResolveSchemaTablesWithCatalog(
         std::string_view database_name, std::string_view schema_name,
         std::vector<std::pair<std::reference_wrapper<const CatalogEntry::TableDeclaration>, bool>>& out) const;
+    /// Collect the tables with a <schema, database> key in [lb, ub]
+    virtual void CollectTablesInSchema(
+        std::pair<std::string_view, std::string_view> lb, std::pair<std::string_view, std::string_view> ub,
+        std::vector<std::pair<std::reference_wrapper<const CatalogEntry::TableDeclaration>, bool>>& out,
+        bool through_catalog) const;
+    /// Find a table by qualified name <database, schema, table>
+    virtual const TableDeclaration* FindQualifiedTable(const QualifiedTableName::Key& table_name) const;
     /// Resolve a table by id
-    const TableDeclaration* ResolveTableById(CatalogTableID table_id) const;
+    virtual const TableDeclaration* ResolveTableById(CatalogTableID table_id) const;
     /// Resolve a table by qualified name <database, schema, table>
     void ResolveTable(QualifiedTableName table_name, std::vector<std::reference_wrapper<const TableDeclaration>>& out,
                       size_t limit) const;
     /// Resolve a table by ambiguous name with schema <schema, table>
-    void ResolveTableInSchema(std::string_view schema_name, std::string_view table_name,
-                              std::vector<std::reference_wrapper<const TableDeclaration>>& out, size_t limit) const;
+    virtual void ResolveTableInSchema(std::string_view schema_name, std::string_view table_name,
+                                      std::vector<std::reference_wrapper<const TableDeclaration>>& out,
+                                      size_t limit) const;
     /// Resolve a table by ambiguous name with only the table name <table>
-    void ResolveTableEverywhere(std::string_view table_name,
-                                std::vector<std::reference_wrapper<const TableDeclaration>>& out, size_t limit) const;
+    virtual void ResolveTableEverywhere(std::string_view table_name,
+                                        std::vector<std::reference_wrapper<const TableDeclaration>>& out,
+                                        size_t limit) const;
     /// Find table columns by name
-    void ResolveTableColumns(std::string_view table_column, std::vector<TableColumn>& out) const;
+    virtual void ResolveTableColumns(std::string_view table_column, std::vector<TableColumn>& out) const;
     /// Find table columns by name
     void ResolveTableColumnsWithCatalog(std::string_view table_column, std::vector<TableColumn>& out) const;
 };
 
+/// A catalog entry that is loaded from schema descriptors.
+///
+/// Large schemas are expensive to load through SQL text since we'd render CREATE TABLE statements just to scan,
+/// parse and analyze them again. Descriptor pools bypass the text entirely and build the table declarations and
+/// the name registry straight from the descriptor FlatBuffers. The pool owns the descriptor buffers, all registered
+/// names are views into them.
+///
+/// The declarations live in segments that are shared with the clones of the pool.
+/// Catalog snapshots may still read a segment while descriptors are added, the catalog then appends a new segment
+/// instead of modifying the shared one. Adjacent segments are merged once the newer one is at least half as large
+/// as the older one, a pool therefore consists of O(log n) segments and every table is merged O(log n) times.
+class DescriptorPool : public CatalogEntry {
+    friend class Catalog;
+
+   public:
+    /// A descriptor buffer
+    struct DescriptorBuffer {
+        /// The buffer, shared with the clones of the pool
+        std::shared_ptr<const std::byte[]> buffer;
+        /// The buffer size
+        size_t buffer_size;
+    };
+    /// A segment of the pool
+    class Segment : public CatalogEntry {
+        friend class Catalog;
+        friend class DescriptorPool;
+
+       protected:
+        /// The id of the first table, tables are numbered across the segments of a pool
+        uint32_t first_table_id;
+        /// The schema descriptors
+        std::vector<std::reference_wrapper<const buffers::catalog::SchemaDescriptor>> descriptors;
+        /// The descriptor buffers
+        std::vector<DescriptorBuffer> descriptor_buffers;
+        /// The name registry
+        NameRegistry name_registry;
+        /// The name search index before the last descriptors were added.
+        /// The registry only grows, so the next index can be derived from it.
+        std::optional<CatalogEntry::NameSearchIndex> previous_name_search_index;
+
+        /// Add a schema descriptor, the descriptor must have been validated before
+        const SchemaReference& AddSchemaDescriptor(const buffers::catalog::SchemaDescriptor& descriptor,
+                                                   QualifiedCatalogObjectID database_id,
+                                                   QualifiedCatalogObjectID schema_id);
+        /// Get the weight that decides about merging segments
+        size_t GetWeight() const { return descriptors.size() + table_declarations.GetSize(); }
+        /// Merge adjacent segments into a new one.
+        /// The declarations keep their object ids and catalog versions, the segments themselves are not modified.
+        static std::shared_ptr<Segment> Merge(std::span<const std::shared_ptr<Segment>> segments);
+
+       public:
+        /// Constructor
+        Segment(Catalog& catalog, CatalogEntryID external_id, uint32_t first_table_id);
+
+        /// Get the id of the first table
+        auto GetFirstTableID() const { return first_table_id; }
+        /// Get the schema descriptors
+        auto& GetDescriptors() const { return descriptors; }
+        /// Get the descriptor buffers
+        auto& GetDescriptorBuffers() const { return descriptor_buffers; }
+        /// Get the name registry
+        auto& GetNameRegistry() const { return name_registry; }
+
+        /// Describe the catalog entry
+        flatbuffers::Offset<buffers::catalog::CatalogEntry> DescribeEntry(
+            flatbuffers::FlatBufferBuilder& builder) const override;
+        /// Get the name search index
+        const NameSearchIndex& GetNameSearchIndex(size_t index = 0) override;
+        /// Resolve a table by id
+        const TableDeclaration* ResolveTableById(CatalogTableID table_id) const override;
+    };
+
+   protected:
+    /// The rank
+    CatalogEntry::Rank rank;
+    /// The segments, ordered by their first table id
+    std::vector<std::shared_ptr<Segment>> segments;
+
+    /// Get a segment that may be modified, appends a segment if the last one is shared
+    Segment& GetWritableSegment();
+    /// Merge the last segments as long as the last one is at least half as large as the one before.
+    /// Returns the merged segments that were replaced.
+    std::vector<std::shared_ptr<Segment>> CompactSegments();
+    /// Contains a schema?
+    bool ContainsSchema(std::string_view database_name, std::string_view schema_name) const;
+    /// Clone the pool.
+    /// Catalog snapshots may still read a pool while descriptors are added, the catalog then modifies a clone.
+    /// The clone shares all segments with the pool.
+    std::shared_ptr<DescriptorPool> Clone() const;
+
+   public:
+    /// Constructor
+    DescriptorPool(Catalog& catalog, CatalogEntryID external_id, CatalogEntry::Rank rank);
+
+    /// Get the rank
+    auto GetRank() const { return rank; }
+    /// Get the segments
+    auto& GetSegments() const { return segments; }
+
+    /// Describe the catalog entry
+    flatbuffers::Offset<buffers::catalog::CatalogEntry> DescribeEntry(
+        flatbuffers::FlatBufferBuilder& builder) const override;
+    /// Get the number of name search indexes
+    size_t GetNameSearchIndexCount() const override { return segments.size(); }
+    /// Get the name search index of a segment
+    const NameSearchIndex& GetNameSearchIndex(size_t index = 0) override;
+    /// Collect the segments
+    void CollectSegments(std::vector<const CatalogEntry*>& out) const override;
+    /// Collect the tables with a <schema, database> key in [lb, ub]
+    void CollectTablesInSchema(
+        std::pair<std::string_view, std::string_view> lb, std::pair<std::string_view, std::string_view> ub,
+        std::vector<std::pair<std::reference_wrapper<const CatalogEntry::TableDeclaration>, bool>>& out,
+        bool through_catalog) const override;
+    /// Find a table by qualified name <database, schema, table>
+    const TableDeclaration* FindQualifiedTable(const QualifiedTableName::Key& table_name) const override;
+    /// Resolve a table by id
+    const TableDeclaration* ResolveTableById(CatalogTableID table_id) const override;
+    /// Resolve a table by ambiguous name with schema <schema, table>
+    void ResolveTableInSchema(std::string_view schema_name, std::string_view table_name,
+                              std::vector<std::reference_wrapper<const TableDeclaration>>& out,
+                              size_t limit) const override;
+    /// Resolve a table by ambiguous name with only the table name <table>
+    void ResolveTableEverywhere(std::string_view table_name,
+                                std::vector<std::reference_wrapper<const TableDeclaration>>& out,
+                                size_t limit) const override;
+    /// Find table columns by name
+    void ResolveTableColumns(std::string_view table_column, std::vector<TableColumn>& out) const override;
+};
+
+class CatalogSnapshot;
+
 class Catalog {
     friend class CatalogEntry;
+    friend class CatalogSnapshot;
 
    protected:
     /// A catalog entry backed by an analyzed script
@@ -453,6 +648,24 @@ class Catalog {
         /// The id of the schema
         QualifiedCatalogObjectID catalog_schema_id;
     };
+    /// The statistics of the table resolution caches
+    struct TableResolutionStatistics {
+        /// The number of resolutions served from a cache
+        std::atomic<size_t> hits = 0;
+        /// The number of resolutions that missed a cache
+        std::atomic<size_t> misses = 0;
+        /// The number of snapshots that were replaced with memoized resolutions
+        std::atomic<size_t> invalidations = 0;
+    };
+    /// A table declaration referenced through the unqualified table name
+    struct CatalogTableEntryInfo {
+        /// The rank of the catalog entry
+        CatalogEntry::Rank rank;
+        /// The id of the catalog entry
+        CatalogEntryID catalog_entry_id;
+        /// The table declaration
+        std::reference_wrapper<const CatalogEntry::TableDeclaration> table;
+    };
 
    public:
     /// A database declaration
@@ -491,43 +704,81 @@ class Catalog {
         SchemaDeclaration& operator=(SchemaDeclaration&&) = default;
     };
 
+    /// A flattened catalog entry
+    struct FlatEntryFragment {
+        /// The version at which the entry was last modified when flattening it
+        CatalogVersion catalog_version;
+        /// The flat catalog of the entry
+        flatbuffers::DetachedBuffer buffer;
+    };
+    /// The maximum number of dropped entries that are remembered for catalog deltas
+    static constexpr size_t MAX_DROPPED_ENTRIES = 1024;
+
    protected:
     /// The catalog version.
     /// Every modification bumps the version counter, the analyzer reads the version counter which protects all refs.
-    CatalogVersion version = 1;
+    std::atomic<CatalogVersion> version = 1;
+    /// The mutex.
+    /// Modifications hold the mutex, readers only take it to pin the latest snapshot.
+    mutable std::mutex mutex;
+    /// The latest snapshot, built lazily by the first reader after a modification
+    mutable std::shared_ptr<const CatalogSnapshot> snapshot;
+    /// The statistics of the table resolution caches
+    mutable TableResolutionStatistics table_resolution_statistics;
 
     /// The catalog entries
     std::unordered_map<CatalogEntryID, CatalogEntry*> entries;
     /// The script entries
     std::unordered_map<Script*, ScriptEntry> script_entries;
+    /// The descriptor pool entries
+    std::unordered_map<CatalogEntryID, std::shared_ptr<DescriptorPool>> descriptor_pool_entries;
+    /// The catalog entries, shared with the snapshots that pin them.
+    ///
+    /// The catalog-wide indexes are persistent, snapshots share their nodes with the catalog.
+    /// Pinning a snapshot is O(1) and every modification only copies the index paths of the keys it touches.
+    PersistentHashMap<CatalogEntryID, std::shared_ptr<CatalogEntry>> shared_entries;
     /// The entries ordered by <rank>
-    btree::set<std::tuple<CatalogEntry::Rank, CatalogEntryID>> entries_ranked;
+    PersistentSet<std::tuple<CatalogEntry::Rank, CatalogEntryID>> entries_ranked;
     /// The entries ordered by <database, schema, rank, entry>
-    btree::map<std::tuple<std::string_view, std::string_view, CatalogEntry::Rank, CatalogEntryID>,
-               CatalogSchemaEntryInfo>
+    PersistentMap<std::tuple<std::string_view, std::string_view, CatalogEntry::Rank, CatalogEntryID>,
+                  CatalogSchemaEntryInfo>
         entries_by_qualified_schema;
     /// The entries ordered by <schema, rank, entry>.
     /// We need this index during dot completion if the user provided us only with `<schema>.<table>`.
-    btree::map<std::tuple<std::string_view, CatalogEntry::Rank, CatalogEntryID>, CatalogSchemaEntryInfo>
+    PersistentMap<std::tuple<std::string_view, CatalogEntry::Rank, CatalogEntryID>, CatalogSchemaEntryInfo>
         entries_by_schema;
-
-    /// The next database id
-    CatalogDatabaseID next_database_id = INITIAL_DATABASE_ID;
-    /// The next schema id
-    CatalogSchemaID next_schema_id = INITIAL_SCHEMA_ID;
+    /// The table declarations of all entries by unqualified table name, ordered by <rank, entry>.
+    /// Unqualified table references would otherwise probe every catalog entry, a miss is now a single hash lookup.
+    /// The names are owned by the index since a dropped entry may have provided the key for the remaining ones.
+    PersistentHashMap<std::string, std::vector<CatalogTableEntryInfo>, StringHasher> tables_by_unqualified_name;
+
+    /// The next database id, analyses allocate ids concurrently through their snapshots
+    mutable std::atomic<CatalogDatabaseID> next_database_id = INITIAL_DATABASE_ID;
+    /// The next schema id, analyses allocate ids concurrently through their snapshots
+    mutable std::atomic<CatalogSchemaID> next_schema_id = INITIAL_SCHEMA_ID;
     /// The next entry id
     CatalogEntryID next_entry_id = INITIAL_ENTRY_ID;
     /// The databases.
-    /// The btrees contain all the databases that are currently referenced by catalog entries.
-    btree::map<std::string_view, std::unique_ptr<DatabaseDeclaration>> databases;
+    /// The trees contain all the databases that are currently referenced by catalog entries.
+    PersistentMap<std::string_view, std::shared_ptr<const DatabaseDeclaration>> databases;
     /// The schemas.
-    /// These btrees contain all the schemas that are currently referenced by catalog entries.
+    /// These trees contain all the schemas that are currently referenced by catalog entries.
     /// Ordered by <database, schema>
-    btree::map<std::pair<std::string_view, std::string_view>, std::unique_ptr<SchemaDeclaration>> schemas;
+    PersistentMap<std::pair<std::string_view, std::string_view>, std::shared_ptr<const SchemaDeclaration>> schemas;
+
+    /// The versions at which the entries were last modified
+    std::unordered_map<CatalogEntryID, CatalogVersion> entry_versions;
+    /// The dropped entries as <version, entry>, ordered by version
+    std::deque<std::pair<CatalogVersion, CatalogEntryID>> dropped_entries;
+    /// The oldest version that deltas can be computed from.
+    /// Deltas since older versions would miss dropped entries that are no longer remembered.
+    CatalogVersion delta_base_version = 0;
+    /// The flattened entries, rebuilt when an entry was modified after flattening it
+    mutable std::unordered_map<CatalogEntryID, FlatEntryFragment> flat_fragments;
 
     /// Update a script entry.
-    /// Updating a script performs work in the order of |databases + schemas| in the script.
-    /// NOT in |tables| or |columns| or |names|
+    /// Updating a script performs work in the order of |databases + schemas + tables| in the script.
+    /// NOT in |columns| or |names|. The tables are only re-indexed by their unqualified name.
     ///
     /// It is not super cheap, but still significantly cheaper than the analysis passes.
     /// Updating a script regularly if it contains table declarations is not a problem.
@@ -536,6 +787,26 @@ class Catalog {
     /// search indexes. The completion is actually paying |catalog_entries| since we're checking
     /// the name index of every qualifying catalog entry during completion.
     buffers::status::StatusCode UpdateScript(ScriptEntry& entry);
+    /// Index the unqualified names of the table declarations of an entry, starting at a declaration
+    void IndexUnqualifiedTableNames(const CatalogEntry& entry, CatalogEntry::Rank rank, size_t first_table = 0);
+    /// Drop the unqualified names of the table declarations of an entry from the index
+    void DropUnqualifiedTableNames(const CatalogEntry& entry);
+    /// Mark the latest snapshot as outdated, the caller holds the mutex
+    void InvalidateSnapshot();
+    /// Remember that an entry was added or modified in the current version, the caller holds the mutex
+    void MarkEntryModified(CatalogEntryID entry_id);
+    /// Remember that an entry was dropped in the current version, the caller holds the mutex
+    void MarkEntryDropped(CatalogEntryID entry_id);
+    /// Flatten catalog entries.
+    /// The entries are given in ranked order, the first table declaration with a qualified name wins.
+    static flatbuffers::Offset<buffers::catalog::FlatCatalog> FlattenEntries(
+        flatbuffers::FlatBufferBuilder& builder, CatalogVersion catalog_version,
+        std::span<const CatalogEntry* const> ranked_entries);
+    /// Add schema descriptors to a descriptor pool.
+    /// All descriptors are validated before the first one is added, a failing batch leaves the pool untouched.
+    void AddSchemaDescriptors(std::shared_ptr<DescriptorPool>& pool,
+                              std::span<const buffers::catalog::SchemaDescriptor* const> descriptors,
+                              std::unique_ptr<const std::byte[]> descriptor_buffer, size_t descriptor_buffer_size);
 
    public:
     /// Explicit constructor needed due to deleted copy constructor
@@ -547,6 +818,9 @@ class Catalog {
 
     /// Get the current version of the registry
     uint64_t GetVersion() const { return version; }
+    /// Pin the latest snapshot of the catalog.
+    /// Snapshots stay consistent while the catalog is modified and may be read from any thread.
+    std::shared_ptr<const CatalogSnapshot> GetSnapshot() const;
     /// Get the databases
     auto& GetDatabases() const { return databases; }
     /// Get the schemas ordered by <database, schema>
@@ -599,15 +873,33 @@ class Catalog {
                                                                             size_t external_id) const;
     /// Flatten the catalog
     flatbuffers::Offset<buffers::catalog::FlatCatalog> Flatten(flatbuffers::FlatBufferBuilder& builder) const;
+    /// Flatten the entries that changed since a catalog version.
+    /// Every entry is flattened separately and the fragments are cached until the entry is modified again.
+    /// Clients drop the listed entries first and then replace the updated ones.
+    flatbuffers::Offset<buffers::catalog::FlatCatalogDelta> FlattenDelta(flatbuffers::FlatBufferBuilder& builder,
+                                                                         CatalogVersion since_version) const;
+    /// Get the cached flat fragment of an entry, if there is one
+    const FlatEntryFragment* GetFlatFragment(CatalogEntryID id) const;
 
     /// Add a script (throws Exception on error)
     void LoadScript(Script& script, CatalogEntry::Rank rank);
     /// Drop a script
     void DropScript(Script& script);
+    /// Add a descriptor pool (throws Exception on error)
+    void AddDescriptorPool(CatalogEntryID external_id, CatalogEntry::Rank rank);
+    /// Drop a descriptor pool
+    void DropDescriptorPool(CatalogEntryID external_id);
+    /// Add a schema descriptor to a descriptor pool (throws Exception on error)
+    void AddSchemaDescriptor(CatalogEntryID external_id, std::span<const std::byte> descriptor_data,
+                             std::unique_ptr<const std::byte[]> descriptor_buffer, size_t descriptor_buffer_size);
+    /// Add multiple schema descriptors to a descriptor pool (throws Exception on error)
+    void AddSchemaDescriptors(CatalogEntryID external_id, std::span<const std::byte> descriptors_data,
+                              std::unique_ptr<const std::byte[]> descriptor_buffer, size_t descriptor_buffer_size);
 
     /// Resolve a table by id
     const CatalogEntry::TableDeclaration* ResolveTable(CatalogTableID table_id) const;
-    /// Resolve a table by id
+    /// Resolve a table by name in the latest snapshot.
+    /// Resolutions are memoized until the catalog version changes.
     void ResolveTable(CatalogEntry::QualifiedTableName table_name, CatalogEntryID ignore_entry,
                       std::vector<std::reference_wrapper<const CatalogEntry::TableDeclaration>>& out,
                       size_t limit) const;
@@ -615,4 +907,108 @@ class Catalog {
     std::unique_ptr<buffers::catalog::CatalogStatisticsT> GetStatistics();
 };
 
+/// An immutable snapshot of the catalog.
+///
+/// Analyses pin a snapshot and resolve all names against a single catalog version while the host keeps modifying
+/// the catalog. Snapshots share the catalog entries and the nodes of the persistent catalog-wide indexes, the catalog
+/// copies an index node only when a snapshot still reads it. Modified entries are never changed in place, scripts
+/// publish a new analyzed script and descriptor pools are cloned if a snapshot still reads them. Readers therefore
+/// only take a lock to pin the snapshot.
+class CatalogSnapshot {
+    friend class Catalog;
+
+   public:
+    using ResolvedTables = std::vector<std::reference_wrapper<const CatalogEntry::TableDeclaration>>;
+
+   protected:
+    /// The memoized table resolutions of the snapshot.
+    /// Notebooks resolve the same table names in many statements, only the first resolution walks the indexes.
+    /// Analyses may share a snapshot, the cache is therefore synchronized.
+    struct TableResolutionCache {
+        /// The maximum number of memoized resolutions
+        static constexpr size_t MAX_ENTRIES = 16 * 1024;
+        /// The mutex
+        std::mutex mutex;
+        /// The resolved tables, keyed by the encoded name, the ignored entry and the limit
+        ankerl::unordered_dense::map<std::string, ResolvedTables, StringHasher, std::equal_to<>> resolutions;
+        /// The buffer for encoding keys
+        std::string key_buffer;
+    };
+
+    /// The catalog
+    const Catalog& catalog;
+    /// The catalog version
+    CatalogVersion version;
+    /// The catalog entries, pinned by the snapshot
+    PersistentHashMap<CatalogEntryID, std::shared_ptr<CatalogEntry>> entries;
+    /// The entries ordered by <rank>
+    PersistentSet<std::tuple<CatalogEntry::Rank, CatalogEntryID>> entries_ranked;
+    /// The entries ordered by <database, schema, rank, entry>
+    PersistentMap<std::tuple<std::string_view, std::string_view, CatalogEntry::Rank, CatalogEntryID>,
+                  Catalog::CatalogSchemaEntryInfo>
+        entries_by_qualified_schema;
+    /// The entries ordered by <schema, rank, entry>
+    PersistentMap<std::tuple<std::string_view, CatalogEntry::Rank, CatalogEntryID>, Catalog::CatalogSchemaEntryInfo>
+        entries_by_schema;
+    /// The table declarations of all entries by unqualified table name, ordered by <rank, entry>
+    PersistentHashMap<std::string, std::vector<Catalog::CatalogTableEntryInfo>, StringHasher>
+        tables_by_unqualified_name;
+    /// The databases
+    PersistentMap<std::string_view, std::shared_ptr<const Catalog::DatabaseDeclaration>> databases;
+    /// The schemas ordered by <database, schema>
+    PersistentMap<std::pair<std::string_view, std::string_view>, std::shared_ptr<const Catalog::SchemaDeclaration>>
+        schemas;
+    /// The table resolution cache
+    mutable TableResolutionCache table_resolution_cache;
+
+    /// Resolve a table by name without consulting the resolution cache
+    void ResolveTableWithoutCache(CatalogEntry::QualifiedTableName table_name, CatalogEntryID ignore_entry,
+                                  ResolvedTables& out, size_t limit) const;
+
+   public:
+    /// Constructor, shares the entries and the indexes of the catalog
+    CatalogSnapshot(const Catalog& catalog);
+    /// Snapshots must not be copied
+    CatalogSnapshot(const CatalogSnapshot& other) = delete;
+    /// Snapshots must not be copy-assigned
+    CatalogSnapshot& operator=(const CatalogSnapshot& other) = delete;
+
+    /// Get the catalog version of the snapshot
+    CatalogVersion GetVersion() const { return version; }
+    /// Get the databases
+    auto& GetDatabases() const { return databases; }
+    /// Get the schemas ordered by <database, schema>
+    auto& GetSchemas() const { return schemas; }
+    /// Contains an entry id?
+    bool Contains(CatalogEntryID id) const { return entries.contains(id); }
+    /// Iterate all entries in arbitrary order
+    template <typename Fn> void Iterate(Fn f) const {
+        entries.ForEach([&](CatalogEntryID entry_id, const std::shared_ptr<CatalogEntry>& entry) {
+            f(entry_id, *entry);
+        });
+    }
+    /// Iterate entries in ranked order
+    template <typename Fn> void IterateRanked(Fn f) const {
+        for (auto& [rank, id] : entries_ranked) {
+            auto* entry = entries.find(id);
+            assert(entry);
+            f(id, **entry, rank);
+        }
+    }
+    /// Register a database name.
+    /// Unknown databases draw a new id from the catalog.
+    QualifiedCatalogObjectID AllocateDatabaseId(std::string_view database) const;
+    /// Register a schema name
+    /// Unknown schemas draw a new id from the catalog.
+    QualifiedCatalogObjectID AllocateSchemaId(std::string_view database, std::string_view schema,
+                                              QualifiedCatalogObjectID db_id) const;
+    /// Resolve a table by id
+    const CatalogEntry::TableDeclaration* ResolveTable(CatalogTableID table_id) const;
+    /// Resolve a table by name, resolutions are memoized
+    void ResolveTable(CatalogEntry::QualifiedTableName table_name, CatalogEntryID ignore_entry, ResolvedTables& out,
+                      size_t limit) const;
+    /// Get the number of memoized resolutions
+    size_t GetMemoizedResolutionCount() const;
+};
+
 }  // namespace dashql
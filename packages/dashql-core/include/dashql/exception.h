@@ -57,6 +57,8 @@ class Exception : public std::exception {
                 return "Table name in schema descriptor is null or empty";
             case buffers::status::StatusCode::CATALOG_DESCRIPTOR_TABLE_NAME_COLLISION:
                 return "Schema descriptor contains a duplicate table name";
+            case buffers::status::StatusCode::CATALOG_DESCRIPTOR_INVALID:
+                return "Schema descriptor buffer is malformed";
             case buffers::status::StatusCode::COMPLETION_MISSES_CURSOR:
                 return "Completion requires a script cursor";
             case buffers::status::StatusCode::COMPLETION_MISSES_SCANNER_TOKEN:
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <initializer_list>
+#include <limits>
 #include <span>
 #include <string>
 #include <utility>
@@ -9,6 +10,7 @@
 #include "dashql/buffers/index_generated.h"
 #include "dashql/parser/parser.h"
 #include "dashql/script.h"
+#include "dashql/utils/arena.h"
 #include "dashql/utils/chunk_buffer.h"
 #include "dashql/utils/temp_allocator.h"
 
@@ -29,12 +31,17 @@ class ParseContext {
     /// The symbol iterator
     ChunkBuffer<Parser::symbol_type>::ConstTupleIterator symbol_iterator;
 
+    /// The arena of the parse.
+    /// The nodes and the temporary node pools are allocated in it and are freed in bulk with the context.
+    Arena arena;
     /// The nodes
     ChunkBuffer<buffers::parser::Node> nodes;
     /// The statements
     std::vector<ParsedScript::Statement> statements;
     /// The errors
     std::vector<ParseError> errors;
+    /// The statement separators
+    std::vector<ParsedScript::StatementSeparator> statement_separators;
     /// Symbol-index spans (begin, end) covering the bodies of vis specs.
     /// Any keyword whose symbol index falls within one of these spans is rendered as a vis keyword.
     std::vector<std::pair<uint32_t, uint32_t>> vis_spec_spans;
@@ -76,9 +83,16 @@ class ParseContext {
     }
     /// The current token index (incremented each time NextSymbol returns a token)
     uint32_t next_token_index = 0;
+    /// The token index at which NextSymbol returns EOF, unless the limit is extended.
+    /// Incremental parses stop after a statement separator since the following statements are reused.
+    uint32_t symbol_limit = std::numeric_limits<uint32_t>::max();
+    /// The next symbol limits to try if the parser did not consume the symbol before the limit as separator
+    std::span<const uint32_t> symbol_limit_candidates;
+    /// Continue reading symbols after the symbol limit?
+    bool ExtendSymbolLimit();
     /// Get next symbol
     inline Parser::symbol_type NextSymbol() {
-        if (symbol_iterator.IsAtEnd()) {
+        if (symbol_iterator.IsAtEnd() || (next_token_index == symbol_limit && !ExtendSymbolLimit())) {
             return parser::Parser::make_EOF(buffers::parser::SymbolSpan(next_token_index, 0));
         }
         Parser::symbol_type sym = *symbol_iterator;
@@ -141,6 +155,8 @@ class ParseContext {
     void AddStatement(buffers::parser::Node node);
     /// Reset a statement
     void ResetStatement();
+    /// Add a statement separator
+    void AddStatementSeparator(buffers::parser::SymbolSpan loc);
     /// Mark a text span as the body of a vis spec
     void MarkVisSpecSpan(buffers::parser::SymbolSpan loc) {
         vis_spec_spans.emplace_back(loc.offset(), loc.offset() + loc.length());
@@ -58,6 +58,16 @@ class Parser : public ParserBase {
         bool reached_target = false;
     };
 
+    /// Snapshot of the LALR parser state before reading the first symbol after a statement separator.
+    /// Prefix parses record these snapshots on the scanned script and resume from the last one before
+    /// the cursor, so a completion near the end of a long script doesn't parse the entire script again.
+    struct BoundarySnapshot {
+        /// The id of the symbol that is read next
+        uint32_t symbol_id = 0;
+        /// The state stack from bottom to top
+        std::vector<state_type> state_stack;
+    };
+
     /// Combined output of the prefix parse: expected grammar symbols at the cursor + the state
     /// snapshot used to compute them. The snapshot can be replayed by
     /// `ProbeSuffixBatchFromSnapshot`.
@@ -73,8 +83,15 @@ class Parser : public ParserBase {
     auto GetStackSize() const { return yystack_.size(); }
     /// State number at depth `i` (0 = top). Used by policies that snapshot the stack.
     state_type GetStackState(decltype(stack_type{}.size()) i) const { return yystack_[i].state; }
+    /// Is the driver recovering from an error? Valid in `OnLookaheadRead`.
+    bool IsRecoveringFromError() const { return recovering_from_error; }
 
    protected:
+    /// Did the driver recover from an error within the last three shifted symbols?
+    bool recovering_from_error = false;
+    /// Restore a state stack (bottom to top)
+    void RestoreStateStack(std::span<const state_type> state_stack);
+
     /// Run the bison-generated LALR automaton, delegating customizable steps to `policy` (a duck
     /// type with the hooks documented in parser.cc). All three of `CollectExpectedSymbolsAfter`,
     /// `ParsePrefixToTarget`, and `ProbeSuffixFromPrefix` share this driver — they only differ
@@ -92,7 +109,10 @@ class Parser : public ParserBase {
     std::vector<ExpectedSymbol> CollectExpectedSymbolsAfter(ChunkBufferEntryID symbol_id, symbol_kind_type feed_symbol);
     /// Run the LALR driver up to (but not including) the read of `target_symbol_id`. The parser's
     /// current state stack is captured into `out` (state numbers only, no semantic values).
-    void ParsePrefixToTarget(ChunkBufferEntryID target_symbol_id, PrefixSnapshot& out);
+    /// If `boundaries` is set, the driver resumes at the last boundary snapshot before the target and
+    /// records snapshots at the statement boundaries that it passes.
+    void ParsePrefixToTarget(ChunkBufferEntryID target_symbol_id, PrefixSnapshot& out,
+                             std::vector<BoundarySnapshot>* boundaries = nullptr);
     /// Restore a captured state stack into the parser. After this returns the parser is in the
     /// same logical state as ParsePrefixToTarget left it, ready for LAC queries or suffix replay.
     void RestorePrefix(const PrefixSnapshot& prefix);
@@ -113,7 +133,7 @@ class Parser : public ParserBase {
    public:
     /// Parse until a token; return both the expected grammar symbols at the cursor and the
     /// LALR state snapshot. Pass the snapshot to `ProbeSuffixBatchFromSnapshot` to avoid
-    /// re-parsing the prefix.
+    /// re-parsing the prefix. Resumes at the boundary snapshots of the scanned script.
     static ExpectedAtCursor ParseUntilWithSnapshot(ScannedScript& in, ChunkBufferEntryID symbol_id);
     /// Parse until a token, feed an extra symbol, then return expected symbols after it
     static std::vector<ExpectedSymbol> ParseUntilAfter(ScannedScript& in, ChunkBufferEntryID symbol_id,
@@ -133,6 +153,9 @@ class Parser : public ParserBase {
                                                        bool replace_target);
     /// Parse a module (throws Exception on error)
     static std::shared_ptr<ParsedScript> Parse(std::shared_ptr<ScannedScript> in, bool debug = false);
+    /// Parse a module incrementally.
+    /// Reparses the statements that overlap the symbols that were rescanned and reuses all others.
+    static std::shared_ptr<ParsedScript> Parse(std::shared_ptr<ScannedScript> in, const ParsedScript& previous);
 
    protected:
     /// Override of bison's syntax-error message builder. Detects common mistakes (e.g. SCONST used
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <memory>
 #include <string_view>
 
 #include "dashql/buffers/index_generated.h"
@@ -7,6 +8,7 @@
 #include "dashql/parser/parser.h"
 #include "dashql/script.h"
 #include "dashql/text/rope.h"
+#include "dashql/utils/arena.h"
 
 namespace dashql {
 namespace parser {
@@ -69,15 +71,27 @@ class Scanner {
 
    protected:
     /// Constructor
-    Scanner(const rope::Rope& text, TextVersion text_version, CatalogEntryID external_id);
+    Scanner(const rope::Rope& text, TextVersion text_version, CatalogEntryID external_id,
+            std::shared_ptr<ArenaBlockPool> block_pool = nullptr);
     /// Delete the copy constructor
     Scanner(const Scanner& other) = delete;
     /// Delete the copy assignment
     Scanner& operator=(const Scanner& other) = delete;
+    /// Start scanning at a text offset. Must be called before reading the first symbol.
+    void SeekTo(size_t text_offset);
 
    public:
-    /// Scan input and produce all tokens (throws Exception on error)
+    /// Scan input and produce all tokens (throws Exception on error).
+    /// The arenas of the scanned script and of all later stages draw from the block pool, if any.
     static std::shared_ptr<ScannedScript> Scan(const rope::Rope& text, TextVersion text_version,
+                                                CatalogEntryID external_id,
+                                                std::shared_ptr<ArenaBlockPool> block_pool = nullptr);
+    /// Rescan the edited region of a previously scanned script (throws Exception on error).
+    /// Symbols before the last statement boundary preceding the edit are reused as-is.
+    /// Symbols after the edit are reused with shifted offsets once the symbol stream resynchronizes.
+    /// The rescanned script draws from the block pool of the previous one.
+    static std::shared_ptr<ScannedScript> Scan(const ScannedScript& previous, const TextEdit& edit,
+                                                const rope::Rope& text, TextVersion text_version,
                                                 CatalogEntryID external_id);
 };
 
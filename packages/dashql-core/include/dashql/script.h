@@ -17,6 +17,7 @@
 #include "dashql/external.h"
 #include "dashql/parser/parser.h"
 #include "dashql/text/rope.h"
+#include "dashql/utils/arena.h"
 #include "dashql/utils/intrusive_list.h"
 #include "dashql/utils/string_pool.h"
 
@@ -34,6 +35,7 @@ class ParseContext;
 class NameSuffixIndex;
 struct Analyzer;
 struct Completion;
+struct CompletionCache;
 
 using Key = buffers::parser::AttributeKey;
 using SymbolSpan = buffers::parser::SymbolSpan;
@@ -45,6 +47,22 @@ using StatementID = uint32_t;
 using TextVersion = uint32_t;
 using CompletionPtr = flatbuffers::Offset<buffers::completion::Completion>;
 
+/// A byte range of the text that changed since the script was last scanned.
+/// Text before `offset` is unchanged, text after the edited range is unchanged but shifted.
+struct TextEdit {
+    /// The begin of the edited range
+    size_t offset = 0;
+    /// The length of the edited range in the previously scanned text
+    size_t old_length = 0;
+    /// The length of the edited range in the current text
+    size_t new_length = 0;
+
+    /// Is the edit empty?
+    bool IsEmpty() const { return old_length == 0 && new_length == 0; }
+    /// Merge a subsequent edit that replaced `removed` bytes at `edit_offset` with `inserted` bytes
+    void Merge(size_t edit_offset, size_t removed, size_t inserted);
+};
+
 class ScannedScript {
     friend class Script;
 
@@ -63,6 +81,9 @@ class ScannedScript {
     /// The comments
     std::vector<buffers::parser::TextSpan> comments;
 
+    /// The arena of the scanned script.
+    /// The name pool, the name registry and the symbols are allocated in it and are freed in bulk with the script.
+    Arena arena;
     /// The name pool
     StringPool<1024> name_pool;
     /// The name registry
@@ -70,11 +91,30 @@ class ScannedScript {
     /// All symbols
     ChunkBuffer<parser::Parser::symbol_type> symbols;
 
+    /// The symbols that an incremental scan copied from the previous scan
+    struct ReusedSymbols {
+        /// The text version of the previous scan
+        TextVersion previous_text_version = 0;
+        /// The number of leading symbols that were copied
+        size_t prefix_count = 0;
+        /// The first copied trailing symbol in the previous scan
+        size_t previous_suffix_begin = 0;
+        /// The first copied trailing symbol in this scan
+        size_t suffix_begin = 0;
+    };
+    /// The reused symbols, if the script was scanned incrementally
+    std::optional<ReusedSymbols> reused_symbols;
+    /// The LALR parser states at statement boundaries, recorded by the prefix parses of completions.
+    /// A snapshot only depends on the symbols before it, so incremental rescans keep the ones before the edit.
+    std::vector<parser::Parser::BoundarySnapshot> lalr_snapshots;
+
    public:
     /// Constructor
-    ScannedScript(const rope::Rope& text, TextVersion text_version = 0, CatalogEntryID external_id = 1);
+    ScannedScript(const rope::Rope& text, TextVersion text_version = 0, CatalogEntryID external_id = 1,
+                  std::shared_ptr<ArenaBlockPool> block_pool = nullptr);
     /// Constructor
-    ScannedScript(std::string text, TextVersion text_version = 0, CatalogEntryID external_id = 1);
+    ScannedScript(std::string text, TextVersion text_version = 0, CatalogEntryID external_id = 1,
+                  std::shared_ptr<ArenaBlockPool> block_pool = nullptr);
 
     /// Get the input
     std::string_view GetInput() const {
@@ -168,6 +208,21 @@ class ParsedScript {
         std::unique_ptr<buffers::parser::StatementT> Pack() const;
     };
 
+    /// A semicolon that the parser consumed between two top-level statements.
+    /// Remembers what the parser had emitted when reaching it, everything after it can be parsed independently.
+    struct StatementSeparator {
+        /// The symbol id of the semicolon
+        uint32_t symbol_id = 0;
+        /// The number of nodes before the separator
+        uint32_t nodes_begin = 0;
+        /// The number of statements before the separator
+        uint32_t statements_begin = 0;
+        /// The number of errors before the separator
+        uint32_t errors_begin = 0;
+        /// The number of vis spec spans before the separator
+        uint32_t vis_spec_spans_begin = 0;
+    };
+
     /// Source-level description metadata corresponding one-to-one with `statements`. Kept outside
     /// `Statement` so the generated parser's embedded ParseContext layout stays stable.
     struct StatementDescription {
@@ -183,12 +238,25 @@ class ParsedScript {
     std::shared_ptr<ScannedScript> scanned_script;
     /// The nodes
     std::vector<buffers::parser::Node> nodes;
+    /// The structural hashes of the AST subtrees, one per node
+    std::vector<uint64_t> subtree_hashes;
+    /// The nodes whose children are ordered by location without overlapping, one per node.
+    /// Lookups by text offset binary search the children of these nodes instead of scanning them.
+    std::vector<bool> location_ordered_children;
     /// The statements
     std::vector<Statement> statements;
     /// The parser errors
     std::vector<parser::ParseError> errors;
     /// Symbol-index spans (begin, end) covering the bodies of vis specs
     std::vector<std::pair<uint32_t, uint32_t>> vis_spec_spans;
+    /// The top-level statement separators
+    std::vector<StatementSeparator> statement_separators;
+    /// The number of statements that were reused from a previous parse
+    size_t reused_statements = 0;
+    /// The number of allocations that the parser served from the arena of its parse context
+    size_t parser_arena_allocations = 0;
+    /// The number of blocks that the arena of the parse context allocated on the heap
+    size_t parser_arena_blocks = 0;
     /// Bitwise OR of ParsedScriptFeature values detected by the parser.
     uint32_t feature_flags = 0;
 
@@ -213,6 +281,7 @@ class ParsedScript {
 
 class AnalyzedScript : public CatalogEntry {
     friend class Script;
+    friend struct AnalysisState;
     friend struct NameResolutionPass;
 
    public:
@@ -242,6 +311,9 @@ class AnalyzedScript : public CatalogEntry {
     /// These markers can be used in the UI for hints and highlighting.
     std::vector<buffers::analyzer::SemanticNodeMarkerType> node_markers;
 
+    /// The arena of the analyzed script.
+    /// The analyzer buffers below are allocated in it and are freed in bulk with the script.
+    Arena arena;
     /// The table references
     ChunkBuffer<TableReference, 16> table_references;
     /// INSERT statements
@@ -255,7 +327,9 @@ class AnalyzedScript : public CatalogEntry {
 
     /// The name scopes by scope root.
     /// Name scopes maintain intrusive lists with all column reference expressions.
-    std::unordered_map<NodeID, std::reference_wrapper<NameScope>> name_scopes_by_root_node;
+    std::unordered_map<NodeID, std::reference_wrapper<NameScope>, std::hash<NodeID>, std::equal_to<NodeID>,
+                       ArenaAllocator<std::pair<const NodeID, std::reference_wrapper<NameScope>>>>
+        name_scopes_by_root_node;
 
     /// The constant expressions in the script
     ChunkBuffer<ConstantExpression, 16> constant_expressions;
@@ -270,6 +344,10 @@ class AnalyzedScript : public CatalogEntry {
     /// The inferred table schemas indexed by normalized (db, schema, table) name.
     std::unordered_map<CatalogEntry::QualifiedTableName::Key, std::reference_wrapper<InferredTableSchema>, TupleHasher>
         inferred_table_schemas_by_name;
+    /// The previous analysis of the script with a built name search index.
+    /// The name search index of this script is derived from it on first use, which keeps the previous scan alive
+    /// until then.
+    std::shared_ptr<const AnalyzedScript> name_search_index_base;
 
     /// Traverse the name scopes for a given ast node id
     void FollowPathUpwards(uint32_t ast_node_id, std::vector<uint32_t>& ast_node_path,
@@ -296,7 +374,7 @@ class AnalyzedScript : public CatalogEntry {
     virtual flatbuffers::Offset<buffers::catalog::CatalogEntry> DescribeEntry(
         flatbuffers::FlatBufferBuilder& builder) const override;
     /// Get the name search index
-    const CatalogEntry::NameSearchIndex& GetNameSearchIndex() override;
+    const CatalogEntry::NameSearchIndex& GetNameSearchIndex(size_t index = 0) override;
     /// Build the program
     flatbuffers::Offset<buffers::analyzer::AnalyzedScript> Pack(flatbuffers::FlatBufferBuilder& builder);
 };
@@ -330,6 +408,10 @@ struct ScriptCursor {
 
     /// The script
     const Script& script;
+    /// The parsed script that the cursor was placed in (if any)
+    std::shared_ptr<ParsedScript> parsed_script;
+    /// The analyzed script that the cursor was placed in (if any)
+    std::shared_ptr<AnalyzedScript> analyzed_script;
     /// The text offset
     size_t text_offset = 0;
     /// The current scanner location (if any)
@@ -345,6 +427,8 @@ struct ScriptCursor {
     std::vector<std::reference_wrapper<AnalyzedScript::NameScope>> name_scopes;
     /// The inner cursor type based on what we're pointing at
     std::variant<std::monostate, TableRefContext, ColumnRefContext> context;
+    /// Was the name scope recovered from the qualifier of a dot instead of the ast path?
+    bool name_scope_recovered = false;
 
     /// Move the cursor to a script at a position
     ScriptCursor(const Script& script, size_t text_offset);
@@ -354,8 +438,11 @@ struct ScriptCursor {
     /// Pack the cursor info
     flatbuffers::Offset<buffers::cursor::ScriptCursor> Pack(flatbuffers::FlatBufferBuilder& builder) const;
 
-    /// Create a script cursor (throws Exception on error)
-    static std::unique_ptr<ScriptCursor> Place(const Script& script, size_t text_offset);
+    /// Create a script cursor (throws Exception on error).
+    /// Arrow-key moves usually stay within the same AST leaf, the cursor then reuses the path and name scopes of the
+    /// previous cursor if it was placed in the same analysis.
+    static std::unique_ptr<ScriptCursor> Place(const Script& script, size_t text_offset,
+                                               const ScriptCursor* previous = nullptr);
 };
 
 class Script {
@@ -378,6 +465,18 @@ class Script {
     std::shared_ptr<AnalyzedScript> analyzed_script;
     /// The last cursor
     std::unique_ptr<ScriptCursor> cursor;
+    /// The name index lookups of the last completion
+    std::unique_ptr<CompletionCache> completion_cache;
+    /// The text edits since the last scan, if they could be tracked
+    std::optional<TextEdit> pending_scanner_edit;
+    /// The pool with the arena blocks of outdated versions, if buffers are recycled
+    std::shared_ptr<ArenaBlockPool> arena_block_pool;
+#ifndef WASM
+    /// The analysis on a background thread
+    struct BackgroundAnalysis;
+    /// The background analysis, if one was started
+    std::unique_ptr<BackgroundAnalysis> background_analysis;
+#endif
 
     /// The memory statistics
     buffers::statistics::ScriptProcessingTimings timing_statistics;
@@ -404,6 +503,11 @@ class Script {
     auto& GetParsedScript() const { return parsed_script; };
     /// Get the latest parsed script
     auto& GetAnalyzedScript() const { return analyzed_script; };
+    /// Recycle the buffers of outdated versions?
+    /// The arenas of all versions then draw from a shared block pool and return their blocks once the last
+    /// shared_ptr to a version is dropped. Versions that are held elsewhere keep their blocks until then.
+    /// Takes effect with the next full scan.
+    void SetBufferRecycling(bool enabled);
 
     /// Insert a unicode codepoint at an offset
     void InsertCharAt(size_t offset, uint32_t unicode);
@@ -424,18 +528,34 @@ class Script {
     ScriptCompilationResult CompileQuery(const buffers::formatting::FormattingConfigT& config,
                                          ScriptCompilationOptions options = {});
 
-    /// Scans the script unconditionally (throws Exception on error)
+    /// Scans the script unconditionally (throws Exception on error).
+    /// Rescans only the edited region if the edits since the last scan are known.
     void Scan();
     /// Parses the script unconditionally (throws Exception on error)
     void Parse();
     /// Analyzes the script (throws Exception on error)
     /// When `parse_if_outdated` is set we scan and parse the script, if it changed.
     void Analyze(bool parse_if_outdated = true);
-
-    /// Move the cursor (throws Exception on error)
+#ifndef WASM
+    /// Analyze a snapshot of the script on a background thread.
+    /// Scanning, parsing and analyzing then run on a worker that is spawned with the first request.
+    /// A newer text version cancels the pending analysis between the stages.
+    /// Finished analyses are published with the next PollBackgroundAnalysis or MoveCursor.
+    /// The worker resolves names against a catalog snapshot, hosts may keep modifying the catalog meanwhile.
+    void AnalyzeInBackground();
+    /// Adopt the latest finished background analysis (throws Exception on error).
+    /// Replaces the scanned, parsed and analyzed script at once and re-places the cursor in the new analysis.
+    /// Returns the text version of the adopted analysis, if there was one.
+    std::optional<TextVersion> PollBackgroundAnalysis();
+    /// Wait for the background analysis of the latest request and adopt it (throws Exception on error)
+    std::optional<TextVersion> WaitForBackgroundAnalysis();
+#endif
+
+    /// Move the cursor (throws Exception on error).
+    /// Adopts a finished background analysis first, completions at the cursor then see the same analysis.
     const ScriptCursor* MoveCursor(size_t text_offset);
     /// Complete at the cursor (throws Exception on error)
-    std::unique_ptr<Completion> CompleteAtCursor(size_t limit = 10) const;
+    std::unique_ptr<Completion> CompleteAtCursor(size_t limit = 10);
     /// Get statisics
     std::unique_ptr<buffers::statistics::ScriptStatisticsT> GetStatistics();
 
@@ -24,6 +24,10 @@ namespace dashql {
 ///    before the merge-join in the similarity/equality traversals.
 ///  - The node-type classifier accounts for the `ENUM_VIS_*` values that sit numerically between
 ///    `OBJECT_KEYS_` and `VIS_OBJECT_KEYS_`.
+///
+/// Every parsed script carries structural hashes of all AST subtrees (order-normalized for object
+/// attributes). Statements are only compared with statements of the same root hash, and identical
+/// subtrees are pruned from the similarity traversals, which keeps the diff near-linear.
 class ScriptDiff {
    public:
     /// The op code (identical to the flatbuffer enum, no translation needed)
@@ -56,6 +60,10 @@ class ScriptDiff {
     /// Pack the diff into a flatbuffer
     flatbuffers::Offset<buffers::diff::ScriptDiff> Pack(flatbuffers::FlatBufferBuilder& builder);
 
+    /// Compute the structural hashes of all subtrees of a parsed script.
+    /// Subtrees that are equal for the diff have equal hashes.
+    static void ComputeSubtreeHashes(const ParsedScript& script, std::vector<uint64_t>& hashes);
+
    private:
     /// A fast similarity estimate for two statements
     enum class SimilarityEstimate { NOT_EQUAL, SIMILAR, EQUAL };
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
@@ -10,6 +11,7 @@
 namespace dashql {
 class Catalog;
 class Script;
+using CatalogEntryID = uint32_t;
 }  // namespace dashql
 
 namespace dashql::shell {
@@ -30,16 +32,17 @@ class SessionRelationCatalog {
         std::string schema_name;
         std::string relation_name;
         std::vector<std::string> columns;
+        // Every relation lives in its own descriptor pool so that a query only touches the relations it changes.
+        CatalogEntryID catalog_entry_id = 0;
     };
 
     using RelationKey = std::tuple<std::string, std::string, std::string>;
 
-    void ReloadCatalogScript();
-    std::string RenderCatalog() const;
+    void LoadRelation(Relation& relation);
+    void DropRelation(const Relation& relation);
 
     Catalog& catalog_;
     std::unique_ptr<Script> parser_script_;
-    std::unique_ptr<Script> catalog_script_;
     std::map<RelationKey, Relation> relations_;
 };
 
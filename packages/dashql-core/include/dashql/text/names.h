@@ -1,5 +1,11 @@
 #pragma once
 
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
 #include "ankerl/unordered_dense.h"
 #include "dashql/buffers/index_generated.h"
 #include "dashql/catalog_object.h"
@@ -52,7 +58,7 @@ struct NameRegistry {
     ankerl::unordered_dense::map<std::string_view, std::reference_wrapper<RegisteredName>> names_by_text;
 
     /// Constructor
-    NameRegistry() { names_by_text.reserve(64); }
+    explicit NameRegistry(Arena* arena = nullptr) : names(arena) { names_by_text.reserve(64); }
 
     /// Get the chunks
     auto& GetChunks() const { return names.GetChunks(); }
@@ -74,4 +80,72 @@ struct NameRegistry {
     RegisteredName& Register(std::string_view s, NameTags tags);
 };
 
+/// A case-insensitive substring index over the names of a registry.
+///
+/// The index folds all names into a single text pool and sorts the suffixes of every name.
+/// A substring lookup then becomes a binary search for the suffixes that start with the search text.
+/// Suffixes are 8 bytes each and refer into the pool, so the index does not materialize any suffix text.
+///
+/// An index can be derived from the index of a previous registry.
+/// Suffixes of names that exist in both registries are carried over and only the suffixes of added names are
+/// sorted and merged in. The suffix order only depends on the name texts, so carried suffixes remain sorted.
+class NameSearchIndex {
+   public:
+    /// A suffix of an indexed name
+    struct Suffix {
+        /// The index of the name in the search index
+        uint32_t name_index;
+        /// The offset of the suffix in the text pool
+        uint32_t pool_offset;
+    };
+
+   protected:
+    /// The indexed names
+    std::vector<std::reference_wrapper<const RegisteredName>> names;
+    /// The end offsets of the names in the text pool
+    std::vector<uint32_t> name_ends;
+    /// The case-folded text of all names
+    std::string text_pool;
+    /// The suffixes of all names, ordered by their folded text and then by the name text
+    std::vector<Suffix> suffixes;
+    /// The suffixes that start at the beginning of a name, ordered like the suffixes
+    std::vector<Suffix> prefixes;
+    /// The bytes in the text pool that belong to names that were removed
+    size_t garbage_bytes = 0;
+
+    /// Read the folded text of a suffix
+    std::string_view ReadSuffix(const Suffix& suffix) const {
+        auto length = name_ends[suffix.name_index] - suffix.pool_offset;
+        return std::string_view{text_pool}.substr(suffix.pool_offset, length);
+    }
+    /// Compare two suffixes
+    bool IsLess(const Suffix& l, const Suffix& r) const;
+    /// Fold a name into the text pool and collect its suffixes
+    void AddName(const RegisteredName& name, std::vector<Suffix>& out);
+    /// Collect the suffixes that start at the beginning of a name
+    void CollectPrefixes();
+
+   public:
+    /// Constructor
+    explicit NameSearchIndex(const NameRegistry& registry);
+    /// Constructor that derives the index from the index of a previous registry
+    NameSearchIndex(const NameRegistry& registry, const NameSearchIndex& previous);
+
+    /// Get the number of indexed suffixes
+    size_t GetSize() const { return suffixes.size(); }
+    /// Get the byte size
+    size_t GetByteSize() const;
+    /// Get the name of a suffix
+    const RegisteredName& GetName(const Suffix& suffix) const { return names[suffix.name_index]; }
+    /// Find all suffixes that start with a text, ignoring case.
+    /// A name is returned once for every suffix that matches.
+    std::span<const Suffix> FindSuffixes(std::string_view text) const;
+    /// Find the suffixes within a previous result that start with a text, ignoring case.
+    /// If the text extends the text of the previous lookup, this equals FindSuffixes(text).
+    std::span<const Suffix> FindSuffixes(std::string_view text, std::span<const Suffix> within) const;
+    /// Find the names that start with a text, ignoring case.
+    /// A name that equals the text is ordered before all other names.
+    std::span<const Suffix> FindPrefixes(std::string_view text) const { return FindSuffixes(text, prefixes); }
+};
+
 }  // namespace dashql
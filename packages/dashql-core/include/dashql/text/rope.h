@@ -367,6 +367,8 @@ struct Rope {
     void CheckIntegrity();
     /// Copy the rope to a std::string
     std::string ToString(bool withPadding = false) const;
+    /// Resolve a codepoint index to its UTF-8 byte offset.
+    size_t ResolveCodepoint(size_t char_idx) const;
     /// Resolve a grapheme boundary to aggregate text offsets.
     TextPosition ResolveGrapheme(size_t grapheme_idx) const;
     /// Resolve an exact UTF-8 byte offset to a grapheme boundary.
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace dashql {
+
+/// A memory block of an arena
+struct ArenaBlock {
+    /// The buffer
+    std::unique_ptr<std::byte[]> buffer;
+    /// The capacity
+    size_t capacity = 0;
+};
+
+/// A pool of recycled arena blocks.
+///
+/// Arenas that draw from a pool return their blocks when they are destroyed, i.e. when the last shared_ptr to an
+/// outdated script version is dropped. The next version then reuses the grown capacity instead of allocating.
+/// Versions may be dropped on any thread, the pool is therefore synchronized.
+class ArenaBlockPool {
+   public:
+    /// The maximum number of pooled blocks
+    static constexpr size_t MAX_POOLED_BLOCKS = 64;
+
+   protected:
+    /// The mutex
+    std::mutex mutex;
+    /// The pooled blocks
+    std::vector<ArenaBlock> blocks;
+    /// The number of blocks that were taken from the pool
+    size_t reused_blocks = 0;
+
+   public:
+    /// Get the number of pooled blocks
+    size_t GetPooledBlockCount() {
+        std::lock_guard<std::mutex> lock{mutex};
+        return blocks.size();
+    }
+    /// Get the number of blocks that were taken from the pool
+    size_t GetReusedBlockCount() {
+        std::lock_guard<std::mutex> lock{mutex};
+        return reused_blocks;
+    }
+    /// Take the smallest pooled block that fits n bytes, returns an empty block if there is none
+    ArenaBlock Take(size_t n) {
+        std::lock_guard<std::mutex> lock{mutex};
+        auto best = blocks.end();
+        for (auto iter = blocks.begin(); iter != blocks.end(); ++iter) {
+            if (iter->capacity >= n && (best == blocks.end() || iter->capacity < best->capacity)) {
+                best = iter;
+            }
+        }
+        if (best == blocks.end()) {
+            return {};
+        }
+        ArenaBlock block = std::move(*best);
+        *best = std::move(blocks.back());
+        blocks.pop_back();
+        ++reused_blocks;
+        return block;
+    }
+    /// Return blocks to the pool, blocks beyond the pool limit are freed
+    void Recycle(std::vector<ArenaBlock>&& recycled) {
+        std::lock_guard<std::mutex> lock{mutex};
+        for (auto& block : recycled) {
+            if (blocks.size() >= MAX_POOLED_BLOCKS) {
+                break;
+            }
+            blocks.push_back(std::move(block));
+        }
+        recycled.clear();
+    }
+};
+
+/// A monotonic arena.
+///
+/// Every version of a script owns an arena that its buffers draw from.
+/// Allocations only bump a pointer in the current block and deallocations are no-ops,
+/// dropping an outdated version therefore frees a handful of blocks instead of every single buffer.
+/// Blocks grow by 5/4 like the chunks of the ChunkBuffer and StringPool.
+class Arena {
+   public:
+    /// The default size of the first block
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 16 * 1024;
+
+   protected:
+    /// The block pool, if blocks are recycled
+    std::shared_ptr<ArenaBlockPool> block_pool;
+    /// The blocks
+    std::vector<ArenaBlock> blocks;
+    /// The next free byte in the current block
+    std::byte* current = nullptr;
+    /// The remaining bytes in the current block
+    size_t remaining = 0;
+    /// The next block size
+    size_t next_block_size;
+    /// The number of allocations served by the arena
+    size_t allocation_count = 0;
+    /// The number of bytes allocated from the arena
+    size_t allocated_bytes = 0;
+    /// The number of bytes reserved in blocks
+    size_t reserved_bytes = 0;
+
+    /// Allocate a new block with at least block_size bytes, prefers recycled blocks
+    ArenaBlock& allocateBlock(size_t block_size) {
+        ArenaBlock block;
+        if (block_pool) {
+            block = block_pool->Take(block_size);
+        }
+        if (!block.buffer) {
+            block.buffer.reset(new std::byte[block_size]);
+            block.capacity = block_size;
+        }
+        reserved_bytes += block.capacity;
+        blocks.push_back(std::move(block));
+        return blocks.back();
+    }
+    /// Continue in a new block
+    void grow() {
+        auto block_size = next_block_size;
+        next_block_size = next_block_size * 5 / 4;
+        auto& block = allocateBlock(block_size);
+        current = block.buffer.get();
+        remaining = block.capacity;
+    }
+
+   public:
+    /// Constructor.
+    /// The first block is only allocated with the first allocation.
+    explicit Arena(size_t initial_block_size = DEFAULT_BLOCK_SIZE, std::shared_ptr<ArenaBlockPool> block_pool = nullptr)
+        : block_pool(std::move(block_pool)), next_block_size(initial_block_size) {}
+    /// Destructor, returns the blocks to the block pool
+    ~Arena() {
+        if (block_pool) {
+            block_pool->Recycle(std::move(blocks));
+        }
+    }
+    /// Copy constructor
+    Arena(const Arena& other) = delete;
+    /// Copy assignment
+    Arena& operator=(const Arena& other) = delete;
+
+    /// Get the block pool
+    auto& GetBlockPool() const { return block_pool; }
+    /// Get the number of allocations served by the arena
+    size_t GetAllocationCount() const { return allocation_count; }
+    /// Get the number of blocks, i.e. the number of heap allocations of the arena
+    size_t GetBlockCount() const { return blocks.size(); }
+    /// Get the number of bytes allocated from the arena
+    size_t GetAllocatedBytes() const { return allocated_bytes; }
+    /// Get the number of bytes reserved in blocks
+    size_t GetReservedBytes() const { return reserved_bytes; }
+
+    /// Allocate n bytes
+    void* Allocate(size_t n, size_t alignment = alignof(std::max_align_t)) {
+        assert((alignment & (alignment - 1)) == 0);
+        auto padding = (alignment - (reinterpret_cast<uintptr_t>(current) & (alignment - 1))) & (alignment - 1);
+        if ((padding + n) > remaining) {
+            // Large allocations get a block of their own and leave the current block untouched
+            if ((n + alignment) > next_block_size) {
+                allocated_bytes += n;
+                ++allocation_count;
+                return allocateBlock(std::max(n, alignment)).buffer.get();
+            }
+            grow();
+            padding = (alignment - (reinterpret_cast<uintptr_t>(current) & (alignment - 1))) & (alignment - 1);
+        }
+        std::byte* begin = current + padding;
+        current = begin + n;
+        remaining -= padding + n;
+        allocated_bytes += n;
+        ++allocation_count;
+        return begin;
+    }
+};
+
+/// An STL allocator that draws from an arena.
+/// Falls back to the heap without arena, containers therefore don't need to know whether they live in an arena.
+template <typename T> struct ArenaAllocator {
+    using value_type = T;
+    /// Copies of a container must not outlive the arena of the source, they are allocated on the heap
+    using propagate_on_container_copy_assignment = std::false_type;
+    /// Moved containers keep referring to the arena they were allocated in
+    using propagate_on_container_move_assignment = std::true_type;
+    /// Swapped containers keep referring to the arena they were allocated in
+    using propagate_on_container_swap = std::true_type;
+
+    /// The arena, null if allocating on the heap
+    Arena* arena = nullptr;
+
+    /// Constructor
+    ArenaAllocator(Arena* arena = nullptr) noexcept : arena(arena) {}
+    /// Constructor
+    template <typename U> ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.arena) {}
+
+    /// Allocate n values
+    T* allocate(size_t n) {
+        if (arena) {
+            return static_cast<T*>(arena->Allocate(n * sizeof(T), alignof(T)));
+        }
+        return std::allocator<T>{}.allocate(n);
+    }
+    /// Deallocate n values, a no-op in the arena
+    void deallocate(T* ptr, size_t n) noexcept {
+        if (!arena) {
+            std::allocator<T>{}.deallocate(ptr, n);
+        }
+    }
+    /// Copy-constructed containers are allocated on the heap
+    ArenaAllocator select_on_container_copy_construction() const { return ArenaAllocator{}; }
+
+    /// Compare allocators
+    template <typename U> bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; }
+    /// Compare allocators
+    template <typename U> bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; }
+};
+
+}  // namespace dashql
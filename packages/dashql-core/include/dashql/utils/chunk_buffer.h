@@ -3,10 +3,13 @@
 #include <algorithm>
 #include <cassert>
 #include <cstring>
+#include <iterator>
 #include <span>
 #include <type_traits>
 #include <vector>
 
+#include "dashql/utils/arena.h"
+
 namespace dashql {
 
 struct ChunkBufferEntryID {
@@ -28,6 +31,8 @@ template <typename T, size_t InitialSize = 1024> struct ChunkBuffer {
 
    public:
     using value_type = T;
+    /// A chunk, allocated in the arena of the buffer (if any)
+    using Chunk = std::vector<T, ArenaAllocator<T>>;
 
     /// Pseudo end iterator
     struct EndIterator {};
@@ -93,8 +98,10 @@ template <typename T, size_t InitialSize = 1024> struct ChunkBuffer {
     };
 
    protected:
+    /// The arena, null if chunks are allocated on the heap
+    Arena* arena;
     /// The buffers
-    std::vector<std::vector<T>> buffers;
+    std::vector<Chunk> buffers;
     /// The offsets
     std::vector<size_t> offsets;
     /// The next chunk size
@@ -104,9 +111,9 @@ template <typename T, size_t InitialSize = 1024> struct ChunkBuffer {
 
     /// Grow the buffer
     void grow(size_t min_next_size = 0) {
-        auto chunk_size = next_chunk_size;
+        auto chunk_size = std::max<size_t>(min_next_size, next_chunk_size);
         next_chunk_size = std::max<size_t>(min_next_size, next_chunk_size * 5 / 4);
-        std::vector<T> nodes;
+        Chunk nodes(ArenaAllocator<T>{arena});
         nodes.reserve(chunk_size);
         buffers.push_back(std::move(nodes));
         offsets.push_back(total_value_count);
@@ -121,7 +128,8 @@ template <typename T, size_t InitialSize = 1024> struct ChunkBuffer {
 
    public:
     /// Constructor
-    ChunkBuffer() : buffers(), offsets(), next_chunk_size(InitialSize), total_value_count(0) {
+    explicit ChunkBuffer(Arena* arena = nullptr)
+        : arena(arena), buffers(), offsets(), next_chunk_size(InitialSize), total_value_count(0) {
         buffers.reserve(64);
         offsets.reserve(64);
         grow();
@@ -130,8 +138,29 @@ template <typename T, size_t InitialSize = 1024> struct ChunkBuffer {
     explicit ChunkBuffer(std::vector<T> buffer) : ChunkBuffer() {
         total_value_count = buffer.size();
         offsets.push_back(total_value_count);
-        buffers.push_back(std::move(buffer));
+        buffers.emplace_back(std::make_move_iterator(buffer.begin()), std::make_move_iterator(buffer.end()));
+    }
+    /// Copy constructor.
+    /// Copies may outlive the arena of the source and are therefore allocated on the heap.
+    ChunkBuffer(const ChunkBuffer& other)
+        : arena(nullptr),
+          buffers(other.buffers),
+          offsets(other.offsets),
+          next_chunk_size(other.next_chunk_size),
+          total_value_count(other.total_value_count) {}
+    /// Move constructor
+    ChunkBuffer(ChunkBuffer&& other) = default;
+    /// Copy assignment, allocates new chunks on the heap
+    ChunkBuffer& operator=(const ChunkBuffer& other) {
+        arena = nullptr;
+        buffers = other.buffers;
+        offsets = other.offsets;
+        next_chunk_size = other.next_chunk_size;
+        total_value_count = other.total_value_count;
+        return *this;
     }
+    /// Move assignment
+    ChunkBuffer& operator=(ChunkBuffer&& other) = default;
 
     /// Get the size
     size_t GetSize() const { return total_value_count; }
@@ -168,6 +197,11 @@ template <typename T, size_t InitialSize = 1024> struct ChunkBuffer {
         size_t local_value_id = buffers.back().size() - 1;
         return ConstTupleIterator{*this, chunk_id, local_value_id};
     }
+    /// Get a const iterator pointing at an offset
+    ConstTupleIterator GetIteratorAt(size_t offset) const {
+        auto [chunk_id, chunk_offset] = find(offset);
+        return ConstTupleIterator{*this, chunk_id, offset - chunk_offset};
+    }
     /// Clear the buffer
     void Clear() {
         buffers.erase(buffers.begin() + 1, buffers.end());
@@ -204,6 +238,20 @@ template <typename T, size_t InitialSize = 1024> struct ChunkBuffer {
         last_ptr -= n - 1;
         return std::span<T>{last_ptr, n};
     }
+    /// Append multiple nodes contiguously, the values are moved
+    std::span<T> PushBackN(std::span<T> values) {
+        if (values.empty()) return {};
+        auto* last = &buffers.back();
+        if ((last->capacity() - last->size()) < values.size()) {
+            grow(values.size());
+            last = &buffers.back();
+        }
+        for (auto& value : values) {
+            last->push_back(std::move(value));
+        }
+        total_value_count += values.size();
+        return std::span<T>{last->data() + last->size() - values.size(), values.size()};
+    }
     /// Apply a function for each value
     template <typename F> void ForEach(F fn) {
         size_t value_id = 0;
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace dashql {
+
+/// A persistent hash map.
+///
+/// The map is a hash array mapped trie with 32 slots per node.
+/// Copies of the map share all nodes, a modification only copies the nodes on the path to the modified key.
+/// Nodes that are referenced by a single map only are modified in place.
+/// Different maps may be read from different threads as long as every map is modified by a single thread.
+template <typename Key, typename Mapped, typename Hash = std::hash<Key>, typename Equal = std::equal_to<>>
+struct PersistentHashMap {
+   public:
+    using value_type = std::pair<Key, Mapped>;
+
+   protected:
+    /// The number of hash bits per level
+    static constexpr size_t BITS_PER_LEVEL = 5;
+    /// The number of hash bits
+    static constexpr size_t HASH_BITS = sizeof(size_t) * 8;
+
+    /// A trie node.
+    /// Nodes below the last level store colliding values in an unordered vector.
+    struct Node {
+        /// The slots that hold a value
+        uint32_t value_map = 0;
+        /// The slots that hold a child
+        uint32_t child_map = 0;
+        /// The values, ordered by slot
+        std::vector<value_type> values;
+        /// The children, ordered by slot
+        std::vector<std::shared_ptr<Node>> children;
+    };
+    using NodePtr = std::shared_ptr<Node>;
+
+    /// The root node
+    NodePtr root;
+    /// The number of values
+    size_t value_count = 0;
+
+    /// Is a node referenced by this map only?
+    /// The acquire fence orders our writes after the reads of threads that released their references.
+    static bool IsExclusive(const NodePtr& node) {
+        if (node.use_count() != 1) return false;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return true;
+    }
+    /// Make a node writable, copies the node if it is shared with other maps
+    static Node* MakeMutable(NodePtr& node) {
+        if (!node) {
+            node = std::make_shared<Node>();
+        } else if (!IsExclusive(node)) {
+            node = std::make_shared<Node>(*node);
+        }
+        return node.get();
+    }
+    /// Get the slot bit of a hash
+    static uint32_t GetSlotBit(size_t hash, size_t shift) {
+        return uint32_t{1} << ((hash >> shift) & ((size_t{1} << BITS_PER_LEVEL) - 1));
+    }
+    /// Get the index of a slot in a slot map
+    static size_t GetSlotIndex(uint32_t map, uint32_t bit) { return std::popcount(map & (bit - 1)); }
+
+    /// Find a value
+    template <typename K> static value_type* Find(Node* node, size_t hash, const K& key) {
+        for (size_t shift = 0; node; shift += BITS_PER_LEVEL) {
+            if (shift >= HASH_BITS) {
+                for (auto& value : node->values) {
+                    if (Equal{}(value.first, key)) return &value;
+                }
+                return nullptr;
+            }
+            auto bit = GetSlotBit(hash, shift);
+            if (node->value_map & bit) {
+                auto& value = node->values[GetSlotIndex(node->value_map, bit)];
+                return Equal{}(value.first, key) ? &value : nullptr;
+            }
+            if (!(node->child_map & bit)) {
+                return nullptr;
+            }
+            node = node->children[GetSlotIndex(node->child_map, bit)].get();
+        }
+        return nullptr;
+    }
+    /// Find a value and make the path to it writable
+    template <typename K> static value_type* FindMutable(NodePtr& tree, size_t hash, const K& key, size_t shift) {
+        auto* node = MakeMutable(tree);
+        if (shift >= HASH_BITS) {
+            for (auto& value : node->values) {
+                if (Equal{}(value.first, key)) return &value;
+            }
+            return nullptr;
+        }
+        auto bit = GetSlotBit(hash, shift);
+        if (node->value_map & bit) {
+            auto& value = node->values[GetSlotIndex(node->value_map, bit)];
+            return Equal{}(value.first, key) ? &value : nullptr;
+        }
+        assert(node->child_map & bit);
+        return FindMutable(node->children[GetSlotIndex(node->child_map, bit)], hash, key, shift + BITS_PER_LEVEL);
+    }
+    /// Insert a value with a key that is not yet part of the map
+    static value_type* Insert(NodePtr& tree, size_t hash, value_type inserted, size_t shift) {
+        auto* node = MakeMutable(tree);
+        if (shift >= HASH_BITS) {
+            node->values.push_back(std::move(inserted));
+            return &node->values.back();
+        }
+        auto bit = GetSlotBit(hash, shift);
+        if (node->child_map & bit) {
+            auto& child = node->children[GetSlotIndex(node->child_map, bit)];
+            return Insert(child, hash, std::move(inserted), shift + BITS_PER_LEVEL);
+        }
+        auto value_index = GetSlotIndex(node->value_map, bit);
+        if (!(node->value_map & bit)) {
+            node->value_map |= bit;
+            return &*node->values.insert(node->values.begin() + value_index, std::move(inserted));
+        }
+        // The slot is taken by another key, push both values down into a new child
+        NodePtr child;
+        auto existing = std::move(node->values[value_index]);
+        node->values.erase(node->values.begin() + value_index);
+        node->value_map &= ~bit;
+        auto existing_hash = Hash{}(existing.first);
+        Insert(child, existing_hash, std::move(existing), shift + BITS_PER_LEVEL);
+        auto* result = Insert(child, hash, std::move(inserted), shift + BITS_PER_LEVEL);
+        node->child_map |= bit;
+        node->children.insert(node->children.begin() + GetSlotIndex(node->child_map, bit), std::move(child));
+        return result;
+    }
+    /// Erase a key that is part of the map
+    template <typename K> static void Erase(NodePtr& tree, size_t hash, const K& key, size_t shift) {
+        auto* node = MakeMutable(tree);
+        if (shift >= HASH_BITS) {
+            for (auto iter = node->values.begin(); iter != node->values.end(); ++iter) {
+                if (Equal{}(iter->first, key)) {
+                    node->values.erase(iter);
+                    return;
+                }
+            }
+            assert(false);
+            return;
+        }
+        auto bit = GetSlotBit(hash, shift);
+        if (node->value_map & bit) {
+            node->values.erase(node->values.begin() + GetSlotIndex(node->value_map, bit));
+            node->value_map &= ~bit;
+            return;
+        }
+        assert(node->child_map & bit);
+        auto child_index = GetSlotIndex(node->child_map, bit);
+        auto& child = node->children[child_index];
+        Erase(child, hash, key, shift + BITS_PER_LEVEL);
+        // Inline a child that is left with a single value, drop empty children
+        if (child->children.empty() && child->values.size() <= 1) {
+            if (!child->values.empty()) {
+                auto value = std::move(child->values.front());
+                node->values.insert(node->values.begin() + GetSlotIndex(node->value_map, bit), std::move(value));
+                node->value_map |= bit;
+            }
+            node->children.erase(node->children.begin() + child_index);
+            node->child_map &= ~bit;
+        }
+    }
+    /// Visit all values of a node
+    template <typename Fn> static void ForEach(const Node* node, Fn& fn) {
+        if (!node) return;
+        for (auto& value : node->values) {
+            fn(value.first, value.second);
+        }
+        for (auto& child : node->children) {
+            ForEach(child.get(), fn);
+        }
+    }
+
+   public:
+    /// Get the number of values
+    size_t size() const { return value_count; }
+    /// Is the map empty?
+    bool empty() const { return value_count == 0; }
+    /// Clear the map
+    void clear() {
+        root = nullptr;
+        value_count = 0;
+    }
+    /// Find the value of a key, returns null if the key is not present
+    template <typename K> const Mapped* find(const K& key) const {
+        auto* value = Find(root.get(), Hash{}(key), key);
+        return value ? &value->second : nullptr;
+    }
+    /// Contains a key?
+    template <typename K> bool contains(const K& key) const { return find(key) != nullptr; }
+    /// Find the value of a key for modification, returns null if the key is not present.
+    /// Copies the nodes that are shared with other maps on the path to the key.
+    template <typename K> Mapped* find_mutable(const K& key) {
+        auto hash = Hash{}(key);
+        if (!Find(root.get(), hash, key)) {
+            return nullptr;
+        }
+        return &FindMutable(root, hash, key, 0)->second;
+    }
+    /// Insert a value if the key is not present, returns the value of the key and whether it was inserted
+    std::pair<Mapped&, bool> try_emplace(Key key, Mapped mapped = {}) {
+        if (auto* existing = find_mutable(key)) {
+            return {*existing, false};
+        }
+        auto hash = Hash{}(key);
+        auto* value = Insert(root, hash, value_type{std::move(key), std::move(mapped)}, 0);
+        ++value_count;
+        return {value->second, true};
+    }
+    /// Insert or replace the value of a key
+    void insert_or_assign(Key key, Mapped mapped) {
+        auto [value, inserted] = try_emplace(std::move(key));
+        value = std::move(mapped);
+    }
+    /// Erase a key, returns false if the key is not present
+    template <typename K> bool erase(const K& key) {
+        auto hash = Hash{}(key);
+        if (!Find(root.get(), hash, key)) {
+            return false;
+        }
+        Erase(root, hash, key, 0);
+        --value_count;
+        return true;
+    }
+    /// Visit all values in arbitrary order
+    template <typename Fn> void ForEach(Fn fn) const { ForEach(root.get(), fn); }
+};
+
+}  // namespace dashql
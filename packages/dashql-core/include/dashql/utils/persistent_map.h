@@ -0,0 +1,297 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace dashql {
+
+/// A persistent ordered tree.
+///
+/// Copies of the tree share all nodes, a modification only copies the nodes on the path to the modified key.
+/// Catalog snapshots copy the indexes of the catalog, the copy is therefore O(1) and every later modification of the
+/// catalog costs O(log n) node copies instead of a full copy of the index.
+///
+/// The tree is a treap, the random node priorities keep the expected depth logarithmic without rebalancing.
+/// Nodes that are referenced by a single tree only are modified in place.
+/// Different trees may be read from different threads as long as every tree is modified by a single thread.
+template <typename Value, typename KeyOf, typename Compare> struct PersistentTree {
+   public:
+    using value_type = Value;
+    using key_type = std::remove_cvref_t<decltype(KeyOf{}(std::declval<const Value&>()))>;
+
+   protected:
+    /// A tree node
+    struct Node {
+        /// The value
+        Value value;
+        /// The priority, parents have a higher priority than their children
+        uint32_t priority;
+        /// The left child
+        std::shared_ptr<Node> left;
+        /// The right child
+        std::shared_ptr<Node> right;
+    };
+    using NodePtr = std::shared_ptr<Node>;
+
+   public:
+    /// An in-order iterator
+    struct const_iterator {
+        friend struct PersistentTree;
+
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Value;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Value*;
+        using reference = const Value&;
+
+       protected:
+        /// The nodes that are yet to be visited, the current node is at the back
+        std::vector<const Node*> stack;
+
+        /// Push a node and all its left descendants
+        void PushLeft(const Node* node) {
+            for (; node; node = node->left.get()) {
+                stack.push_back(node);
+            }
+        }
+        /// Get the current node
+        const Node* Current() const { return stack.empty() ? nullptr : stack.back(); }
+
+       public:
+        /// Reference operator
+        const Value& operator*() const {
+            assert(!stack.empty());
+            return stack.back()->value;
+        }
+        /// Pointer operator
+        const Value* operator->() const {
+            assert(!stack.empty());
+            return &stack.back()->value;
+        }
+        /// Prefix increment
+        const_iterator& operator++() {
+            assert(!stack.empty());
+            auto* node = stack.back();
+            stack.pop_back();
+            PushLeft(node->right.get());
+            return *this;
+        }
+        /// Postfix increment
+        const_iterator operator++(int) {
+            auto copy = *this;
+            ++*this;
+            return copy;
+        }
+        /// Equality
+        bool operator==(const const_iterator& other) const { return Current() == other.Current(); }
+    };
+    using iterator = const_iterator;
+
+   protected:
+    /// The root node
+    NodePtr root;
+    /// The number of values
+    size_t value_count = 0;
+
+    /// Draw a node priority
+    static uint32_t NextPriority() {
+        thread_local uint64_t state = 0x9E3779B97F4A7C15ull;
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return static_cast<uint32_t>(state >> 32);
+    }
+    /// Is a node referenced by this tree only?
+    /// The acquire fence orders our writes after the reads of threads that released their references.
+    static bool IsExclusive(const NodePtr& node) {
+        if (node.use_count() != 1) return false;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return true;
+    }
+    /// Make a node writable, copies the node if it is shared with other trees
+    static Node* MakeMutable(NodePtr& node) {
+        if (!IsExclusive(node)) {
+            node = std::make_shared<Node>(*node);
+        }
+        return node.get();
+    }
+    /// Split a tree into the values ordered before a key and the remaining ones
+    static void Split(NodePtr tree, const key_type& key, NodePtr& left, NodePtr& right) {
+        if (!tree) {
+            left = nullptr;
+            right = nullptr;
+            return;
+        }
+        auto* node = MakeMutable(tree);
+        if (Compare{}(KeyOf{}(node->value), key)) {
+            Split(std::move(node->right), key, node->right, right);
+            left = std::move(tree);
+        } else {
+            Split(std::move(node->left), key, left, node->left);
+            right = std::move(tree);
+        }
+    }
+    /// Merge two trees, all values of the left tree are ordered before the values of the right tree
+    static NodePtr Merge(NodePtr left, NodePtr right) {
+        if (!left) return right;
+        if (!right) return left;
+        if (left->priority > right->priority) {
+            auto* node = MakeMutable(left);
+            node->right = Merge(std::move(node->right), std::move(right));
+            return left;
+        } else {
+            auto* node = MakeMutable(right);
+            node->left = Merge(std::move(left), std::move(node->left));
+            return right;
+        }
+    }
+    /// Insert a node with a key that is not yet part of the tree
+    static NodePtr Insert(NodePtr tree, NodePtr inserted) {
+        if (!tree) return inserted;
+        auto& key = KeyOf{}(inserted->value);
+        if (inserted->priority > tree->priority) {
+            Split(std::move(tree), key, inserted->left, inserted->right);
+            return inserted;
+        }
+        auto* node = MakeMutable(tree);
+        if (Compare{}(key, KeyOf{}(node->value))) {
+            node->left = Insert(std::move(node->left), std::move(inserted));
+        } else {
+            node->right = Insert(std::move(node->right), std::move(inserted));
+        }
+        return tree;
+    }
+    /// Erase a key that is part of the tree
+    static NodePtr Erase(NodePtr tree, const key_type& key) {
+        assert(tree);
+        if (Compare{}(key, KeyOf{}(tree->value))) {
+            auto* node = MakeMutable(tree);
+            node->left = Erase(std::move(node->left), key);
+            return tree;
+        }
+        if (Compare{}(KeyOf{}(tree->value), key)) {
+            auto* node = MakeMutable(tree);
+            node->right = Erase(std::move(node->right), key);
+            return tree;
+        }
+        if (IsExclusive(tree)) {
+            return Merge(std::move(tree->left), std::move(tree->right));
+        }
+        return Merge(tree->left, tree->right);
+    }
+
+   public:
+    /// Get the number of values
+    size_t size() const { return value_count; }
+    /// Is the tree empty?
+    bool empty() const { return value_count == 0; }
+    /// Clear the tree
+    void clear() {
+        root = nullptr;
+        value_count = 0;
+    }
+    /// Get an iterator to the first value
+    const_iterator begin() const {
+        const_iterator iter;
+        iter.PushLeft(root.get());
+        return iter;
+    }
+    /// Get the end iterator
+    const_iterator end() const { return const_iterator{}; }
+    /// Get an iterator to the first value with a key that is not ordered before the given key
+    const_iterator lower_bound(const key_type& key) const {
+        const_iterator iter;
+        for (auto* node = root.get(); node;) {
+            if (!Compare{}(KeyOf{}(node->value), key)) {
+                iter.stack.push_back(node);
+                node = node->left.get();
+            } else {
+                node = node->right.get();
+            }
+        }
+        return iter;
+    }
+    /// Get an iterator to the first value with a key that is ordered after the given key
+    const_iterator upper_bound(const key_type& key) const {
+        const_iterator iter;
+        for (auto* node = root.get(); node;) {
+            if (Compare{}(key, KeyOf{}(node->value))) {
+                iter.stack.push_back(node);
+                node = node->left.get();
+            } else {
+                node = node->right.get();
+            }
+        }
+        return iter;
+    }
+    /// Find a key
+    const_iterator find(const key_type& key) const {
+        auto iter = lower_bound(key);
+        if (iter != end() && Compare{}(key, KeyOf{}(*iter))) {
+            return end();
+        }
+        return iter;
+    }
+    /// Contains a key?
+    bool contains(const key_type& key) const {
+        for (auto* node = root.get(); node;) {
+            if (Compare{}(key, KeyOf{}(node->value))) {
+                node = node->left.get();
+            } else if (Compare{}(KeyOf{}(node->value), key)) {
+                node = node->right.get();
+            } else {
+                return true;
+            }
+        }
+        return false;
+    }
+    /// Insert a value, returns false if the key is already present
+    bool insert(Value value) {
+        if (contains(KeyOf{}(value))) {
+            return false;
+        }
+        auto node = std::make_shared<Node>(Node{std::move(value), NextPriority(), nullptr, nullptr});
+        root = Insert(std::move(root), std::move(node));
+        ++value_count;
+        return true;
+    }
+    /// Erase a key, returns false if the key is not present.
+    /// The key is taken by value since it may point into the erased value.
+    bool erase(key_type key) {
+        if (!contains(key)) {
+            return false;
+        }
+        root = Erase(std::move(root), key);
+        --value_count;
+        return true;
+    }
+};
+
+namespace detail {
+/// Get the key of a set value
+template <typename Key> struct PersistentSetKey {
+    const Key& operator()(const Key& key) const { return key; }
+};
+/// Get the key of a map value
+template <typename Key, typename Mapped> struct PersistentMapKey {
+    const Key& operator()(const std::pair<const Key, Mapped>& value) const { return value.first; }
+};
+}  // namespace detail
+
+/// A persistent ordered set
+template <typename Key, typename Compare = std::less<Key>>
+using PersistentSet = PersistentTree<Key, detail::PersistentSetKey<Key>, Compare>;
+/// A persistent ordered map
+template <typename Key, typename Mapped, typename Compare = std::less<Key>>
+using PersistentMap =
+    PersistentTree<std::pair<const Key, Mapped>, detail::PersistentMapKey<Key, Mapped>, Compare>;
+
+}  // namespace dashql
@@ -11,6 +11,11 @@ extern const std::array<unsigned char, 256> TOLOWER_ASCII_TABLE;
 // This will return weird results with non-ascii characters, use with caution
 inline unsigned char tolower_fuzzy(unsigned char c) { return TOLOWER_ASCII_TABLE[c]; }
 
+/// Fold a text to lower-case and write it to `out`, which must hold at least `text.size()` bytes.
+/// Returns true if the text was lower-case already, in which case `out` equals `text`.
+/// Folds 16 bytes at a time with SSE2, NEON or WASM SIMD128 and matches `tolower_fuzzy` byte by byte.
+bool fold_lower_fuzzy(std::string_view text, char *out);
+
 inline bool anyupper_fuzzy(std::string_view s) {
     bool anyupper = false;
     for (char c : s) {
@@ -7,6 +7,8 @@
 #include <span>
 #include <vector>
 
+#include "dashql/utils/arena.h"
+
 namespace dashql {
 
 template <size_t InitialSize = 1024> struct StringPool {
@@ -20,6 +22,8 @@ template <size_t InitialSize = 1024> struct StringPool {
         size_t size = 0;
     };
 
+    /// The arena, null if pages are allocated on the heap
+    Arena* arena;
     /// The buffers
     std::vector<Page> pages;
     /// The next chunk size
@@ -40,13 +44,22 @@ template <size_t InitialSize = 1024> struct StringPool {
     }
 
    public:
-    /// Constructor
-    StringPool() : pages(), next_chunk_size(InitialSize) { grow(); }
+    /// Constructor.
+    /// With an arena, strings are allocated in the arena directly and the pool only counts bytes.
+    explicit StringPool(Arena* arena = nullptr) : arena(arena), pages(), next_chunk_size(InitialSize) {
+        if (!arena) {
+            grow();
+        }
+    }
 
     /// Get the size
     size_t GetSize() { return total_string_bytes; }
     /// Append a node
     std::span<char> Allocate(size_t n) {
+        if (arena) {
+            total_string_bytes += n;
+            return std::span<char>{static_cast<char*>(arena->Allocate(n, 1)), n};
+        }
         Page& last = pages.back();
         if ((last.capacity - last.size) >= n) {
             char* begin = last.buffer.get() + last.size;
@@ -27,7 +27,7 @@ template <class T, size_t InitialSize = 128> class TempNodePool {
 
    public:
     /// Constructor
-    TempNodePool() = default;
+    explicit TempNodePool(Arena *arena = nullptr) : node_buffer(arena) {}
     /// Move constructor
     TempNodePool(TempNodePool &&memoryPool) = delete;
     /// Copy constructor
@@ -55,6 +55,9 @@ template <typename ValueType> struct TopKHeap {
             }
         }
     }
+    /// Is the heap full?
+    /// Once full, the front entry is the minimum that a new entry has to exceed.
+    bool IsFull() const { return entries.size() == entries.capacity(); }
     /// Clear the heap
     void Clear() { entries.clear(); }
     /// Finish the entries
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dashql {
+
+/// A pool of worker threads that is reused across parallel loops.
+///
+/// The workers are spawned once and then wait for the next loop, a loop therefore does not pay for thread creation.
+/// The calling thread runs iterations as well and loops of different threads are serialized.
+/// Loop functions must not throw.
+class WorkerPool {
+   protected:
+    /// The mutex
+    std::mutex mutex;
+    /// The mutex that serializes the loops of different threads
+    std::mutex loop_mutex;
+    /// Signals a new loop or the shutdown to the workers
+    std::condition_variable loop_started;
+    /// Signals the end of a loop to the caller
+    std::condition_variable loop_finished;
+    /// The function of the current loop
+    const std::function<void(size_t)>* loop_fn = nullptr;
+    /// The iteration count of the current loop
+    size_t loop_size = 0;
+    /// The next iteration of the current loop
+    std::atomic<size_t> next_iteration{0};
+    /// The loop generation
+    size_t generation = 0;
+    /// The number of workers that did not finish the current loop
+    size_t busy_workers = 0;
+    /// Shut down the workers?
+    bool shutdown = false;
+    /// The workers
+    std::vector<std::thread> workers;
+
+    /// Claim and run iterations of the current loop
+    void RunIterations() {
+        for (size_t i = next_iteration.fetch_add(1); i < loop_size; i = next_iteration.fetch_add(1)) {
+            (*loop_fn)(i);
+        }
+    }
+    /// Run a worker
+    void Work() {
+        size_t seen_generation = 0;
+        std::unique_lock<std::mutex> lock{mutex};
+        while (true) {
+            loop_started.wait(lock, [&]() { return shutdown || generation != seen_generation; });
+            if (shutdown) return;
+            seen_generation = generation;
+            lock.unlock();
+            RunIterations();
+            lock.lock();
+            if (--busy_workers == 0) {
+                loop_finished.notify_all();
+            }
+        }
+    }
+
+   public:
+    /// Constructor, spawns the workers
+    explicit WorkerPool(size_t worker_count) {
+        workers.reserve(worker_count);
+        for (size_t i = 0; i < worker_count; ++i) {
+            workers.emplace_back([this]() { Work(); });
+        }
+    }
+    /// Destructor, joins the workers
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            shutdown = true;
+        }
+        loop_started.notify_all();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+
+    /// Get the number of workers
+    size_t GetWorkerCount() const { return workers.size(); }
+    /// Run a function for every iteration in [0, n) and wait for all of them
+    void ParallelFor(size_t n, const std::function<void(size_t)>& fn) {
+        if (workers.empty() || n <= 1) {
+            for (size_t i = 0; i < n; ++i) {
+                fn(i);
+            }
+            return;
+        }
+        std::lock_guard<std::mutex> loop_lock{loop_mutex};
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            loop_fn = &fn;
+            loop_size = n;
+            next_iteration.store(0);
+            busy_workers = workers.size();
+            ++generation;
+        }
+        loop_started.notify_all();
+        RunIterations();
+        std::unique_lock<std::mutex> lock{mutex};
+        loop_finished.wait(lock, [&]() { return busy_workers == 0; });
+        loop_fn = nullptr;
+    }
+
+    /// Get the pool that is shared by the whole process.
+    /// The workers are spawned with the first call, one hardware thread is left for the calling thread.
+    static WorkerPool& GetShared() {
+        static WorkerPool pool{std::max(1u, std::thread::hardware_concurrency()) - 1};
+        return pool;
+    }
+};
+
+}  // namespace dashql
@@ -14,10 +14,12 @@ AnalysisState::AnalysisState(std::shared_ptr<ParsedScript> parsed, Catalog& cata
       analyzed(std::make_shared<AnalyzedScript>(parsed, catalog)),
       catalog_entry_id(parsed->external_id),
       catalog(catalog),
+      catalog_snapshot(catalog.GetSnapshot()),
       empty_name(parsed->scanned_script->name_registry.Register("")),
       expression_index(parsed->GetNodes().size(), nullptr) {
     empty_name.coarse_analyzer_tags |= buffers::analyzer::NameTag::DATABASE_NAME;
     empty_name.coarse_analyzer_tags |= buffers::analyzer::NameTag::SCHEMA_NAME;
+    analyzed->catalog_version = catalog_snapshot->GetVersion();
 }
 
 std::span<std::reference_wrapper<RegisteredName>> AnalysisState::ReadNamePath(const sx::parser::Node& node) {
@@ -6,6 +6,10 @@
 #include <array>
 #include <variant>
 
+#ifndef WASM
+#include "dashql/utils/worker_pool.h"
+#endif
+
 #include "dashql/buffers/index_generated.h"
 #include "dashql/catalog.h"
 #include "dashql/catalog_object.h"
@@ -94,6 +98,8 @@ static constexpr Completion::ScoreValueType IDENTITY_SCORE_COLUMN_REF = 59;
 // Cap identity candidate length. Guards against runaway tokens (e.g. a delimited
 // identifier missing its closing quote consumes everything up to the next quote).
 static constexpr size_t MAX_IDENTITY_LENGTH = 64;
+/// The minimum number of catalog entries to search their name indexes in parallel
+static constexpr size_t PARALLEL_INDEX_SEARCH_MIN_ENTRIES = 4;
 
 // Design choices for the score modifiers
 static_assert((NAME_TAG_UNLIKELY + SUBSTRING_SCORE_MODIFIER) > NAME_TAG_LIKELY,
@@ -178,6 +184,28 @@ static constexpr NameScoringTable NAME_SCORE_COLUMN_REF{{
     {buffers::analyzer::NameTag::FUNCTION_NAME, NAME_TAG_UNLIKELY},
 }};
 
+static const NameScoringTable& selectNameScoringTable(buffers::completion::CompletionStrategy strategy) {
+    switch (strategy) {
+        case buffers::completion::CompletionStrategy::TABLE_REF_ALIAS:
+        case buffers::completion::CompletionStrategy::DEFAULT:
+            return NAME_SCORE_DEFAULTS;
+        case buffers::completion::CompletionStrategy::TABLE_REF:
+            return NAME_SCORE_TABLE_REF;
+        case buffers::completion::CompletionStrategy::COLUMN_REF:
+            return NAME_SCORE_COLUMN_REF;
+    }
+    return NAME_SCORE_DEFAULTS;
+}
+
+/// Derive the name score as maximum among the name tags
+static Completion::ScoreValueType computeNameScore(const NameScoringTable& table, NameTags tags) {
+    Completion::ScoreValueType score = 0;
+    for (auto [tag, tag_score] : table) {
+        score = std::max(score, tags.contains(tag) ? tag_score : 0);
+    }
+    return score;
+}
+
 /// We use a prevalence score to rank keywords by popularity.
 /// It is much more likely that a user wants to complete certain keywords than others.
 /// The added score is chosen so small that it only influences the ranking among similarly ranked keywords.
@@ -883,39 +911,33 @@ void Completion::AddExpectedKeywordsAsCandidates(std::span<parser::Parser::Expec
     }
 }
 
-void Completion::findCandidatesInIndex(const CatalogEntry::NameSearchIndex& index, bool through_catalog) {
+void Completion::findCandidatesInIndex(const CatalogEntry::NameSearchIndex& index,
+                                       std::span<const NameSearchIndex::Suffix> suffixes, bool through_catalog,
+                                       bool known_names_only) {
     using Relative = ScannedScript::LocationInfo::RelativePosition;
     auto& target_symbol = target_scanner_symbol;
-    auto cursor_offset = cursor.text_offset;
 
     // Get the current cursor prefix
-    auto symbol_ofs = target_symbol->symbol.location.offset();
-    auto safe_cursor_offset =
-        std::min(std::max<uint32_t>(symbol_ofs, cursor_offset), symbol_ofs + target_symbol->symbol.location.length());
-    auto symbol_text = cursor.script.scanned_script->ReadTextAtTextSpan(
-        sx::parser::TextSpan(target_symbol->symbol.location.offset(), target_symbol->symbol.location.length()));
-    auto symbol_prefix =
-        std::min<uint32_t>(std::max<uint32_t>(safe_cursor_offset, symbol_ofs) - symbol_ofs, symbol_text.size());
-    auto symbol_text_trimmed = trim_view({symbol_text.data(), symbol_prefix}, is_no_double_quote);
+    auto symbol_text_trimmed = ReadTargetPrefix();
     fuzzy_ci_string_view ci_prefix_text{symbol_text_trimmed.data(), symbol_text_trimmed.size()};
 
-    // Fall back to the full word if the cursor prefix is empty
-    auto search_text = ci_prefix_text;
-    if (search_text.empty()) {
-        auto token_unquoted = trim_view(symbol_text, is_no_double_quote);
-        search_text = {token_unquoted.data(), token_unquoted.size()};
-    }
+    pruned_indexes += known_names_only;
 
-    // Find all suffixes for the cursor prefix
-    for (auto iter = index.lower_bound(search_text); iter != index.end() && iter->first.starts_with(search_text);
-         ++iter) {
-        auto& name_info = iter->second.get();
+    // Visit all suffixes that match the search text
+    for (auto& suffix : suffixes) {
+        auto& name_info = index.GetName(suffix);
         // Check if it's the cursor symbol
         if (!through_catalog && name_info.occurrences == 1 &&
             target_symbol->text_offset >= name_info.location.offset() &&
             target_symbol->text_offset <= (name_info.location.offset() + name_info.location.length())) {
             continue;
         }
+        // Skip unknown names without tagging them if the index cannot lift any of them into the top-k candidates
+        auto known_iter = candidates_by_name.find(name_info.text);
+        if (known_names_only && known_iter == candidates_by_name.end() && !isPromotableName(name_info)) {
+            ++pruned_index_matches;
+            continue;
+        }
         // Determine the candidate tags
         Completion::CandidateTags candidate_tags{buffers::completion::CandidateTag::NAME_INDEX};
         // Added through catalog?
@@ -939,11 +961,16 @@ void Completion::findCandidatesInIndex(const CatalogEntry::NameSearchIndex& inde
 
         // Do we know the candidate already?
         Candidate* candidate;
-        if (auto iter = candidates_by_name.find(name_info.text); iter != candidates_by_name.end()) {
-            candidate = &iter->second.get();
+        if (known_iter != candidates_by_name.end()) {
+            candidate = &known_iter->second.get();
             candidate->coarse_name_tags |= name_info.coarse_analyzer_tags;
             candidate->candidate_tags |= candidate_tags;
         } else {
+            // Skip names that can no longer reach the top-k candidates
+            if (prune_index_matches && isPrunableIndexMatch(name_info, candidate_tags)) {
+                ++pruned_index_matches;
+                continue;
+            }
             candidate = &candidates.PushBack(Candidate{
                 .completion_text = name_info.text,
                 .coarse_name_tags = name_info.coarse_analyzer_tags,
@@ -953,6 +980,14 @@ void Completion::findCandidatesInIndex(const CatalogEntry::NameSearchIndex& inde
                 .catalog_objects = {},
             });
             candidates_by_name.insert({name_info.text, *candidate});
+
+            // Every object of the candidate carries at least the tags of this match.
+            // Name tags and candidate tags only grow from here on, so this is a lower bound of the final score.
+            if (prune_index_matches) {
+                auto& name_scoring_table = selectNameScoringTable(strategy);
+                score_lower_bounds.Insert(computeNameScore(name_scoring_table, name_info.coarse_analyzer_tags) +
+                                          computeCandidateScore(candidate_tags));
+            }
         }
 
         // Add the resolved objects
@@ -980,16 +1015,229 @@ void Completion::findCandidatesInIndex(const CatalogEntry::NameSearchIndex& inde
     }
 }
 
-void Completion::FindCandidatesInIndexes() {
-    if (auto& analyzed = cursor.script.analyzed_script) {
-        // Find candidates in name dictionary of main script
-        findCandidatesInIndex(analyzed->GetNameSearchIndex(), false);
-        // Find candidates in name dictionary of external script
-        cursor.script.catalog.IterateRanked([this, &analyzed](auto entry_id, auto& entry, size_t rank) {
-            if (&entry != analyzed.get()) {
-                findCandidatesInIndex(entry.GetNameSearchIndex(), true);
+void Completion::PrepareIndexMatchPruning() {
+    auto& analyzed = cursor.script.analyzed_script;
+    auto& parsed = cursor.script.parsed_script;
+    prune_index_matches = false;
+    if (!index_match_pruning_enabled || !analyzed || !parsed || candidate_heap.GetEntries().capacity() == 0) return;
+
+    // Output columns of inline VISUALIZE sources are added from another scope, don't prune there
+    auto& nodes = parsed->nodes;
+    bool in_visualize_spec = std::ranges::any_of(cursor.ast_path_to_root, [&](auto node_id) {
+        return nodes[node_id].attribute_key() == buffers::parser::AttributeKey::VIS_VISUALISE_SPEC;
+    });
+    if (in_visualize_spec) return;
+
+    // The highest name score that a name can reach through the tags of other catalog entries
+    for (auto [tag, tag_score] : selectNameScoringTable(strategy)) {
+        max_name_score = std::max(max_name_score, tag_score);
+    }
+    // Keywords and the identity candidate already have their final scores
+    for (auto& candidate : candidate_heap.GetEntries()) {
+        score_lower_bounds.Insert(candidate.score);
+    }
+
+    // Collect the names that FindCandidatesInScope, PromoteIdentifiersInScope and
+    // PromoteTablesAndPeersForUnresolvedColumns may touch.
+    // This is a superset, the scopes of a cursor are small.
+    auto add_name = [&](std::string_view name) {
+        std::string folded;
+        folded.reserve(name.size());
+        for (char c : name) {
+            folded.push_back(static_cast<char>(tolower_fuzzy(c)));
+        }
+        promotable_names.insert(std::move(folded));
+    };
+    auto add_table = [&](const CatalogEntry::TableDeclaration& table) {
+        add_name(table.table_name.table_name.get().text);
+        for (auto& column : table.table_columns) {
+            add_name(column.column_name.get().text);
+        }
+    };
+    std::vector<CatalogEntry::TableColumn> tmp_columns;
+    for (auto& scope_ref : cursor.name_scopes) {
+        auto& scope = scope_ref.get();
+        for (auto& [_, cte] : scope.cte_definitions) {
+            add_name(cte.cte_name.get().text);
+        }
+        for (auto& [_, table] : scope.referenced_tables_by_name) {
+            if (auto* cte = std::get_if<std::reference_wrapper<ResolvedCTE>>(&table.source)) {
+                forEachResolvedCTEColumn(cte->get(), [&](const RegisteredName& name) { add_name(name.text); });
             }
-        });
+        }
+        for (auto& table_ref : scope.table_references) {
+            auto* rel_expr = std::get_if<AnalyzedScript::TableReference::RelationExpression>(&table_ref.inner);
+            if (!rel_expr || !rel_expr->resolved_table.has_value()) continue;
+            auto table_id = rel_expr->resolved_table->catalog_table_id.UnpackTableID();
+            if (auto* table = cursor.script.catalog.ResolveTable(table_id)) {
+                add_table(*table);
+            }
+        }
+        for (auto& expr : scope.expressions) {
+            auto* column_ref = std::get_if<AnalyzedScript::Expression::ColumnRef>(&expr.inner);
+            if (!column_ref) continue;
+            if (column_ref->IsResolved()) {
+                if (auto* column = std::get_if<std::reference_wrapper<const CatalogEntry::TableColumn>>(
+                        &column_ref->resolved)) {
+                    add_name(column->get().column_name.get().text);
+                }
+                continue;
+            }
+            tmp_columns.clear();
+            analyzed->ResolveTableColumnsWithCatalog(column_ref->column_name.column_name.get(), tmp_columns);
+            for (auto& table_col : tmp_columns) {
+                add_table(table_col.table->get());
+            }
+        }
+    }
+    prune_index_matches = true;
+}
+
+bool Completion::isPrunableIndexMatch(const RegisteredName& name, CandidateTags candidate_tags) {
+    if (!score_lower_bounds.IsFull()) return false;
+    // The bound only depends on the name text and not on the catalog entry.
+    // A pruned name is therefore pruned in every later entry as well, the lower bounds only grow.
+    candidate_tags |= buffers::completion::CandidateTag::THROUGH_CATALOG;
+    auto score_bound = max_name_score + computeCandidateScore(candidate_tags);
+    if (score_bound >= score_lower_bounds.GetEntries().front()) return false;
+    // Local candidates and promotions may still lift the name
+    return !isPromotableName(name);
+}
+
+bool Completion::isPrunableIndex(const CatalogEntry::NameSearchIndex& index) {
+    using Relative = ScannedScript::LocationInfo::RelativePosition;
+    if (!prune_index_matches || !score_lower_bounds.IsFull()) return false;
+
+    // Determine the best tags of a match in this index.
+    // Prefix and exact matches are cheap to rule out through the prefixes of the index.
+    Completion::CandidateTags best_tags{buffers::completion::CandidateTag::NAME_INDEX};
+    best_tags |= buffers::completion::CandidateTag::THROUGH_CATALOG;
+    switch (target_scanner_symbol->relative_pos) {
+        case Relative::BEGIN_OF_SYMBOL:
+        case Relative::MID_OF_SYMBOL:
+        case Relative::END_OF_SYMBOL: {
+            best_tags |= buffers::completion::CandidateTag::SUBSTRING_MATCH;
+            auto prefix_text = ReadTargetPrefix();
+            auto prefixes = index.FindPrefixes(prefix_text);
+            if (!prefixes.empty()) {
+                best_tags |= buffers::completion::CandidateTag::PREFIX_MATCH;
+                // A name that equals the prefix text is ordered first
+                if (index.GetName(prefixes.front()).text.size() == prefix_text.size()) {
+                    best_tags |= buffers::completion::CandidateTag::EXACT_MATCH;
+                }
+            }
+            break;
+        }
+        default:
+            break;
+    }
+    auto score_bound = max_name_score + computeCandidateScore(best_tags);
+    return score_bound < score_lower_bounds.GetEntries().front();
+}
+
+bool Completion::isPromotableName(const RegisteredName& name) {
+    folded_name_buffer.clear();
+    for (char c : name.text) {
+        folded_name_buffer.push_back(static_cast<char>(tolower_fuzzy(c)));
+    }
+    return promotable_names.contains(folded_name_buffer);
+}
+
+void Completion::FindCandidatesInIndexes() {
+    auto& analyzed = cursor.script.analyzed_script;
+    if (!analyzed) return;
+    auto search_text = ReadSearchText();
+    PrepareIndexMatchPruning();
+
+    // Find candidates in name dictionary of main script.
+    // The main script changes with every keystroke, we therefore always search its index.
+    auto& script_index = analyzed->GetNameSearchIndex();
+    findCandidatesInIndex(script_index, script_index.FindSuffixes(search_text), false);
+
+    // Fold the search text
+    std::string folded_search_text;
+    folded_search_text.reserve(search_text.size());
+    for (char c : search_text) {
+        folded_search_text.push_back(static_cast<char>(tolower_fuzzy(c)));
+    }
+
+    // Did the user only extend the search text of the previous completion?
+    // Then the matching suffixes of every catalog entry are a sub-range of the cached ones.
+    auto& catalog = cursor.script.catalog;
+    if (cache && cache->valid && cache->catalog_version == catalog.GetVersion() &&
+        cache->statement_id == cursor.statement_id &&
+        cache->symbol_offset == target_scanner_symbol->symbol.location.offset() && cache->strategy == strategy &&
+        std::string_view{folded_search_text}.starts_with(cache->search_text)) {
+        auto& lookups = cache->index_lookups;
+        size_t n = 0;
+        for (auto& lookup : lookups) {
+            lookup.suffixes = lookup.index->FindSuffixes(search_text, lookup.suffixes);
+            if (lookup.suffixes.empty()) continue;
+            findCandidatesInIndex(*lookup.index, lookup.suffixes, true, isPrunableIndex(*lookup.index));
+            lookups[n++] = lookup;
+        }
+        lookups.resize(n);
+        cache->search_text = std::move(folded_search_text);
+        ++cache->hits;
+        return;
+    }
+
+    // Collect the name indexes of the external catalog entries in rank order.
+    // Descriptor pools keep a name index per segment.
+    std::vector<std::pair<CatalogEntry*, size_t>> indexes;
+    bool cacheable = true;
+    catalog.IterateRanked([&](auto entry_id, auto& entry, size_t rank) {
+        if (&entry == analyzed.get()) {
+            // The main script is registered in the catalog.
+            // The next analysis replaces it without changing the catalog version, don't cache the lookups.
+            cacheable = false;
+            return;
+        }
+        for (size_t i = 0; i < entry.GetNameSearchIndexCount(); ++i) {
+            indexes.push_back({&entry, i});
+        }
+    });
+
+    // Search the name indexes of all entries
+    std::vector<CompletionCache::IndexLookup> lookups(indexes.size());
+    auto search_index = [&](size_t i) {
+        auto& [entry, entry_index] = indexes[i];
+        auto& index = entry->GetNameSearchIndex(entry_index);
+        lookups[i] = {.index = &index, .suffixes = index.FindSuffixes(search_text)};
+    };
+#ifndef WASM
+    if (parallel_index_search && indexes.size() >= PARALLEL_INDEX_SEARCH_MIN_ENTRIES) {
+        // Every index is built lazily and independently.
+        // Workers therefore build and search disjoint indexes, we only merge the matches below.
+        WorkerPool::GetShared().ParallelFor(indexes.size(), search_index);
+    } else
+#endif
+    {
+        for (size_t i = 0; i < indexes.size(); ++i) {
+            search_index(i);
+        }
+    }
+
+    // Find candidates among the matches in rank order.
+    // Candidates merge across entries by name, so this stays sequential.
+    size_t n = 0;
+    for (auto& lookup : lookups) {
+        if (lookup.suffixes.empty()) continue;
+        findCandidatesInIndex(*lookup.index, lookup.suffixes, true, isPrunableIndex(*lookup.index));
+        lookups[n++] = lookup;
+    }
+    lookups.resize(n);
+
+    // Remember the lookups for the next keystroke
+    if (cache) {
+        ++cache->misses;
+        cache->valid = cacheable;
+        cache->catalog_version = catalog.GetVersion();
+        cache->statement_id = cursor.statement_id;
+        cache->symbol_offset = target_scanner_symbol->symbol.location.offset();
+        cache->strategy = strategy;
+        cache->search_text = std::move(folded_search_text);
+        cache->index_lookups = std::move(lookups);
     }
 }
 
@@ -1008,6 +1256,17 @@ std::string_view Completion::ReadTargetPrefix() const {
     return trim_view({symbol_text.data(), symbol_prefix}, is_no_double_quote);
 }
 
+std::string_view Completion::ReadSearchText() const {
+    if (!target_scanner_symbol.has_value()) return {};
+    auto prefix = ReadTargetPrefix();
+    if (!prefix.empty()) return prefix;
+    // Fall back to the full word if the cursor prefix is empty
+    auto& location = target_scanner_symbol->symbol.location;
+    auto symbol_text =
+        cursor.script.scanned_script->ReadTextAtTextSpan(sx::parser::TextSpan(location.offset(), location.length()));
+    return trim_view(symbol_text, is_no_double_quote);
+}
+
 void Completion::AddLocalCandidate(std::string_view name, NameTags name_tags, CandidateTags candidate_tags,
                                    std::string_view prefix, sx::parser::SymbolSpan target_location,
                                    sx::parser::SymbolSpan target_location_qualified) {
@@ -1268,19 +1527,6 @@ void Completion::PromoteTablesAndPeersForUnresolvedColumns() {
     }
 }
 
-static const NameScoringTable& selectNameScoringTable(buffers::completion::CompletionStrategy strategy) {
-    switch (strategy) {
-        case buffers::completion::CompletionStrategy::TABLE_REF_ALIAS:
-        case buffers::completion::CompletionStrategy::DEFAULT:
-            return NAME_SCORE_DEFAULTS;
-        case buffers::completion::CompletionStrategy::TABLE_REF:
-            return NAME_SCORE_TABLE_REF;
-        case buffers::completion::CompletionStrategy::COLUMN_REF:
-            return NAME_SCORE_COLUMN_REF;
-    }
-    return NAME_SCORE_DEFAULTS;
-}
-
 void Completion::SelectTopCandidates() {
     // Resolve the scoring table
     auto& base_scoring_table = selectNameScoringTable(strategy);
@@ -1298,10 +1544,7 @@ void Completion::SelectTopCandidates() {
     // Insert all pending candidates into the heap
     candidates.ForEach([&](size_t i, Candidate& candidate) {
         // Derive the base score as maximum among the name tags
-        Completion::ScoreValueType base_score = 0;
-        for (auto [tag, tag_score] : base_scoring_table) {
-            base_score = std::max(base_score, candidate.coarse_name_tags.contains(tag) ? tag_score : 0);
-        }
+        Completion::ScoreValueType base_score = computeNameScore(base_scoring_table, candidate.coarse_name_tags);
         // Then find the top n best candidate objects.
         // Splitting off the base score ensures that we're not depending on resolving catalog objects too much.
         catalog_object_heap.Clear();
@@ -1578,12 +1821,20 @@ static buffers::completion::CompletionStrategy selectStrategy(const ScriptCursor
 }
 
 Completion::Completion(const ScriptCursor& cursor, size_t k)
-    : cursor(cursor), strategy(selectStrategy(cursor)), target_scanner_symbol(), candidate_heap(k) {}
-
-std::unique_ptr<Completion> Completion::Compute(const ScriptCursor& cursor, size_t k) {
+    : cursor(cursor),
+      strategy(selectStrategy(cursor)),
+      target_scanner_symbol(),
+      candidate_heap(k),
+      score_lower_bounds(k) {}
+
+std::unique_ptr<Completion> Completion::Compute(const ScriptCursor& cursor, size_t k, CompletionCache* cache,
+                                                bool prune_index_matches, bool parallel_index_search) {
     using RelativePosition = dashql::buffers::cursor::RelativeSymbolPosition;
 
     auto completion = std::make_unique<Completion>(cursor, k);
+    completion->cache = cache;
+    completion->index_match_pruning_enabled = prune_index_matches;
+    completion->parallel_index_search = parallel_index_search;
 
     // Cannot complete without scanner location
     if (!cursor.scanner_location.has_value()) {
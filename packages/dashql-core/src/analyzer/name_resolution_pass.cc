@@ -41,10 +41,8 @@ void NameResolutionPass::NodeState::Clear() {
 
 ReferencedTable::ColumnResolution ReferencedTable::ResolveColumn(std::string_view column_name) const {
     if (auto* table_ref = std::get_if<std::reference_wrapper<const CatalogEntry::TableDeclaration>>(&source)) {
-        auto& table = table_ref->get();
-        auto it = table.table_columns_by_name.find(column_name);
-        if (it != table.table_columns_by_name.end()) {
-            return std::cref(it->second.get());
+        if (auto* column = table_ref->get().FindColumn(column_name)) {
+            return std::cref(*column);
         }
         return {};
     }
@@ -88,7 +86,7 @@ QualifiedCatalogObjectID NameResolutionPass::RegisterSchema(RegisteredName& data
     auto db_ref_iter = state.analyzed->databases_by_name.find({database_name});
     QualifiedCatalogObjectID db_id = QualifiedCatalogObjectID::Deferred();
     if (db_ref_iter == state.analyzed->databases_by_name.end()) {
-        db_id = state.catalog.AllocateDatabaseId(database_name);
+        db_id = state.catalog_snapshot->AllocateDatabaseId(database_name);
         auto& db =
             state.analyzed->database_references.PushBack(CatalogEntry::DatabaseReference{db_id, database_name, ""});
         state.analyzed->databases_by_name.insert({{database_name}, db});
@@ -101,7 +99,7 @@ QualifiedCatalogObjectID NameResolutionPass::RegisterSchema(RegisteredName& data
     QualifiedCatalogObjectID schema_id = QualifiedCatalogObjectID::Deferred();
     auto schema_ref_iter = state.analyzed->schemas_by_qualified_name.find({database_name, schema_name});
     if (schema_ref_iter == state.analyzed->schemas_by_qualified_name.end()) {
-        schema_id = state.catalog.AllocateSchemaId(database_name, schema_name, db_id);
+        schema_id = state.catalog_snapshot->AllocateSchemaId(database_name, schema_name, db_id);
         auto& schema = state.analyzed->schema_references.PushBack(
             CatalogEntry::SchemaReference{schema_id, database_name, schema_name});
         state.analyzed->schemas_by_qualified_name.insert({{database_name, schema_name}, schema});
@@ -124,6 +122,7 @@ void NameResolutionPass::RegisterDerivedTable(const buffers::parser::Node& decla
         state.catalog_entry_id, static_cast<uint32_t>(state.analyzed->table_declarations.GetSize())};
     auto& table = state.analyzed->table_declarations.PushBack(
         AnalyzedScript::TableDeclaration(schema_id, catalog_table_id, table_name.value()));
+    table.catalog_version = state.analyzed->GetCatalogVersion();
     table.ast_node_id = state.GetNodeId(declaration_node);
     table.ast_statement_id = FindStatementId(*table.ast_node_id);
     table.ast_scope_root = state.GetNodeId(select_node);
@@ -163,14 +162,12 @@ void NameResolutionPass::PopulateDerivedTable(PendingDerivedTable& pending, Anal
         }
     }
     auto& table = pending.table.get();
-    table.table_columns.reserve(column_names.size());
+    std::vector<CatalogEntry::TableColumn> table_columns;
+    table_columns.reserve(column_names.size());
     for (size_t column_index = 0; column_index < column_names.size(); ++column_index) {
-        table.table_columns.emplace_back(table.GetTableID(), column_index, std::nullopt, column_names[column_index]);
-        auto& column = table.table_columns.back();
-        column.table = table;
-        column.column_name.get().resolved_objects.PushBack(column);
-        table.table_columns_by_name.emplace(column.column_name.get().text, column);
+        table_columns.emplace_back(table.GetTableID(), column_index, std::nullopt, column_names[column_index]);
     }
+    state.analyzed->table_column_store.AppendTable(table, table_columns);
 }
 
 void NameResolutionPass::MergeChildStates(NodeState& dst,
@@ -277,7 +274,8 @@ void NameResolutionPass::ResolveTableRefsInScope(AnalyzedScript::NameScope& scop
 
         // Then resolve through the catalog
         if (resolved_tables.size() == 0) {
-            state.catalog.ResolveTable(table_name, state.catalog_entry_id, resolved_tables, MAX_TABLE_REF_AMBIGUITY);
+            state.catalog_snapshot->ResolveTable(table_name, state.catalog_entry_id, resolved_tables,
+                                                 MAX_TABLE_REF_AMBIGUITY);
         }
 
         if (resolved_tables.size() > 0) {
@@ -963,20 +961,17 @@ void NameResolutionPass::Visit(std::span<const buffers::parser::Node> morsel) {
                     // Build the table
                     auto& n = state.analyzed->table_declarations.PushBack(
                         AnalyzedScript::TableDeclaration(schema_id, catalog_table_id, table_name.value()));
+                    n.catalog_version = state.analyzed->GetCatalogVersion();
                     n.ast_node_id = node_id;
                     n.ast_statement_id = FindStatementId(node_id);
-                    n.table_columns = std::move(table_columns);
                     // Register the table declaration
                     table_name->table_name.get().resolved_objects.PushBack(n);
-                    // Update the table ref and index of all columns
-                    n.table_columns_by_name.reserve(n.table_columns.size());
-                    for (size_t column_index = 0; column_index != n.table_columns.size(); ++column_index) {
-                        auto& column = n.table_columns[column_index];
-                        column.object_id = QualifiedCatalogObjectID::TableColumn(catalog_table_id, column_index);
-                        column.table = n;
-                        column.column_name.get().resolved_objects.PushBack(column);
-                        n.table_columns_by_name.insert({column.column_name.get().text, column});
+                    // Number the columns, the store links and indexes them
+                    for (size_t column_index = 0; column_index != table_columns.size(); ++column_index) {
+                        table_columns[column_index].object_id =
+                            QualifiedCatalogObjectID::TableColumn(catalog_table_id, column_index);
                     }
+                    state.analyzed->table_column_store.AppendTable(n, table_columns);
                 }
                 break;
             }
@@ -1132,13 +1127,8 @@ void NameResolutionPass::Finish() {
         assign_statment_ids(state.analyzed->function_declarations.GetChunks());
     }
 
-    // Index the table declarations
-    state.analyzed->table_declarations.ForEach([&](size_t ti, auto& table) {
-        for (size_t i = 0; i < table.table_columns.size(); ++i) {
-            auto& column = table.table_columns[i];
-            state.analyzed->table_columns_by_name.insert({column.column_name.get().text, column});
-        }
-    });
+    // Index the columns of all table declarations by name
+    state.analyzed->table_column_store.IndexByName();
 
     // Solve the schema-inference constraints collected during name resolution.
     RunSchemaInference();
@@ -1152,13 +1142,12 @@ void NameResolutionPass::ResolveInsertTargetColumns() {
         auto table_id = relation->resolved_table->catalog_table_id.UnpackTableID();
         const auto* table = table_id.GetOrigin() == state.catalog_entry_id
                                 ? state.analyzed->ResolveTableById(table_id)
-                                : state.catalog.ResolveTable(table_id);
+                                : state.catalog_snapshot->ResolveTable(table_id);
         if (!table) return;
         for (auto& target_column : insert.target_columns) {
-            auto it = table->table_columns_by_name.find(target_column.column_name.get().text);
-            if (it == table->table_columns_by_name.end()) continue;
-            auto& column = it->second.get();
-            target_column.resolved = std::cref(column);
+            auto* column = table->FindColumn(target_column.column_name.get().text);
+            if (!column) continue;
+            target_column.resolved = std::cref(*column);
         }
     });
 }
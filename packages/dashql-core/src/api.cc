@@ -74,8 +74,10 @@ extern "C" void dashql_script_new(FFIResult* result, dashql::Catalog* catalog) {
     if (!catalog) {
         throw Exception(buffers::status::StatusCode::CATALOG_NULL);
     }
-    // Construct the script
+    // Construct the script.
+    // Scripts of the editor are analyzed after every keystroke, recycle the buffers of outdated versions.
     auto script = std::make_unique<Script>(*catalog);
+    script->SetBufferRecycling(true);
     packPtr(result, std::move(script));
 }
 /// Get the catalog entry id
@@ -321,6 +323,15 @@ extern "C" void dashql_catalog_flatten(FFIResult* result, dashql::Catalog* catal
     auto detached = std::make_unique<flatbuffers::DetachedBuffer>(fb.Release());
     packBuffer(result, std::move(detached));
 }
+/// Flatten the catalog entries that changed since a version
+extern "C" void dashql_catalog_flatten_delta(FFIResult* result, dashql::Catalog* catalog, uint32_t since_version) {
+    flatbuffers::FlatBufferBuilder fb;
+    auto delta = catalog->FlattenDelta(fb, since_version);
+    fb.Finish(delta);
+
+    auto detached = std::make_unique<flatbuffers::DetachedBuffer>(fb.Release());
+    packBuffer(result, std::move(detached));
+}
 /// Add a script in the catalog
 extern "C" void dashql_catalog_load_script(dashql::Catalog* catalog, dashql::Script* script, size_t rank) {
     catalog->LoadScript(*script, rank);
@@ -4,7 +4,10 @@
 #include <flatbuffers/flatbuffer_builder.h>
 #include <flatbuffers/verifier.h>
 
+#include <algorithm>
+#include <array>
 #include <map>
+#include <unordered_set>
 #include <variant>
 
 #include "dashql/buffers/index_generated.h"
@@ -61,6 +64,93 @@ flatbuffers::Offset<buffers::analyzer::Table> CatalogEntry::TableDeclaration::Pa
     return out.Finish();
 }
 
+const CatalogEntry::TableColumn* CatalogEntry::TableDeclaration::FindColumn(std::string_view column_name) const {
+    if (!column_store) {
+        return nullptr;
+    }
+    auto column_index = column_store->FindColumn(column_store_begin, table_columns.size(), column_name);
+    return column_index.has_value() ? &table_columns[*column_index] : nullptr;
+}
+
+void CatalogEntry::TableColumnStore::AppendTable(TableDeclaration& table, std::span<TableColumn> table_columns) {
+    auto begin = static_cast<uint32_t>(columns.GetSize());
+    auto stored = columns.PushBackN(table_columns);
+    for (uint32_t i = 0; i < stored.size(); ++i) {
+        auto& column = stored[i];
+        column.table = table;
+        column.column_name.get().resolved_objects.PushBack(column);
+        auto name_id = static_cast<uint32_t>(name_ids.size());
+        column_name_ids.push_back(name_ids.try_emplace(column.column_name.get().text, name_id).first->second);
+        table_column_order.push_back(i);
+    }
+    // Order the range of the table by name id, duplicate names keep the first column
+    std::sort(table_column_order.begin() + begin, table_column_order.end(), [&](uint32_t l, uint32_t r) {
+        return std::make_pair(column_name_ids[begin + l], l) < std::make_pair(column_name_ids[begin + r], r);
+    });
+    table.table_columns = stored;
+    table.column_store = this;
+    table.column_store_begin = begin;
+}
+
+void CatalogEntry::TableColumnStore::IndexByName() {
+    auto begin = columns_by_name.size();
+    columns_by_name.resize(column_name_ids.size());
+    for (uint32_t i = begin; i < columns_by_name.size(); ++i) {
+        columns_by_name[i] = i;
+    }
+    auto less = [&](uint32_t l, uint32_t r) {
+        return std::make_pair(column_name_ids[l], l) < std::make_pair(column_name_ids[r], r);
+    };
+    // Columns are appended in batches, only sort the new ones and merge them
+    std::sort(columns_by_name.begin() + begin, columns_by_name.end(), less);
+    std::inplace_merge(columns_by_name.begin(), columns_by_name.begin() + begin, columns_by_name.end(), less);
+}
+
+std::optional<uint32_t> CatalogEntry::TableColumnStore::FindColumn(uint32_t begin, uint32_t count,
+                                                                   std::string_view name) const {
+    auto name_iter = name_ids.find(name);
+    if (name_iter == name_ids.end()) {
+        return std::nullopt;
+    }
+    auto name_id = name_iter->second;
+    auto range_begin = table_column_order.begin() + begin;
+    auto range_end = range_begin + count;
+    auto iter = std::lower_bound(range_begin, range_end, name_id,
+                                 [&](uint32_t column, uint32_t id) { return column_name_ids[begin + column] < id; });
+    if (iter == range_end || column_name_ids[begin + *iter] != name_id) {
+        return std::nullopt;
+    }
+    return *iter;
+}
+
+std::span<const uint32_t> CatalogEntry::TableColumnStore::FindColumns(std::string_view name) const {
+    auto name_iter = name_ids.find(name);
+    if (name_iter == name_ids.end()) {
+        return {};
+    }
+    auto name_id = name_iter->second;
+    auto lb = std::lower_bound(columns_by_name.begin(), columns_by_name.end(), name_id,
+                               [&](uint32_t position, uint32_t id) { return column_name_ids[position] < id; });
+    auto ub = std::upper_bound(lb, columns_by_name.end(), name_id,
+                               [&](uint32_t id, uint32_t position) { return id < column_name_ids[position]; });
+    return {lb, ub};
+}
+
+size_t CatalogEntry::TableColumnStore::GetColumnByteSize() const {
+    size_t bytes = 0;
+    for (auto& chunk : columns.GetChunks()) {
+        bytes += chunk.capacity() * sizeof(TableColumn);
+    }
+    return bytes;
+}
+
+size_t CatalogEntry::TableColumnStore::GetIndexByteSize() const {
+    return name_ids.values().capacity() * sizeof(std::pair<std::string_view, uint32_t>) +
+           name_ids.bucket_count() * sizeof(ankerl::unordered_dense::bucket_type::standard) +
+           column_name_ids.capacity() * sizeof(uint32_t) + table_column_order.capacity() * sizeof(uint32_t) +
+           columns_by_name.capacity() * sizeof(uint32_t);
+}
+
 CatalogEntry::CatalogEntry(Catalog& catalog, CatalogEntryID external_id)
     : catalog(catalog),
       catalog_version(catalog.version),
@@ -72,7 +162,7 @@ CatalogEntry::CatalogEntry(Catalog& catalog, CatalogEntryID external_id)
       schemas_by_qualified_name(),
       tables_by_qualified_name(),
       tables_by_unqualified_name(),
-      table_columns_by_name(),
+      table_column_store(),
       name_search_index() {}
 
 void CatalogEntry::ResolveDatabaseSchemasWithCatalog(
@@ -129,11 +219,7 @@ void CatalogEntry::ResolveSchemaTablesWithCatalog(
             }
             // Do the same lookup in the other entries
             auto& other_entry = *catalog.entries.at(iter->second.catalog_entry_id);
-            auto table_lb = other_entry.tables_by_unqualified_schema.lower_bound({schema_name, TEXT_LB});
-            auto table_ub = other_entry.tables_by_unqualified_schema.upper_bound({schema_name, TEXT_UB});
-            for (auto table_iter = table_lb; table_iter != table_ub; ++table_iter) {
-                out.push_back({table_iter->second, true});
-            }
+            other_entry.CollectTablesInSchema({schema_name, TEXT_LB}, {schema_name, TEXT_UB}, out, true);
         }
     }
 }
@@ -165,15 +251,28 @@ void CatalogEntry::ResolveSchemaTablesWithCatalog(
             }
             // Do the same lookup in the other entries
             auto& other_entry = *catalog.entries.at(iter->second.catalog_entry_id);
-            auto table_lb = other_entry.tables_by_unqualified_schema.lower_bound({schema_name, database_name});
-            auto table_ub = other_entry.tables_by_unqualified_schema.upper_bound({schema_name, database_name});
-            for (auto table_iter = table_lb; table_iter != table_ub; ++table_iter) {
-                out.push_back({table_iter->second, true});
-            }
+            other_entry.CollectTablesInSchema({schema_name, database_name}, {schema_name, database_name}, out, true);
         }
     }
 }
 
+void CatalogEntry::CollectTablesInSchema(
+    std::pair<std::string_view, std::string_view> lb, std::pair<std::string_view, std::string_view> ub,
+    std::vector<std::pair<std::reference_wrapper<const CatalogEntry::TableDeclaration>, bool>>& out,
+    bool through_catalog) const {
+    auto table_lb = tables_by_unqualified_schema.lower_bound(lb);
+    auto table_ub = tables_by_unqualified_schema.upper_bound(ub);
+    for (auto table_iter = table_lb; table_iter != table_ub; ++table_iter) {
+        out.push_back({table_iter->second, through_catalog});
+    }
+}
+
+const CatalogEntry::TableDeclaration* CatalogEntry::FindQualifiedTable(
+    const QualifiedTableName::Key& table_name) const {
+    auto iter = tables_by_qualified_name.find(table_name);
+    return iter != tables_by_qualified_name.end() ? &iter->second.get() : nullptr;
+}
+
 const CatalogEntry::TableDeclaration* CatalogEntry::ResolveTableById(CatalogTableID table_id) const {
     if (table_id.GetOrigin() == catalog_entry_id) {
         return &table_declarations[table_id.GetObject()];
@@ -184,9 +283,8 @@ const CatalogEntry::TableDeclaration* CatalogEntry::ResolveTableById(CatalogTabl
 void CatalogEntry::ResolveTable(QualifiedTableName table_name,
                                 std::vector<std::reference_wrapper<const TableDeclaration>>& out, size_t limit) const {
     // Probe the qualified names map directly
-    auto iter = tables_by_qualified_name.find(table_name);
-    if (iter != tables_by_qualified_name.end()) {
-        out.push_back(iter->second);
+    if (auto* table = FindQualifiedTable(table_name)) {
+        out.push_back(*table);
         return;
     }
 
@@ -216,7 +314,8 @@ void CatalogEntry::ResolveTableInSchema(std::string_view schema_name, std::strin
 void CatalogEntry::ResolveTableEverywhere(std::string_view table_name,
                                           std::vector<std::reference_wrapper<const TableDeclaration>>& out,
                                           size_t limit) const {
-    for (auto iter = tables_by_unqualified_name.find(table_name); iter != tables_by_unqualified_name.end(); ++iter) {
+    auto [begin, end] = tables_by_unqualified_name.equal_range(table_name);
+    for (auto iter = begin; iter != end; ++iter) {
         out.push_back(iter->second.get());
         if (out.size() >= limit) {
             return;
@@ -225,9 +324,9 @@ void CatalogEntry::ResolveTableEverywhere(std::string_view table_name,
 }
 
 void CatalogEntry::ResolveTableColumns(std::string_view table_column, std::vector<TableColumn>& out) const {
-    auto [begin, end] = table_columns_by_name.equal_range(table_column);
-    for (auto iter = begin; iter != end; ++iter) {
-        out.push_back(iter->second.get());
+    auto& store = table_column_store;
+    for (auto position : store.FindColumns(table_column)) {
+        out.push_back(store.GetColumn(position));
     }
 }
 
@@ -240,6 +339,324 @@ void CatalogEntry::ResolveTableColumnsWithCatalog(std::string_view table_column,
     ResolveTableColumns(table_column, tmp);
 }
 
+/// Read an optional descriptor string
+static std::string_view ReadDescriptorString(const flatbuffers::String* text) {
+    return text ? std::string_view{text->c_str(), text->size()} : std::string_view{};
+}
+
+DescriptorPool::Segment::Segment(Catalog& catalog, CatalogEntryID external_id, uint32_t first_table_id)
+    : CatalogEntry(catalog, external_id), first_table_id(first_table_id) {}
+
+const CatalogEntry::SchemaReference& DescriptorPool::Segment::AddSchemaDescriptor(
+    const buffers::catalog::SchemaDescriptor& descriptor, QualifiedCatalogObjectID database_id,
+    QualifiedCatalogObjectID schema_id) {
+    auto& database_name = name_registry.Register(ReadDescriptorString(descriptor.database_name()),
+                                                 buffers::analyzer::NameTag::DATABASE_NAME);
+    auto& schema_name = name_registry.Register(ReadDescriptorString(descriptor.schema_name()),
+                                               buffers::analyzer::NameTag::SCHEMA_NAME);
+
+    // Register the database
+    if (!databases_by_name.contains(database_name.text)) {
+        auto& db = database_references.PushBack(DatabaseReference{database_id, database_name.text, ""});
+        databases_by_name.insert({database_name.text, db});
+        database_name.resolved_objects.PushBack(db.CastToBase());
+    }
+    // Register the schema
+    const SchemaReference* schema_ref = nullptr;
+    if (auto iter = schemas_by_qualified_name.find({database_name.text, schema_name.text});
+        iter != schemas_by_qualified_name.end()) {
+        schema_ref = &iter->second.get();
+    } else {
+        auto& schema = schema_references.PushBack(SchemaReference{schema_id, database_name.text, schema_name.text});
+        schemas_by_qualified_name.insert({{database_name.text, schema_name.text}, schema});
+        schema_name.resolved_objects.PushBack(schema.CastToBase());
+        schema_ref = &schema;
+    }
+
+    // Build the table declarations
+    for (auto* table : *descriptor.tables()) {
+        auto& table_name =
+            name_registry.Register(ReadDescriptorString(table->table_name()), buffers::analyzer::NameTag::TABLE_NAME);
+        ExternalObjectID table_id{catalog_entry_id,
+                                  first_table_id + static_cast<uint32_t>(table_declarations.GetSize())};
+        QualifiedTableName qualified_name{std::nullopt, database_name, schema_name, table_name};
+        auto& decl = table_declarations.PushBack(TableDeclaration(schema_id, table_id, qualified_name));
+        decl.catalog_version = catalog_version;
+
+        // Build the columns, the store links them once they reached their final place
+        std::vector<TableColumn> columns;
+        if (auto* table_columns = table->columns()) {
+            columns.reserve(table_columns->size());
+            for (auto* column : *table_columns) {
+                auto& column_name = name_registry.Register(ReadDescriptorString(column->column_name()),
+                                                           buffers::analyzer::NameTag::COLUMN_NAME);
+                columns.emplace_back(table_id, static_cast<uint32_t>(columns.size()), std::nullopt, column_name);
+            }
+        }
+        table_column_store.AppendTable(decl, columns);
+
+        // Index the table
+        table_name.resolved_objects.PushBack(decl);
+        tables_by_qualified_name.insert({decl.table_name, decl});
+        tables_by_unqualified_name.insert({table_name.text, decl});
+        if (!schema_name.text.empty()) {
+            tables_by_unqualified_schema.insert({{schema_name.text, database_name.text}, decl});
+        }
+    }
+    descriptors.push_back(descriptor);
+
+    // The registry only grows, keep the current index around to derive the next one from it
+    if (name_search_index.has_value()) {
+        previous_name_search_index = std::move(name_search_index);
+        name_search_index.reset();
+    }
+    return *schema_ref;
+}
+
+std::shared_ptr<DescriptorPool::Segment> DescriptorPool::Segment::Merge(
+    std::span<const std::shared_ptr<Segment>> segments) {
+    assert(!segments.empty());
+    auto& first = *segments.front();
+    auto merged = std::make_shared<Segment>(first.catalog, first.catalog_entry_id, first.first_table_id);
+    merged->catalog_version = segments.back()->catalog_version;
+    for (auto& segment : segments) {
+        // Replay the descriptors with the same object ids
+        for (auto& descriptor_ref : segment->descriptors) {
+            auto& descriptor = descriptor_ref.get();
+            auto database_name = ReadDescriptorString(descriptor.database_name());
+            auto schema_name = ReadDescriptorString(descriptor.schema_name());
+            auto database_id = segment->databases_by_name.at(database_name).get().object_id;
+            auto schema_id = segment->schemas_by_qualified_name.at({database_name, schema_name}).get().object_id;
+            merged->AddSchemaDescriptor(descriptor, database_id, schema_id);
+        }
+        // The tables keep the catalog version in which they were added
+        auto offset = segment->first_table_id - first.first_table_id;
+        segment->table_declarations.ForEach([&](size_t i, const TableDeclaration& table) {
+            merged->table_declarations[offset + i].catalog_version = table.catalog_version;
+        });
+        merged->descriptor_buffers.insert(merged->descriptor_buffers.end(), segment->descriptor_buffers.begin(),
+                                          segment->descriptor_buffers.end());
+    }
+    merged->table_column_store.IndexByName();
+    return merged;
+}
+
+/// Describe schema descriptors, the tables are numbered in descriptor order
+static void DescribeSchemaDescriptors(
+    flatbuffers::FlatBufferBuilder& builder,
+    std::span<const std::reference_wrapper<const buffers::catalog::SchemaDescriptor>> descriptors, uint32_t& table_id,
+    std::vector<flatbuffers::Offset<buffers::catalog::SchemaDescriptor>>& schema_offsets) {
+    for (auto& descriptor_ref : descriptors) {
+        auto& descriptor = descriptor_ref.get();
+        auto database_name = builder.CreateString(ReadDescriptorString(descriptor.database_name()));
+        auto schema_name = builder.CreateString(ReadDescriptorString(descriptor.schema_name()));
+
+        // Tables were declared in descriptor order
+        std::vector<flatbuffers::Offset<buffers::catalog::SchemaTable>> table_offsets;
+        table_offsets.reserve(descriptor.tables()->size());
+        for (auto* table : *descriptor.tables()) {
+            auto table_name = builder.CreateString(ReadDescriptorString(table->table_name()));
+            std::vector<flatbuffers::Offset<buffers::catalog::SchemaTableColumn>> column_offsets;
+            if (auto* columns = table->columns()) {
+                column_offsets.reserve(columns->size());
+                for (auto* column : *columns) {
+                    auto column_name = builder.CreateString(ReadDescriptorString(column->column_name()));
+                    buffers::catalog::SchemaTableColumnBuilder column_builder{builder};
+                    column_builder.add_column_name(column_name);
+                    column_builder.add_ordinal_position(column->ordinal_position());
+                    column_offsets.push_back(column_builder.Finish());
+                }
+            }
+            auto columns_offset = builder.CreateVector(column_offsets);
+
+            buffers::catalog::SchemaTableBuilder table_builder{builder};
+            table_builder.add_table_id(table_id++);
+            table_builder.add_table_name(table_name);
+            table_builder.add_columns(columns_offset);
+            table_offsets.push_back(table_builder.Finish());
+        }
+        auto tables_offset = builder.CreateVector(table_offsets);
+
+        buffers::catalog::SchemaDescriptorBuilder schema_builder{builder};
+        schema_builder.add_database_name(database_name);
+        schema_builder.add_schema_name(schema_name);
+        schema_builder.add_tables(tables_offset);
+        schema_offsets.push_back(schema_builder.Finish());
+    }
+}
+
+/// Describe a descriptor pool entry
+static flatbuffers::Offset<buffers::catalog::CatalogEntry> DescribeDescriptorPool(
+    flatbuffers::FlatBufferBuilder& builder, CatalogEntryID catalog_entry_id, CatalogEntry::Rank rank,
+    std::vector<flatbuffers::Offset<buffers::catalog::SchemaDescriptor>>& schema_offsets) {
+    auto schemas_offset = builder.CreateVector(schema_offsets);
+
+    buffers::catalog::CatalogEntryBuilder catalog{builder};
+    catalog.add_catalog_entry_id(catalog_entry_id);
+    catalog.add_catalog_entry_type(buffers::catalog::CatalogEntryType::DESCRIPTOR_POOL);
+    catalog.add_rank(rank);
+    catalog.add_schemas(schemas_offset);
+    return catalog.Finish();
+}
+
+flatbuffers::Offset<buffers::catalog::CatalogEntry> DescriptorPool::Segment::DescribeEntry(
+    flatbuffers::FlatBufferBuilder& builder) const {
+    std::vector<flatbuffers::Offset<buffers::catalog::SchemaDescriptor>> schema_offsets;
+    schema_offsets.reserve(descriptors.size());
+    uint32_t table_id = first_table_id;
+    DescribeSchemaDescriptors(builder, descriptors, table_id, schema_offsets);
+    return DescribeDescriptorPool(builder, catalog_entry_id, 0, schema_offsets);
+}
+
+const CatalogEntry::NameSearchIndex& DescriptorPool::Segment::GetNameSearchIndex([[maybe_unused]] size_t index) {
+    assert(index == 0);
+    if (!name_search_index.has_value()) {
+        if (previous_name_search_index.has_value()) {
+            name_search_index.emplace(name_registry, *previous_name_search_index);
+            previous_name_search_index.reset();
+        } else {
+            name_search_index.emplace(name_registry);
+        }
+    }
+    return *name_search_index;
+}
+
+const CatalogEntry::TableDeclaration* DescriptorPool::Segment::ResolveTableById(CatalogTableID table_id) const {
+    if (table_id.GetOrigin() != catalog_entry_id || table_id.GetObject() < first_table_id ||
+        table_id.GetObject() - first_table_id >= table_declarations.GetSize()) {
+        return nullptr;
+    }
+    return &table_declarations[table_id.GetObject() - first_table_id];
+}
+
+DescriptorPool::DescriptorPool(Catalog& catalog, CatalogEntryID external_id, CatalogEntry::Rank rank)
+    : CatalogEntry(catalog, external_id), rank(rank) {}
+
+DescriptorPool::Segment& DescriptorPool::GetWritableSegment() {
+    // Segments are only shared with clones that snapshots still read
+    if (segments.empty() || segments.back().use_count() > 1) {
+        uint32_t first_table_id = 0;
+        if (!segments.empty()) {
+            auto& last = *segments.back();
+            first_table_id = last.first_table_id + static_cast<uint32_t>(last.table_declarations.GetSize());
+        }
+        segments.push_back(std::make_shared<Segment>(catalog, catalog_entry_id, first_table_id));
+    }
+    return *segments.back();
+}
+
+std::vector<std::shared_ptr<DescriptorPool::Segment>> DescriptorPool::CompactSegments() {
+    // Find the segments to merge.
+    // Merging pairwise as long as the last segment is at least half as large as the one before yields the same
+    // segments, we just replay every descriptor once.
+    size_t begin = segments.size() - 1;
+    size_t weight = segments.back()->GetWeight();
+    while (begin > 0 && segments[begin - 1]->GetWeight() < 2 * weight) {
+        weight += segments[--begin]->GetWeight();
+    }
+    if ((segments.size() - begin) < 2) {
+        return {};
+    }
+    auto merged = Segment::Merge(std::span{segments}.subspan(begin));
+    std::vector<std::shared_ptr<Segment>> replaced{segments.begin() + begin, segments.end()};
+    segments.resize(begin);
+    segments.push_back(std::move(merged));
+    return replaced;
+}
+
+bool DescriptorPool::ContainsSchema(std::string_view database_name, std::string_view schema_name) const {
+    for (auto& segment : segments) {
+        if (segment->schemas_by_qualified_name.contains({database_name, schema_name})) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::shared_ptr<DescriptorPool> DescriptorPool::Clone() const {
+    auto clone = std::make_shared<DescriptorPool>(catalog, catalog_entry_id, rank);
+    clone->catalog_version = catalog_version;
+    clone->segments = segments;
+    return clone;
+}
+
+flatbuffers::Offset<buffers::catalog::CatalogEntry> DescriptorPool::DescribeEntry(
+    flatbuffers::FlatBufferBuilder& builder) const {
+    std::vector<flatbuffers::Offset<buffers::catalog::SchemaDescriptor>> schema_offsets;
+    uint32_t table_id = 0;
+    for (auto& segment : segments) {
+        DescribeSchemaDescriptors(builder, segment->descriptors, table_id, schema_offsets);
+    }
+    return DescribeDescriptorPool(builder, catalog_entry_id, rank, schema_offsets);
+}
+
+const CatalogEntry::NameSearchIndex& DescriptorPool::GetNameSearchIndex(size_t index) {
+    return segments[index]->GetNameSearchIndex();
+}
+
+void DescriptorPool::CollectSegments(std::vector<const CatalogEntry*>& out) const {
+    for (auto& segment : segments) {
+        out.push_back(segment.get());
+    }
+}
+
+void DescriptorPool::CollectTablesInSchema(
+    std::pair<std::string_view, std::string_view> lb, std::pair<std::string_view, std::string_view> ub,
+    std::vector<std::pair<std::reference_wrapper<const CatalogEntry::TableDeclaration>, bool>>& out,
+    bool through_catalog) const {
+    for (auto& segment : segments) {
+        segment->CollectTablesInSchema(lb, ub, out, through_catalog);
+    }
+}
+
+const CatalogEntry::TableDeclaration* DescriptorPool::FindQualifiedTable(
+    const QualifiedTableName::Key& table_name) const {
+    for (auto& segment : segments) {
+        if (auto* table = segment->FindQualifiedTable(table_name)) {
+            return table;
+        }
+    }
+    return nullptr;
+}
+
+const CatalogEntry::TableDeclaration* DescriptorPool::ResolveTableById(CatalogTableID table_id) const {
+    // Find the last segment that starts at or before the table
+    auto iter = std::upper_bound(segments.begin(), segments.end(), table_id.GetObject(),
+                                 [](uint32_t id, auto& segment) { return id < segment->first_table_id; });
+    if (iter == segments.begin()) {
+        return nullptr;
+    }
+    return (*std::prev(iter))->ResolveTableById(table_id);
+}
+
+void DescriptorPool::ResolveTableInSchema(std::string_view schema_name, std::string_view table_name,
+                                          std::vector<std::reference_wrapper<const TableDeclaration>>& out,
+                                          size_t limit) const {
+    for (auto& segment : segments) {
+        segment->ResolveTableInSchema(schema_name, table_name, out, limit);
+        if (out.size() >= limit) {
+            return;
+        }
+    }
+}
+
+void DescriptorPool::ResolveTableEverywhere(std::string_view table_name,
+                                            std::vector<std::reference_wrapper<const TableDeclaration>>& out,
+                                            size_t limit) const {
+    for (auto& segment : segments) {
+        segment->ResolveTableEverywhere(table_name, out, limit);
+        if (out.size() >= limit) {
+            return;
+        }
+    }
+}
+
+void DescriptorPool::ResolveTableColumns(std::string_view table_column, std::vector<TableColumn>& out) const {
+    for (auto& segment : segments) {
+        segment->ResolveTableColumns(table_column, out);
+    }
+}
+
 Catalog::Catalog() {}
 
 CatalogEntryID Catalog::AllocateEntryId() {
@@ -250,12 +667,48 @@ CatalogEntryID Catalog::AllocateEntryId() {
 }
 
 void Catalog::Clear() {
+    std::lock_guard<std::mutex> lock{mutex};
     entries_by_qualified_schema.clear();
     entries_by_schema.clear();
+    tables_by_unqualified_name.clear();
     entries_ranked.clear();
     entries.clear();
+    shared_entries.clear();
     script_entries.clear();
+    descriptor_pool_entries.clear();
+    entry_versions.clear();
+    dropped_entries.clear();
+    flat_fragments.clear();
     ++version;
+    InvalidateSnapshot();
+    delta_base_version = version;
+}
+
+void Catalog::InvalidateSnapshot() {
+    if (snapshot && snapshot->GetMemoizedResolutionCount() > 0) {
+        ++table_resolution_statistics.invalidations;
+    }
+    snapshot.reset();
+}
+
+void Catalog::MarkEntryModified(CatalogEntryID entry_id) { entry_versions.insert_or_assign(entry_id, version); }
+
+void Catalog::MarkEntryDropped(CatalogEntryID entry_id) {
+    entry_versions.erase(entry_id);
+    flat_fragments.erase(entry_id);
+    dropped_entries.push_back({version, entry_id});
+    if (dropped_entries.size() > MAX_DROPPED_ENTRIES) {
+        delta_base_version = dropped_entries.front().first;
+        dropped_entries.pop_front();
+    }
+}
+
+std::shared_ptr<const CatalogSnapshot> Catalog::GetSnapshot() const {
+    std::lock_guard<std::mutex> lock{mutex};
+    if (!snapshot) {
+        snapshot = std::make_shared<CatalogSnapshot>(*this);
+    }
+    return snapshot;
 }
 
 flatbuffers::Offset<buffers::catalog::CatalogEntries> Catalog::DescribeEntries(
@@ -290,6 +743,18 @@ flatbuffers::Offset<buffers::catalog::CatalogEntries> Catalog::DescribeEntriesOf
 
 /// Flatten the catalog
 flatbuffers::Offset<buffers::catalog::FlatCatalog> Catalog::Flatten(flatbuffers::FlatBufferBuilder& builder) const {
+    std::vector<const CatalogEntry*> ranked_entries;
+    ranked_entries.reserve(entries_ranked.size());
+    for (auto& [rank, catalog_entry_id] : entries_ranked) {
+        ranked_entries.push_back(entries.at(catalog_entry_id));
+    }
+    return FlattenEntries(builder, version, ranked_entries);
+}
+
+/// Flatten catalog entries
+flatbuffers::Offset<buffers::catalog::FlatCatalog> Catalog::FlattenEntries(
+    flatbuffers::FlatBufferBuilder& builder, CatalogVersion catalog_version,
+    std::span<const CatalogEntry* const> ranked_entries) {
     // We build a name dictionary so that JS can save unnecessary utf8->utf16 conversions.
     // The JS renderers are virtualized which means that they only need to convert catalog entry names that are visible.
     std::unordered_map<std::string_view, size_t> name_dictionary_index;
@@ -355,7 +820,14 @@ flatbuffers::Offset<buffers::catalog::FlatCatalog> Catalog::Flatten(flatbuffers:
     std::unordered_map<QualifiedCatalogObjectID, DatabaseNode*> database_node_map;
     std::unordered_map<QualifiedCatalogObjectID, SchemaNode*> schema_node_map;
 
-    for (auto& [catalog_entry_id, catalog_entry] : entries) {
+    // Descriptor pools hold their declarations in segments
+    std::vector<const CatalogEntry*> ranked_segments;
+    ranked_segments.reserve(ranked_entries.size());
+    for (auto* catalog_entry : ranked_entries) {
+        catalog_entry->CollectSegments(ranked_segments);
+    }
+
+    for (auto* catalog_entry : ranked_segments) {
         /// Register all databases
         for (auto& [db_key, db_ref_raw] : catalog_entry->databases_by_name) {
             auto& db_ref = db_ref_raw.get();
@@ -394,8 +866,7 @@ flatbuffers::Offset<buffers::catalog::FlatCatalog> Catalog::Flatten(flatbuffers:
 
     // Translate all table declarations.
     // Iterate over entries in ranked order since there might be duplicate table declarations.
-    for (auto& [rank, catalog_entry_id] : entries_ranked) {
-        auto& catalog_entry = entries.at(catalog_entry_id);
+    for (auto* catalog_entry : ranked_segments) {
         for (auto& chunk : catalog_entry->table_declarations.GetChunks()) {
             for (auto& entry : chunk) {
                 // Resolve the schema node
@@ -535,7 +1006,7 @@ flatbuffers::Offset<buffers::catalog::FlatCatalog> Catalog::Flatten(flatbuffers:
 
     // Build the flat catalog
     buffers::catalog::FlatCatalogBuilder catalogBuilder{builder};
-    catalogBuilder.add_catalog_version(version);
+    catalogBuilder.add_catalog_version(catalog_version);
     catalogBuilder.add_name_dictionary(dictionary);
     catalogBuilder.add_databases(databases_ofs);
     catalogBuilder.add_schemas(schemas_ofs);
@@ -547,6 +1018,67 @@ flatbuffers::Offset<buffers::catalog::FlatCatalog> Catalog::Flatten(flatbuffers:
     return catalogBuilder.Finish();
 }
 
+/// Flatten the entries that changed since a catalog version
+flatbuffers::Offset<buffers::catalog::FlatCatalogDelta> Catalog::FlattenDelta(flatbuffers::FlatBufferBuilder& builder,
+                                                                              CatalogVersion since_version) const {
+    std::lock_guard<std::mutex> lock{mutex};
+
+    // Did we forget dropped entries since then, or is the version from the future?
+    // The latter happens when the client outlived a catalog that was recreated.
+    // The client has to replace its entire catalog with the updated entries then.
+    bool reset = since_version < delta_base_version || since_version > version;
+
+    // Collect the dropped entries
+    std::vector<uint32_t> dropped;
+    if (!reset) {
+        auto iter = std::upper_bound(dropped_entries.begin(), dropped_entries.end(), since_version,
+                                     [](CatalogVersion v, auto& entry) { return v < entry.first; });
+        for (; iter != dropped_entries.end(); ++iter) {
+            dropped.push_back(iter->second);
+        }
+    }
+    auto dropped_ofs = builder.CreateVector(dropped);
+
+    // Collect the updated entries in ranked order
+    std::vector<flatbuffers::Offset<buffers::catalog::FlatCatalogFragment>> updated;
+    for (auto& [rank, catalog_entry_id] : entries_ranked) {
+        auto entry_version = entry_versions.at(catalog_entry_id);
+        if (!reset && entry_version <= since_version) {
+            continue;
+        }
+        // Flatten the entry if it was modified since the last time
+        auto fragment_iter = flat_fragments.find(catalog_entry_id);
+        if (fragment_iter == flat_fragments.end() || fragment_iter->second.catalog_version != entry_version) {
+            flatbuffers::FlatBufferBuilder fragment_builder;
+            std::array<const CatalogEntry*, 1> fragment_entries{entries.at(catalog_entry_id)};
+            fragment_builder.Finish(FlattenEntries(fragment_builder, entry_version, fragment_entries));
+            FlatEntryFragment fragment{.catalog_version = entry_version, .buffer = fragment_builder.Release()};
+            fragment_iter = flat_fragments.insert_or_assign(catalog_entry_id, std::move(fragment)).first;
+        }
+        // Nested flatbuffers must be aligned to their largest scalar
+        auto& buffer = fragment_iter->second.buffer;
+        builder.ForceVectorAlignment(buffer.size(), sizeof(uint8_t), sizeof(flatbuffers::largest_scalar_t));
+        auto buffer_ofs = builder.CreateVector(buffer.data(), buffer.size());
+        updated.push_back(buffers::catalog::CreateFlatCatalogFragment(builder, catalog_entry_id, entry_version, rank,
+                                                                      buffer_ofs));
+    }
+    auto updated_ofs = builder.CreateVector(updated);
+
+    buffers::catalog::FlatCatalogDeltaBuilder deltaBuilder{builder};
+    deltaBuilder.add_catalog_version(version);
+    deltaBuilder.add_since_version(since_version);
+    deltaBuilder.add_reset(reset);
+    deltaBuilder.add_dropped_entries(dropped_ofs);
+    deltaBuilder.add_updated_entries(updated_ofs);
+    return deltaBuilder.Finish();
+}
+
+const Catalog::FlatEntryFragment* Catalog::GetFlatFragment(CatalogEntryID id) const {
+    std::lock_guard<std::mutex> lock{mutex};
+    auto iter = flat_fragments.find(id);
+    return iter != flat_fragments.end() ? &iter->second : nullptr;
+}
+
 void Catalog::LoadScript(Script& script, CatalogEntry::Rank rank) {
     if (!script.analyzed_script) {
         throw Exception(buffers::status::StatusCode::CATALOG_SCRIPT_NOT_ANALYZED);
@@ -554,6 +1086,7 @@ void Catalog::LoadScript(Script& script, CatalogEntry::Rank rank) {
     if (&script.catalog != this) {
         throw Exception(buffers::status::StatusCode::CATALOG_MISMATCH);
     }
+    std::lock_guard<std::mutex> lock{mutex};
 
     // Script has been added to catalog before?
     auto script_iter = script_entries.find(&script);
@@ -594,7 +1127,7 @@ void Catalog::LoadScript(Script& script, CatalogEntry::Rank rank) {
                     throw Exception(buffers::status::StatusCode::CATALOG_ID_OUT_OF_SYNC);
                 }
             } else {
-                auto db = std::make_unique<DatabaseDeclaration>(ref.get().object_id, ref.get().database_name,
+                auto db = std::make_shared<DatabaseDeclaration>(ref.get().object_id, ref.get().database_name,
                                                                 ref.get().database_alias);
                 std::string_view db_key{db->database_name};
                 databases.insert({db_key, std::move(db)});
@@ -610,7 +1143,7 @@ void Catalog::LoadScript(Script& script, CatalogEntry::Rank rank) {
                 }
             } else {
                 // Copy strings and register the schema
-                auto schema = std::make_unique<SchemaDeclaration>(ref.get().object_id, ref.get().database_name,
+                auto schema = std::make_shared<SchemaDeclaration>(ref.get().object_id, ref.get().database_name,
                                                                   ref.get().schema_name);
                 schemas.insert(
                     {std::pair<std::string_view, std::string_view>{schema->database_name, schema->schema_name},
@@ -638,9 +1171,14 @@ void Catalog::LoadScript(Script& script, CatalogEntry::Rank rank) {
     script_entries.insert({&script, {.script = script, .analyzed = script.analyzed_script, .rank = rank}});
     // Register as catalog entry
     entries.insert({entry.GetCatalogEntryId(), &entry});
+    shared_entries.try_emplace(entry.GetCatalogEntryId(), script.analyzed_script);
     // Register rank
     entries_ranked.insert({rank, entry.GetCatalogEntryId()});
+    // Register tables
+    IndexUnqualifiedTableNames(entry, rank);
     ++version;
+    InvalidateSnapshot();
+    MarkEntryModified(entry.GetCatalogEntryId());
 }
 
 buffers::status::StatusCode Catalog::UpdateScript(ScriptEntry& entry) {
@@ -682,7 +1220,7 @@ buffers::status::StatusCode Catalog::UpdateScript(ScriptEntry& entry) {
     // Insert unmarked new database entries
     for (auto& [k, new_entry] : new_dbs) {
         if (!new_entry.already_exists) {
-            auto db = std::make_unique<DatabaseDeclaration>(new_entry.database_ref.object_id, k, "");
+            auto db = std::make_shared<DatabaseDeclaration>(new_entry.database_ref.object_id, k, "");
             databases.insert({db->database_name, std::move(db)});
         }
     }
@@ -741,7 +1279,7 @@ buffers::status::StatusCode Catalog::UpdateScript(ScriptEntry& entry) {
             // Add schema declaration
             if (!schemas.contains({db_name, schema_name})) {
                 assert(databases.contains(db_name));
-                auto schema = std::make_unique<SchemaDeclaration>(new_entry.schema_ref.object_id,
+                auto schema = std::make_shared<SchemaDeclaration>(new_entry.schema_ref.object_id,
                                                                   databases.find(db_name)->first, schema_name);
                 schemas.insert(
                     {std::pair<std::string_view, std::string_view>{schema->database_name, schema->schema_name},
@@ -766,15 +1304,23 @@ buffers::status::StatusCode Catalog::UpdateScript(ScriptEntry& entry) {
         }
     }
 
+    // Re-index the tables
+    DropUnqualifiedTableNames(*entry.analyzed);
+    IndexUnqualifiedTableNames(*script.analyzed_script, rank);
+
     entry.analyzed = script.analyzed_script;
     auto entry_iter = entries.find(script.GetCatalogEntryId());
     assert(entry_iter != entries.end());
     entry_iter->second = entry.analyzed.get();
+    shared_entries.insert_or_assign(external_id, entry.analyzed);
     ++version;
+    InvalidateSnapshot();
+    MarkEntryModified(external_id);
     return buffers::status::StatusCode::OK;
 }
 
 void Catalog::DropScript(Script& script) {
+    std::lock_guard<std::mutex> lock{mutex};
     auto iter = script_entries.find(&script);
     if (iter != script_entries.end()) {
         auto external_id = script.GetCatalogEntryId();
@@ -785,11 +1331,234 @@ void Catalog::DropScript(Script& script) {
                 entries_by_qualified_schema.erase({db_name, schema_name, iter->second.rank, external_id});
                 entries_by_schema.erase({schema_name, iter->second.rank, external_id});
             }
+            DropUnqualifiedTableNames(*analyzed);
         }
         entries_ranked.erase({iter->second.rank, external_id});
         entries.erase(external_id);
+        shared_entries.erase(external_id);
         script_entries.erase(iter);
         ++version;
+        InvalidateSnapshot();
+        MarkEntryDropped(external_id);
+    }
+}
+
+void Catalog::AddDescriptorPool(CatalogEntryID external_id, CatalogEntry::Rank rank) {
+    std::lock_guard<std::mutex> lock{mutex};
+    if (entries.contains(external_id)) {
+        throw Exception(buffers::status::StatusCode::EXTERNAL_ID_COLLISION);
+    }
+    auto pool = std::make_shared<DescriptorPool>(*this, external_id, rank);
+    entries.insert({external_id, pool.get()});
+    shared_entries.try_emplace(external_id, pool);
+    entries_ranked.insert({rank, external_id});
+    descriptor_pool_entries.insert({external_id, std::move(pool)});
+    ++version;
+    InvalidateSnapshot();
+    MarkEntryModified(external_id);
+}
+
+void Catalog::DropDescriptorPool(CatalogEntryID external_id) {
+    std::lock_guard<std::mutex> lock{mutex};
+    auto iter = descriptor_pool_entries.find(external_id);
+    if (iter != descriptor_pool_entries.end()) {
+        auto& pool = *iter->second;
+        for (auto& segment : pool.segments) {
+            for (auto& [schema_key, schema_ref] : segment->schemas_by_qualified_name) {
+                auto& [db_name, schema_name] = schema_key;
+                entries_by_qualified_schema.erase({db_name, schema_name, pool.rank, external_id});
+                entries_by_schema.erase({schema_name, pool.rank, external_id});
+            }
+        }
+        DropUnqualifiedTableNames(pool);
+        entries_ranked.erase({pool.rank, external_id});
+        entries.erase(external_id);
+        shared_entries.erase(external_id);
+        descriptor_pool_entries.erase(iter);
+        ++version;
+        InvalidateSnapshot();
+        MarkEntryDropped(external_id);
+    }
+}
+
+void Catalog::AddSchemaDescriptor(CatalogEntryID external_id, std::span<const std::byte> descriptor_data,
+                                  std::unique_ptr<const std::byte[]> descriptor_buffer, size_t descriptor_buffer_size) {
+    std::lock_guard<std::mutex> lock{mutex};
+    auto iter = descriptor_pool_entries.find(external_id);
+    if (iter == descriptor_pool_entries.end()) {
+        throw Exception(buffers::status::StatusCode::CATALOG_DESCRIPTOR_POOL_UNKNOWN);
+    }
+    // Verify the buffer before accessing any field, the bytes are passed in by the host
+    flatbuffers::Verifier verifier{reinterpret_cast<const uint8_t*>(descriptor_data.data()), descriptor_data.size()};
+    if (!verifier.VerifyBuffer<buffers::catalog::SchemaDescriptor>()) {
+        throw Exception(buffers::status::StatusCode::CATALOG_DESCRIPTOR_INVALID);
+    }
+    auto* descriptor = flatbuffers::GetRoot<buffers::catalog::SchemaDescriptor>(descriptor_data.data());
+    std::array<const buffers::catalog::SchemaDescriptor*, 1> descriptors{descriptor};
+    AddSchemaDescriptors(iter->second, descriptors, std::move(descriptor_buffer), descriptor_buffer_size);
+}
+
+void Catalog::AddSchemaDescriptors(CatalogEntryID external_id, std::span<const std::byte> descriptors_data,
+                                   std::unique_ptr<const std::byte[]> descriptor_buffer,
+                                   size_t descriptor_buffer_size) {
+    std::lock_guard<std::mutex> lock{mutex};
+    auto iter = descriptor_pool_entries.find(external_id);
+    if (iter == descriptor_pool_entries.end()) {
+        throw Exception(buffers::status::StatusCode::CATALOG_DESCRIPTOR_POOL_UNKNOWN);
+    }
+    // Verify the buffer before accessing any field, the bytes are passed in by the host
+    flatbuffers::Verifier verifier{reinterpret_cast<const uint8_t*>(descriptors_data.data()), descriptors_data.size()};
+    if (!verifier.VerifyBuffer<buffers::catalog::SchemaDescriptors>()) {
+        throw Exception(buffers::status::StatusCode::CATALOG_DESCRIPTOR_INVALID);
+    }
+    auto* descriptors = flatbuffers::GetRoot<buffers::catalog::SchemaDescriptors>(descriptors_data.data());
+    std::vector<const buffers::catalog::SchemaDescriptor*> schemas;
+    if (auto* s = descriptors->schemas()) {
+        schemas.reserve(s->size());
+        for (auto* schema : *s) {
+            schemas.push_back(schema);
+        }
+    }
+    AddSchemaDescriptors(iter->second, schemas, std::move(descriptor_buffer), descriptor_buffer_size);
+}
+
+void Catalog::AddSchemaDescriptors(std::shared_ptr<DescriptorPool>& pool_ptr,
+                                   std::span<const buffers::catalog::SchemaDescriptor* const> descriptors,
+                                   std::unique_ptr<const std::byte[]> descriptor_buffer,
+                                   size_t descriptor_buffer_size) {
+    // Validate all descriptors first.
+    // Table names must be unique within the pool, a later table would otherwise silently shadow an earlier one.
+    std::unordered_set<CatalogEntry::QualifiedTableName::Key, TupleHasher> new_tables;
+    for (auto* descriptor : descriptors) {
+        if (!descriptor->tables()) {
+            throw Exception(buffers::status::StatusCode::CATALOG_DESCRIPTOR_TABLES_NULL);
+        }
+        auto database_name = ReadDescriptorString(descriptor->database_name());
+        auto schema_name = ReadDescriptorString(descriptor->schema_name());
+        for (auto* table : *descriptor->tables()) {
+            auto table_name = ReadDescriptorString(table->table_name());
+            if (table_name.empty()) {
+                throw Exception(buffers::status::StatusCode::CATALOG_DESCRIPTOR_TABLE_NAME_EMPTY);
+            }
+            CatalogEntry::QualifiedTableName::Key key{database_name, schema_name, table_name};
+            if (pool_ptr->FindQualifiedTable(key) || !new_tables.insert(key).second) {
+                throw Exception(buffers::status::StatusCode::CATALOG_DESCRIPTOR_TABLE_NAME_COLLISION);
+            }
+        }
+    }
+    if (descriptors.empty()) {
+        return;
+    }
+    ++version;
+    InvalidateSnapshot();
+    MarkEntryModified(pool_ptr->GetCatalogEntryId());
+
+    // Snapshots that still read the pool must not see it change, modify a clone then.
+    // The pool entries and the shared entries reference the pool. Snapshots may share the index node that holds the
+    // reference, making the path to the pool writable copies the reference into a new node if they do.
+    // The clone shares the segments with the pool, the descriptors are then added to a new segment.
+    shared_entries.find_mutable(pool_ptr->GetCatalogEntryId());
+    if (pool_ptr.use_count() > 2) {
+        auto clone = pool_ptr->Clone();
+        entries.at(clone->GetCatalogEntryId()) = clone.get();
+        shared_entries.insert_or_assign(clone->GetCatalogEntryId(), clone);
+        pool_ptr = std::move(clone);
+    }
+    auto& pool = *pool_ptr;
+    auto& segment = pool.GetWritableSegment();
+    pool.catalog_version = version;
+    segment.catalog_version = version;
+    auto first_table = segment.table_declarations.GetSize();
+
+    for (auto* descriptor : descriptors) {
+        auto database_name = ReadDescriptorString(descriptor->database_name());
+        auto schema_name = ReadDescriptorString(descriptor->schema_name());
+
+        // Declare the database and the schema in the catalog
+        auto db_id = AllocateDatabaseId(database_name);
+        if (!databases.contains(database_name)) {
+            auto db = std::make_shared<DatabaseDeclaration>(db_id, database_name, "");
+            std::string_view db_key{db->database_name};
+            databases.insert({db_key, std::move(db)});
+        }
+        auto schema_id = AllocateSchemaId(database_name, schema_name, db_id);
+        if (!schemas.contains({database_name, schema_name})) {
+            auto schema =
+                std::make_shared<SchemaDeclaration>(schema_id, databases.find(database_name)->first, schema_name);
+            schemas.insert({std::pair<std::string_view, std::string_view>{schema->database_name, schema->schema_name},
+                            std::move(schema)});
+        }
+
+        // Add the descriptor to the pool and register new schemas of the pool
+        bool new_schema = !pool.ContainsSchema(database_name, schema_name);
+        auto& schema_ref = segment.AddSchemaDescriptor(*descriptor, db_id, schema_id);
+        if (new_schema) {
+            CatalogSchemaEntryInfo entry_info{
+                .catalog_entry_id = pool.GetCatalogEntryId(),
+                .catalog_schema_id = schema_ref.object_id,
+            };
+            std::tuple<std::string_view, std::string_view, CatalogEntry::Rank, CatalogEntryID> qualified_schema_key{
+                schema_ref.database_name, schema_ref.schema_name, pool.rank, pool.GetCatalogEntryId()};
+            std::tuple<std::string_view, CatalogEntry::Rank, CatalogEntryID> schema_key{
+                schema_ref.schema_name, pool.rank, pool.GetCatalogEntryId()};
+            entries_by_qualified_schema.insert({qualified_schema_key, entry_info});
+            entries_by_schema.insert({schema_key, entry_info});
+        }
+    }
+    segment.descriptor_buffers.push_back(
+        {.buffer = std::move(descriptor_buffer), .buffer_size = descriptor_buffer_size});
+    segment.table_column_store.IndexByName();
+
+    // Merge the trailing segments and re-index the tables of the merged segment
+    auto replaced = pool.CompactSegments();
+    if (replaced.empty()) {
+        IndexUnqualifiedTableNames(segment, pool.rank, first_table);
+    } else {
+        for (auto& replaced_segment : replaced) {
+            DropUnqualifiedTableNames(*replaced_segment);
+        }
+        IndexUnqualifiedTableNames(*pool.segments.back(), pool.rank);
+    }
+}
+
+void Catalog::IndexUnqualifiedTableNames(const CatalogEntry& entry, CatalogEntry::Rank rank, size_t first_table) {
+    auto& tables = entry.table_declarations;
+    for (size_t i = first_table; i < tables.GetSize(); ++i) {
+        auto& table = tables[i];
+        auto table_name = table.table_name.table_name.get().text;
+        auto* declarations = tables_by_unqualified_name.find_mutable(table_name);
+        if (!declarations) {
+            declarations = &tables_by_unqualified_name.try_emplace(std::string{table_name}).first;
+        }
+        // Keep the declarations ordered by <rank, entry> and by declaration order within an entry
+        CatalogTableEntryInfo info{
+            .rank = rank,
+            .catalog_entry_id = entry.GetCatalogEntryId(),
+            .table = table,
+        };
+        auto pos = std::upper_bound(declarations->begin(), declarations->end(), info, [](auto& l, auto& r) {
+            return std::make_tuple(l.rank, l.catalog_entry_id) < std::make_tuple(r.rank, r.catalog_entry_id);
+        });
+        declarations->insert(pos, info);
+    }
+}
+
+void Catalog::DropUnqualifiedTableNames(const CatalogEntry& entry) {
+    std::vector<const CatalogEntry*> segments;
+    entry.CollectSegments(segments);
+    for (auto* segment : segments) {
+        segment->table_declarations.ForEach([&](size_t, const CatalogEntry::TableDeclaration& table) {
+            auto table_name = table.table_name.table_name.get().text;
+            auto* declarations = tables_by_unqualified_name.find_mutable(table_name);
+            if (!declarations) {
+                return;
+            }
+            // Erase the declaration itself, other segments of the entry may still declare tables with the name
+            std::erase_if(*declarations, [&](auto& info) { return &info.table.get() == &table; });
+            if (declarations->empty()) {
+                tables_by_unqualified_name.erase(table_name);
+            }
+        });
     }
 }
 
@@ -800,9 +1569,103 @@ const CatalogEntry::TableDeclaration* Catalog::ResolveTable(CatalogTableID table
         return nullptr;
     }
 }
+/// Append a value to a resolution cache key
+template <typename T> static void appendKey(std::string& key, T value) {
+    key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+/// Append a name to a resolution cache key
+static void appendKey(std::string& key, std::string_view name) {
+    appendKey<uint32_t>(key, name.size());
+    key.append(name);
+}
+
 void Catalog::ResolveTable(CatalogEntry::QualifiedTableName name, CatalogEntryID ignore_entry,
                            std::vector<std::reference_wrapper<const CatalogEntry::TableDeclaration>>& out,
                            size_t limit) const {
+    GetSnapshot()->ResolveTable(name, ignore_entry, out, limit);
+}
+
+CatalogSnapshot::CatalogSnapshot(const Catalog& catalog)
+    : catalog(catalog),
+      version(catalog.version),
+      entries(catalog.shared_entries),
+      entries_ranked(catalog.entries_ranked),
+      entries_by_qualified_schema(catalog.entries_by_qualified_schema),
+      entries_by_schema(catalog.entries_by_schema),
+      tables_by_unqualified_name(catalog.tables_by_unqualified_name),
+      databases(catalog.databases),
+      schemas(catalog.schemas) {
+    assert(entries.size() == catalog.entries.size());
+}
+
+QualifiedCatalogObjectID CatalogSnapshot::AllocateDatabaseId(std::string_view database) const {
+    auto iter = databases.find(database);
+    if (iter != databases.end()) {
+        return iter->second->object_id;
+    } else {
+        return QualifiedCatalogObjectID::Database(catalog.next_database_id++);
+    }
+}
+
+QualifiedCatalogObjectID CatalogSnapshot::AllocateSchemaId(std::string_view database, std::string_view schema,
+                                                           QualifiedCatalogObjectID db_id) const {
+    auto iter = schemas.find({database, schema});
+    if (iter != schemas.end()) {
+        return iter->second->object_id;
+    } else {
+        return QualifiedCatalogObjectID::Schema(db_id.UnpackDatabaseID(), catalog.next_schema_id++);
+    }
+}
+
+const CatalogEntry::TableDeclaration* CatalogSnapshot::ResolveTable(CatalogTableID table_id) const {
+    if (auto* entry = entries.find(table_id.GetOrigin())) {
+        return (*entry)->ResolveTableById(table_id);
+    } else {
+        return nullptr;
+    }
+}
+
+size_t CatalogSnapshot::GetMemoizedResolutionCount() const {
+    std::lock_guard<std::mutex> lock{table_resolution_cache.mutex};
+    return table_resolution_cache.resolutions.size();
+}
+
+void CatalogSnapshot::ResolveTable(CatalogEntry::QualifiedTableName name, CatalogEntryID ignore_entry,
+                                   ResolvedTables& out, size_t limit) const {
+    // The resolution depends on previous matches, we only memoize resolutions into empty vectors
+    if (!out.empty()) {
+        ResolveTableWithoutCache(name, ignore_entry, out, limit);
+        return;
+    }
+    auto& cache = table_resolution_cache;
+    auto& stats = catalog.table_resolution_statistics;
+    std::lock_guard<std::mutex> lock{cache.mutex};
+
+    // Probe the cache
+    auto& key = cache.key_buffer;
+    key.clear();
+    appendKey<CatalogEntryID>(key, ignore_entry);
+    appendKey<uint64_t>(key, limit);
+    appendKey(key, name.database_name.get().text);
+    appendKey(key, name.schema_name.get().text);
+    appendKey(key, name.table_name.get().text);
+    if (auto iter = cache.resolutions.find(std::string_view{key}); iter != cache.resolutions.end()) {
+        ++stats.hits;
+        out = iter->second;
+        return;
+    }
+
+    // Resolve the table and memoize the result
+    ++stats.misses;
+    ResolveTableWithoutCache(name, ignore_entry, out, limit);
+    if (cache.resolutions.size() >= TableResolutionCache::MAX_ENTRIES) {
+        cache.resolutions.clear();
+    }
+    cache.resolutions.try_emplace(key, out);
+}
+
+void CatalogSnapshot::ResolveTableWithoutCache(CatalogEntry::QualifiedTableName name, CatalogEntryID ignore_entry,
+                                               ResolvedTables& out, size_t limit) const {
     // Always check if there are schema entries that contains the fully qualified name.
     // "Fully qualified" just means that we're doing direct lookups here and not a path suffix search.
     // If someone registered a name as `"".""."foo"` and then searches for "foo", there will be a direct hit here.
@@ -816,10 +1679,9 @@ void Catalog::ResolveTable(CatalogEntry::QualifiedTableName name, CatalogEntryID
             continue;
         }
         assert(entries.contains(candidate));
-        auto& entry = entries.at(candidate);
-        auto tbl = entry->tables_by_qualified_name.find(name);
-        if (tbl != entry->tables_by_qualified_name.end()) {
-            out.push_back(tbl->second.get());
+        auto& entry = *entries.find(candidate);
+        if (auto* table = entry->FindQualifiedTable(name)) {
+            out.push_back(*table);
             if (out.size() >= limit) {
                 break;
             }
@@ -857,7 +1719,7 @@ void Catalog::ResolveTable(CatalogEntry::QualifiedTableName name, CatalogEntryID
                     continue;
                 }
                 assert(entries.contains(candidate));
-                auto& schema = entries.at(candidate);
+                auto& schema = *entries.find(candidate);
 
                 // Resolve all tables cross-database
                 schema->ResolveTableInSchema(schema_name, name.table_name.get(), out, limit);
@@ -869,10 +1731,13 @@ void Catalog::ResolveTable(CatalogEntry::QualifiedTableName name, CatalogEntryID
         } else {
             // Schema name is empty, we only have the table name.
             // This is the most fuzzy resolution.
-            // We go through all the entries ordered by rank and collect all matches until we hit the limit.
-            for (auto& [rank, external_id] : entries_ranked) {
-                auto& entry = *entries.at(external_id);
-                entry.ResolveTableEverywhere(name.table_name.get(), out, limit);
+            // We collect the matches of all entries ordered by rank until we hit the limit.
+            auto* declarations = tables_by_unqualified_name.find(name.table_name.get().text);
+            if (!declarations) {
+                return;
+            }
+            for (auto& info : *declarations) {
+                out.push_back(info.table);
                 if (out.size() >= limit) {
                     break;
                 }
@@ -885,13 +1750,84 @@ void Catalog::ResolveTable(CatalogEntry::QualifiedTableName name, CatalogEntryID
 std::unique_ptr<buffers::catalog::CatalogStatisticsT> Catalog::GetStatistics() {
     auto stats = std::make_unique<buffers::catalog::CatalogStatisticsT>();
 
-    // Schema descriptor support removed - returning empty statistics
+    // Collect the statistics of a single entry or segment
+    auto collect_entry = [&](const CatalogEntry& entry, const NameRegistry& registry,
+                             buffers::catalog::CatalogMemoryStatistics& memory,
+                             buffers::catalog::CatalogContentStatistics& content) {
+        memory.mutate_name_registry_size(memory.name_registry_size() + registry.GetSize());
+        memory.mutate_name_registry_bytes(memory.name_registry_bytes() + registry.GetByteSize());
+        if (auto& index = entry.name_search_index) {
+            memory.mutate_name_search_index_entries(memory.name_search_index_entries() + index->GetSize());
+            memory.mutate_name_search_index_bytes(memory.name_search_index_bytes() + index->GetByteSize());
+        }
+        content.mutate_database_count(content.database_count() + entry.database_references.GetSize());
+        content.mutate_schema_count(content.schema_count() + entry.schema_references.GetSize());
+        content.mutate_table_count(content.table_count() + entry.table_declarations.GetSize());
+        content.mutate_table_column_count(content.table_column_count() + entry.table_column_store.GetSize());
+        auto& store = entry.table_column_store;
+        memory.mutate_table_column_bytes(memory.table_column_bytes() + store.GetColumnByteSize());
+        memory.mutate_table_column_store_bytes(memory.table_column_store_bytes() + store.GetIndexByteSize());
+    };
+    // Add the statistics of an entry
+    auto add_entry = [&](std::unique_ptr<buffers::catalog::CatalogMemoryStatistics> memory,
+                         std::unique_ptr<buffers::catalog::CatalogContentStatistics> content) {
+        auto entry_stats = std::make_unique<buffers::catalog::CatalogEntryStatisticsT>();
+        entry_stats->memory = std::move(memory);
+        entry_stats->content = std::move(content);
+        stats->entries.push_back(std::move(entry_stats));
+    };
+
+    // Collect the statistics of all script entries
+    for (auto& [script, script_entry] : script_entries) {
+        auto& analyzed = *script_entry.analyzed;
+        auto& registry = analyzed.parsed_script->scanned_script->name_registry;
+        auto memory = std::make_unique<buffers::catalog::CatalogMemoryStatistics>();
+        auto content = std::make_unique<buffers::catalog::CatalogContentStatistics>();
+        collect_entry(analyzed, registry, *memory, *content);
+        add_entry(std::move(memory), std::move(content));
+    }
+    // Collect the statistics of all descriptor pools, summed over their segments
+    for (auto& [entry_id, pool] : descriptor_pool_entries) {
+        auto memory = std::make_unique<buffers::catalog::CatalogMemoryStatistics>();
+        auto content = std::make_unique<buffers::catalog::CatalogContentStatistics>();
+        size_t descriptor_buffer_count = 0;
+        size_t descriptor_buffer_bytes = 0;
+        for (auto& segment : pool->segments) {
+            for (auto& buffer : segment->descriptor_buffers) {
+                descriptor_buffer_bytes += buffer.buffer_size;
+            }
+            descriptor_buffer_count += segment->descriptor_buffers.size();
+            collect_entry(*segment, segment->name_registry, *memory, *content);
+        }
+        memory->mutate_descriptor_buffer_count(descriptor_buffer_count);
+        memory->mutate_descriptor_buffer_bytes(descriptor_buffer_bytes);
+        add_entry(std::move(memory), std::move(content));
+    }
+
     auto content = std::make_unique<buffers::catalog::CatalogContentStatistics>();
-    content->mutate_database_count(0);
-    content->mutate_schema_count(0);
-    content->mutate_table_count(0);
-    content->mutate_table_column_count(0);
+    content->mutate_database_count(databases.size());
+    content->mutate_schema_count(schemas.size());
+    uint32_t table_count = 0;
+    uint32_t table_column_count = 0;
+    for (auto& entry_stats : stats->entries) {
+        table_count += entry_stats->content->table_count();
+        table_column_count += entry_stats->content->table_column_count();
+    }
+    content->mutate_table_count(table_count);
+    content->mutate_table_column_count(table_column_count);
     stats->content = std::move(content);
 
+    auto resolution = std::make_unique<buffers::catalog::CatalogResolutionStatistics>();
+    resolution->mutate_table_resolution_cache_hits(table_resolution_statistics.hits);
+    resolution->mutate_table_resolution_cache_misses(table_resolution_statistics.misses);
+    resolution->mutate_table_resolution_cache_invalidations(table_resolution_statistics.invalidations);
+    {
+        std::lock_guard<std::mutex> lock{mutex};
+        if (snapshot) {
+            resolution->mutate_table_resolution_cache_entries(snapshot->GetMemoizedResolutionCount());
+        }
+    }
+    stats->resolution = std::move(resolution);
+
     return stats;
 }
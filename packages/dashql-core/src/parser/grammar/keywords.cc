@@ -1,7 +1,11 @@
 #include "dashql/parser/grammar/keywords.h"
 
-#include "frozen/bits/elsa_std.h"
-#include "frozen/unordered_map.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <string>
 
 namespace dashql {
 namespace parser {
@@ -27,10 +31,9 @@ constexpr int64_t KEYWORD_MAX_SYMBOL_ID = std::max<int64_t>({
     0});
 constexpr size_t KEYWORD_SYMBOL_COUNT = KEYWORD_MAX_SYMBOL_ID + 1;
 
-constexpr frozen::unordered_map<std::string_view, Keyword, KEYWORD_COUNT> KEYWORD_MAP = {
-#define X(CATEGORY, NAME, KEYWORD) \
-    {NAME,                         \
-     Keyword{NAME, Parser::token::FQL_##KEYWORD, Parser::symbol_kind_type::S_##KEYWORD, KeywordCategory::CATEGORY}},
+constexpr std::array<Keyword, KEYWORD_COUNT> KEYWORDS{
+#define X(CATEGORY, NAME, TOKEN) \
+    Keyword{NAME, Parser::token::FQL_##TOKEN, Parser::symbol_kind_type::S_##TOKEN, KeywordCategory::CATEGORY},
 #include "grammar_lists/sql_column_name_keywords.list"
 #include "grammar_lists/sql_reserved_keywords.list"
 #include "grammar_lists/sql_type_func_keywords.list"
@@ -39,9 +42,113 @@ constexpr frozen::unordered_map<std::string_view, Keyword, KEYWORD_COUNT> KEYWOR
 #undef X
 };
 
+/// Read the hash key of a keyword.
+/// The length together with the first and last 4 bytes is unique across all keyword lists.
+/// We therefore never hash more than 8 bytes, no matter how long the identifier is.
+constexpr uint64_t ReadKeywordKey(std::string_view text) {
+    size_t n = std::min<size_t>(text.size(), 4);
+    uint64_t head = 0;
+    uint64_t tail = 0;
+    for (size_t i = 0; i < n; ++i) {
+        head |= static_cast<uint64_t>(static_cast<unsigned char>(text[i])) << (8 * i);
+        tail |= static_cast<uint64_t>(static_cast<unsigned char>(text[text.size() - n + i])) << (8 * i);
+    }
+    return (head | (tail << 32)) ^ (text.size() * 0x9E3779B97F4A7C15ull);
+}
+/// Hash a keyword key with a seed
+constexpr uint64_t HashKeywordKey(uint64_t key, uint64_t seed) {
+    uint64_t h = key + seed * 0xBF58476D1CE4E5B9ull;
+    h ^= h >> 31;
+    h *= 0x94D049BB133111EBull;
+    h ^= h >> 29;
+    return h;
+}
+
+/// A perfect hash table for the keywords.
+/// Keys are first hashed into buckets, every bucket then stores a seed that displaces its keys into distinct slots.
+struct KeywordTable {
+    /// The number of buckets
+    static constexpr size_t BUCKET_COUNT = 256;
+    /// The number of slots
+    static constexpr size_t SLOT_COUNT = 1024;
+    /// The maximum number of keywords in a bucket
+    static constexpr size_t MAX_BUCKET_SIZE = 16;
+    /// The seeds of the buckets
+    std::array<uint16_t, BUCKET_COUNT> bucket_seeds{};
+    /// The keyword ids in the slots, 0 if empty and keyword index + 1 otherwise
+    std::array<uint16_t, SLOT_COUNT> slots{};
+
+    /// Get the slot of a keyword key
+    constexpr size_t GetSlot(uint64_t key) const {
+        auto bucket = HashKeywordKey(key, 0) & (BUCKET_COUNT - 1);
+        return HashKeywordKey(key, bucket_seeds[bucket]) & (SLOT_COUNT - 1);
+    }
+};
+static_assert(KEYWORD_COUNT < KeywordTable::SLOT_COUNT);
+
+/// Build the perfect hash table.
+/// Fails the compilation if no seed displaces a bucket without collisions.
+constexpr KeywordTable BuildKeywordTable() {
+    KeywordTable table;
+    // Sort the keywords by bucket
+    std::array<uint64_t, KEYWORD_COUNT> keys{};
+    std::array<size_t, KeywordTable::BUCKET_COUNT + 1> bucket_offsets{};
+    for (size_t i = 0; i < KEYWORD_COUNT; ++i) {
+        keys[i] = ReadKeywordKey(KEYWORDS[i].name);
+        ++bucket_offsets[(HashKeywordKey(keys[i], 0) & (KeywordTable::BUCKET_COUNT - 1)) + 1];
+    }
+    for (size_t b = 0; b < KeywordTable::BUCKET_COUNT; ++b) {
+        if (bucket_offsets[b + 1] > KeywordTable::MAX_BUCKET_SIZE) {
+            throw std::logic_error{"keyword table bucket exceeds the maximum bucket size"};
+        }
+        bucket_offsets[b + 1] += bucket_offsets[b];
+    }
+    std::array<uint16_t, KEYWORD_COUNT> bucket_keywords{};
+    std::array<size_t, KeywordTable::BUCKET_COUNT> bucket_fill{};
+    for (size_t i = 0; i < KEYWORD_COUNT; ++i) {
+        auto b = HashKeywordKey(keys[i], 0) & (KeywordTable::BUCKET_COUNT - 1);
+        bucket_keywords[bucket_offsets[b] + bucket_fill[b]++] = static_cast<uint16_t>(i);
+    }
+    // Place the large buckets first
+    for (size_t bucket_size = KeywordTable::MAX_BUCKET_SIZE; bucket_size > 0; --bucket_size) {
+        for (size_t b = 0; b < KeywordTable::BUCKET_COUNT; ++b) {
+            auto begin = bucket_offsets[b];
+            auto end = bucket_offsets[b + 1];
+            if ((end - begin) != bucket_size) {
+                continue;
+            }
+            for (uint16_t seed = 1;; ++seed) {
+                if (seed == std::numeric_limits<uint16_t>::max()) {
+                    throw std::logic_error{"failed to build the keyword table"};
+                }
+                std::array<size_t, KeywordTable::MAX_BUCKET_SIZE> bucket_slots{};
+                bool collision = false;
+                for (size_t i = begin; i < end && !collision; ++i) {
+                    auto slot = HashKeywordKey(keys[bucket_keywords[i]], seed) & (KeywordTable::SLOT_COUNT - 1);
+                    collision = table.slots[slot] != 0;
+                    for (size_t j = begin; j < i && !collision; ++j) {
+                        collision = bucket_slots[j - begin] == slot;
+                    }
+                    bucket_slots[i - begin] = slot;
+                }
+                if (collision) {
+                    continue;
+                }
+                for (size_t i = begin; i < end; ++i) {
+                    table.slots[bucket_slots[i - begin]] = static_cast<uint16_t>(bucket_keywords[i] + 1);
+                }
+                table.bucket_seeds[b] = seed;
+                break;
+            }
+        }
+    }
+    return table;
+}
+constexpr KeywordTable KEYWORD_TABLE = BuildKeywordTable();
+
 static constexpr std::array<std::string_view, KEYWORD_SYMBOL_COUNT> GetKeywordSymbolNames() {
     std::array<std::string_view, KEYWORD_SYMBOL_COUNT> keywords;
-    for (auto& [key, value] : KEYWORD_MAP) {
+    for (auto& value : KEYWORDS) {
         int64_t i = static_cast<int64_t>(value.parser_symbol);
         if (i >= 0) {
             keywords[i] = value.name;
@@ -52,16 +159,7 @@ static constexpr std::array<std::string_view, KEYWORD_SYMBOL_COUNT> GetKeywordSy
 static const std::array<std::string_view, KEYWORD_SYMBOL_COUNT> KEYWORD_SYMBOL_NAMES = GetKeywordSymbolNames();
 
 const constexpr std::array<Keyword, KEYWORD_COUNT> SortKeywords() {
-    std::array<Keyword, KEYWORD_COUNT> keywords{
-#define X(CATEGORY, NAME, TOKEN) \
-    Keyword{NAME, Parser::token::FQL_##TOKEN, Parser::symbol_kind_type::S_##TOKEN, KeywordCategory::CATEGORY},
-#include "grammar_lists/sql_column_name_keywords.list"
-#include "grammar_lists/sql_reserved_keywords.list"
-#include "grammar_lists/sql_type_func_keywords.list"
-#include "grammar_lists/sql_unreserved_keywords.list"
-#include "grammar_lists/vis_unreserved_keywords.list"
-#undef X
-    };
+    std::array<Keyword, KEYWORD_COUNT> keywords = KEYWORDS;
     std::sort(keywords.begin(), keywords.end(), [](auto& l, auto& r) { return l.name < r.name; });
     return keywords;
 };
@@ -106,13 +204,14 @@ std::string_view Keyword::GetSymbolText(Parser::symbol_kind_type sym) {
 /// Find a keyword
 const Keyword* Keyword::Find(std::string_view text) {
     // Abort early if the keyword exceeds the max keyword size
-    if (text.size() > MAX_KEYWORD_LENGTH) return nullptr;
+    if (text.empty() || text.size() > MAX_KEYWORD_LENGTH) return nullptr;
 
-    if (auto iter = KEYWORD_MAP.find(text); iter != KEYWORD_MAP.end()) {
-        return &iter->second;
-    } else {
+    auto keyword_id = KEYWORD_TABLE.slots[KEYWORD_TABLE.GetSlot(ReadKeywordKey(text))];
+    if (keyword_id == 0) {
         return nullptr;
     }
+    auto& keyword = KEYWORDS[keyword_id - 1];
+    return keyword.name == text ? &keyword : nullptr;
 }
 
 // Debug ostream operator
@@ -122,7 +221,13 @@ std::ostream& operator<<(std::ostream& os, const Keyword& k) {
 }
 
 // Check the integrity
-void Keyword::CheckIntegrity() { KEYWORD_MAP.check_integrity(); }
+void Keyword::CheckIntegrity() {
+    for (auto& keyword : KEYWORDS) {
+        if (Find(keyword.name) != &keyword) {
+            throw std::logic_error{"keyword table does not resolve the keyword: " + std::string{keyword.name}};
+        }
+    }
+}
 
 }  // namespace parser
 }  // namespace dashql
@@ -12,13 +12,14 @@ namespace parser {
 ParseContext::ParseContext(ScannedScript& scan, bool enable_vis_syntax)
     : program(scan),
       symbol_iterator(scan.symbols),
-      nodes(),
+      arena(Arena::DEFAULT_BLOCK_SIZE, scan.arena.GetBlockPool()),
+      nodes(&arena),
       statements(),
       errors(),
       current_statement(),
-      temp_lists(),
-      temp_list_elements(),
-      temp_nary_expressions(),
+      temp_lists(&arena),
+      temp_list_elements(&arena),
+      temp_nary_expressions(&arena),
       enable_vis_syntax(enable_vis_syntax) {}
 /// Destructor
 ParseContext::~ParseContext() {}
@@ -311,6 +312,35 @@ void ParseContext::AddStatement(buffers::parser::Node node) {
 
 void ParseContext::ResetStatement() { current_statement.nodes_begin = nodes.GetSize(); }
 
+/// Add a statement separator
+void ParseContext::AddStatementSeparator(buffers::parser::SymbolSpan loc) {
+    // Nodes of a failed statement never belong to the next one
+    ResetStatement();
+    statement_separators.push_back({
+        .symbol_id = loc.offset(),
+        .nodes_begin = static_cast<uint32_t>(nodes.GetSize()),
+        .statements_begin = static_cast<uint32_t>(statements.size()),
+        .errors_begin = static_cast<uint32_t>(errors.size()),
+        .vis_spec_spans_begin = static_cast<uint32_t>(vis_spec_spans.size()),
+    });
+}
+
+/// Continue reading symbols after the symbol limit?
+bool ParseContext::ExtendSymbolLimit() {
+    // Stop if the preceding semicolon was consumed as statement separator
+    if (!statement_separators.empty() && (statement_separators.back().symbol_id + 1) == next_token_index) {
+        return false;
+    }
+    // Otherwise continue until after the next separator candidate
+    if (symbol_limit_candidates.empty()) {
+        symbol_limit = std::numeric_limits<uint32_t>::max();
+    } else {
+        symbol_limit = symbol_limit_candidates.front();
+        symbol_limit_candidates = symbol_limit_candidates.subspan(1);
+    }
+    return true;
+}
+
 /// Add an error
 void ParseContext::AddError(buffers::parser::SymbolSpan loc, const std::string& message, std::string hint) {
     errors.push_back({loc, message, std::move(hint)});
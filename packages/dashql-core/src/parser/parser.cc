@@ -23,9 +23,12 @@
 
 #include "dashql/parser/parser.h"
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 
+#include "dashql/parser/grammar/enums.h"
+#include "dashql/parser/grammar/keywords.h"
 #include "dashql/parser/parse_context.h"
 #include "dashql/parser/parser_generated.h"
 #include "dashql/utils/chunk_buffer.h"
@@ -158,6 +161,7 @@ yybackup:
         // synthetic token in place of the real one (probe's insert mode).
         auto pre_iter = ctx.GetSymbolIterator();
         auto pre_token_index = ctx.next_token_index;
+        recovering_from_error = yyerrstatus_ != 0;
         // Get the next symbol
         auto next_symbol = ctx.NextSymbol();
         // Let the policy inspect / mutate / replace the lookahead, or signal stop. Stop happens
@@ -363,7 +367,7 @@ Parser::ExpectedAtCursor Parser::ParseUntilWithSnapshot(ScannedScript& scanned,
     ExpectedAtCursor out;
     ParseContext ctx{scanned};
     dashql::parser::Parser parser(ctx);
-    parser.ParsePrefixToTarget(symbol_id, out.prefix);
+    parser.ParsePrefixToTarget(symbol_id, out.prefix, &scanned.lalr_snapshots);
     if (out.prefix.reached_target) {
         // Restore so yy_lac_check_ (which reads yystack_[].state) sees the captured state.
         parser.RestorePrefix(out.prefix);
@@ -414,14 +418,30 @@ Parser::SuffixProbe Parser::ProbeSuffixSequenceFromSnapshot(ScannedScript& scann
 // On entry to the cursor (i.e. when the iterator first points there), we stop *before* reading
 // the lookahead — the suffix replay reproduces that read from the snapshot.
 // Policy for ParsePrefixToTarget: parse the prefix normally; when the next read would consume
-// the cursor's token, snapshot the state stack and stop.
+// the cursor's token, snapshot the state stack and stop. Optionally records the state stack before
+// the first read after a semicolon, unless the parser is still recovering from an error. The
+// driver state at such a read is fully described by the state stack and the scanner position.
 struct PrefixCapturePolicy {
+    /// The minimum number of symbols between two boundary snapshots
+    static constexpr uint32_t BOUNDARY_SNAPSHOT_DISTANCE = 128;
+
     ChunkBufferEntryID target_symbol_id;
     Parser::PrefixSnapshot& out;
+    std::vector<Parser::BoundarySnapshot>* boundaries = nullptr;
+    bool after_separator = false;
 
     template <typename Iter>
     void OnLookaheadRead(Parser& p, Parser::symbol_type& /*next_symbol*/, const Iter& pre_iter,
-                         uint32_t /*pre_token_index*/, bool& stop) {
+                         uint32_t pre_token_index, bool& stop) {
+        if (boundaries && after_separator && !p.IsRecoveringFromError() &&
+            (boundaries->empty() || pre_token_index >= boundaries->back().symbol_id + BOUNDARY_SNAPSHOT_DISTANCE)) {
+            auto& snapshot = boundaries->emplace_back();
+            snapshot.symbol_id = pre_token_index;
+            for (auto i = p.GetStackSize(); i > 0; --i) {
+                snapshot.state_stack.push_back(p.GetStackState(i - 1));
+            }
+        }
+        after_separator = false;
         if (pre_iter >= target_symbol_id) {
             out.reached_target = true;
             // Capture state numbers from bottom to top.
@@ -431,25 +451,44 @@ struct PrefixCapturePolicy {
             stop = true;
         }
     }
-    void OnShifted(Parser&, Parser::symbol_kind_type) {}
+    void OnShifted(Parser&, Parser::symbol_kind_type shifted_kind) {
+        after_separator = shifted_kind == Parser::symbol_kind_type::S_SEMICOLON;
+    }
     void OnAccept(Parser&) {}
     bool ShortCircuitOnError(Parser&) { return false; }
 };
 
-void Parser::ParsePrefixToTarget(ChunkBufferEntryID target_symbol_id, PrefixSnapshot& out) {
+void Parser::ParsePrefixToTarget(ChunkBufferEntryID target_symbol_id, PrefixSnapshot& out,
+                                 std::vector<BoundarySnapshot>* boundaries) {
     out.state_stack.clear();
     out.reached_target = false;
-    PrefixCapturePolicy policy{target_symbol_id, out};
-    DriveLALR(policy, /*init_stack=*/true);
+    PrefixCapturePolicy policy{target_symbol_id, out, boundaries};
+
+    // Resume at the last boundary snapshot before the target
+    bool init_stack = true;
+    if (boundaries && !boundaries->empty()) {
+        auto& symbols = ctx.program.symbols;
+        auto target = symbols.GetFlatEntryID(target_symbol_id);
+        auto iter = std::upper_bound(
+            boundaries->begin(), boundaries->end(), target,
+            [](size_t id, const BoundarySnapshot& snapshot) { return id < snapshot.symbol_id; });
+        if (iter != boundaries->begin()) {
+            auto& boundary = *std::prev(iter);
+            RestoreStateStack(boundary.state_stack);
+            ctx.RewindScanner(symbols.GetIteratorAt(boundary.symbol_id), boundary.symbol_id);
+            init_stack = false;
+        }
+    }
+    DriveLALR(policy, init_stack);
 }
 
 // Restore a captured state stack into the parser. PrefixCapturePolicy stores states bottom-to-top,
 // matching yystack_'s push order; GetStackState itself indexes from the top. We push only state
 // numbers — semantic values are not needed by the no-op reductions or LAC checks.
-void Parser::RestorePrefix(const PrefixSnapshot& prefix) {
+void Parser::RestoreStateStack(std::span<const state_type> state_stack) {
     yystack_.clear();
-    if (prefix.state_stack.empty()) return;
-    for (auto state : prefix.state_stack) {
+    if (state_stack.empty()) return;
+    for (auto state : state_stack) {
         stack_symbol_type stk;
         stk.state = state;
         yypush_(YY_NULLPTR, YY_MOVE(stk));
@@ -457,6 +496,8 @@ void Parser::RestorePrefix(const PrefixSnapshot& prefix) {
     yy_lac_discard_("init");
 }
 
+void Parser::RestorePrefix(const PrefixSnapshot& prefix) { RestoreStateStack(prefix.state_stack); }
+
 // Replay the suffix from a captured prefix state stack: restores the parser state, advances the
 // scanner iterator to the target token, then drives the shared LALR loop with `SuffixProbePolicy`.
 //
@@ -587,4 +628,142 @@ std::shared_ptr<ParsedScript> Parser::Parse(std::shared_ptr<ScannedScript> scann
     return std::make_shared<ParsedScript>(scanned, std::move(ctx));
 }
 
+std::shared_ptr<ParsedScript> Parser::Parse(std::shared_ptr<ScannedScript> scanned, const ParsedScript& previous) {
+    assert(scanned != nullptr);
+    auto& prev_scanned = *previous.scanned_script;
+
+    // We can only reuse statements if the symbols were copied from the previously parsed scan
+    auto& reused = scanned->reused_symbols;
+    if (!reused.has_value() || reused->previous_text_version != prev_scanned.text_version ||
+        previous.external_id != scanned->external_id) {
+        return Parse(scanned);
+    }
+    auto& separators = previous.statement_separators;
+    int64_t symbol_shift =
+        static_cast<int64_t>(reused->suffix_begin) - static_cast<int64_t>(reused->previous_suffix_begin);
+
+    // Find the last separator in the reused prefix.
+    // A reparse starts in the initial parser state which does not accept a semicolon as first symbol.
+    // We therefore move the start before separators that are immediately followed by another one.
+    auto prefix_end = std::lower_bound(separators.begin(), separators.end(), reused->prefix_count,
+                                       [](auto& separator, size_t id) { return separator.symbol_id < id; });
+    while (prefix_end != separators.begin() &&
+           scanned->symbols[std::prev(prefix_end)->symbol_id + 1].kind() == symbol_kind::S_SEMICOLON) {
+        --prefix_end;
+    }
+    ParsedScript::StatementSeparator prefix;
+    size_t region_begin = 0;
+    if (prefix_end != separators.begin()) {
+        prefix = *std::prev(prefix_end);
+        region_begin = prefix.symbol_id + 1;
+    }
+
+    // Collect the separators in the reused suffix.
+    // The parser stops after the first one that it consumes as statement separator.
+    auto suffix_begin = std::lower_bound(separators.begin(), separators.end(), reused->previous_suffix_begin,
+                                         [](auto& separator, size_t id) { return separator.symbol_id < id; });
+    std::vector<uint32_t> symbol_limits;
+    symbol_limits.reserve(separators.end() - suffix_begin);
+    for (auto iter = suffix_begin; iter != separators.end(); ++iter) {
+        symbol_limits.push_back(iter->symbol_id + symbol_shift + 1);
+    }
+
+    ParseContext ctx{*scanned};
+
+    // Copy a node of the previous script.
+    // Names are registered again since the name ids of the scans differ.
+    auto reuse_node = [&](const buffers::parser::Node& node, int64_t node_shift, int64_t node_symbol_shift) {
+        auto loc = buffers::parser::SymbolSpan(node.symbol_span().offset() + node_symbol_shift,
+                                               node.symbol_span().length());
+        auto parent = node.parent() == NO_PARENT ? NO_PARENT : static_cast<uint32_t>(node.parent() + node_shift);
+        auto value = node.children_begin_or_value();
+        if (node.node_type() == buffers::parser::NodeType::ARRAY ||
+            static_cast<uint16_t>(node.node_type()) > static_cast<uint16_t>(buffers::parser::NodeType::OBJECT_KEYS_)) {
+            value += node_shift;
+        } else if (node.node_type() == buffers::parser::NodeType::NAME) {
+            auto kind = loc.length() == 1 ? scanned->symbols[loc.offset()].kind() : symbol_kind::S_YYUNDEF;
+            auto keyword = Keyword::GetKeywordName(kind);
+            if (kind == symbol_kind::S_IDENT) {
+                value = scanned->symbols[loc.offset()].value.as<size_t>();
+            } else if (!keyword.empty()) {
+                value = ctx.NameFromKeyword(loc, keyword).children_begin_or_value();
+            } else if (kind != symbol_kind::S_YYUNDEF) {
+                value = ctx.NameFromStringLiteral(loc).children_begin_or_value();
+            } else {
+                auto text = scanned->name_pool.AllocateCopy(prev_scanned.name_registry.At(value).text);
+                value = ctx.NameFromKeyword(loc, text).children_begin_or_value();
+            }
+        }
+        return buffers::parser::Node(loc, node.node_type(), node.attribute_key(), parent, value,
+                                     node.children_count());
+    };
+
+    // Reuse the statements before the reparsed region
+    for (size_t i = 0; i < prefix.nodes_begin; ++i) {
+        ctx.nodes.PushBack(reuse_node(previous.nodes[i], 0, 0));
+    }
+    ctx.statements.insert(ctx.statements.end(), previous.statements.begin(),
+                          previous.statements.begin() + prefix.statements_begin);
+    ctx.errors.insert(ctx.errors.end(), previous.errors.begin(), previous.errors.begin() + prefix.errors_begin);
+    ctx.vis_spec_spans.insert(ctx.vis_spec_spans.end(), previous.vis_spec_spans.begin(),
+                              previous.vis_spec_spans.begin() + prefix.vis_spec_spans_begin);
+    ctx.statement_separators.insert(ctx.statement_separators.end(), separators.begin(), prefix_end);
+    ctx.ResetStatement();
+    size_t reused_statements = ctx.statements.size();
+
+    // Reparse the region
+    ctx.RewindScanner(scanned->symbols.GetIteratorAt(region_begin), region_begin);
+    if (!symbol_limits.empty()) {
+        ctx.symbol_limit = symbol_limits.front();
+        ctx.symbol_limit_candidates = std::span<const uint32_t>{symbol_limits}.subspan(1);
+    }
+    dashql::parser::Parser parser(ctx);
+    parser.parse();
+
+    // Reuse the statements after the reparsed region, if the parser stopped at a separator
+    if (ctx.next_token_index == ctx.symbol_limit) {
+        auto suffix = std::lower_bound(separators.begin(), separators.end(), ctx.symbol_limit - 1 - symbol_shift,
+                                       [](auto& separator, size_t id) { return separator.symbol_id < id; });
+        assert(suffix != separators.end());
+        int64_t node_shift = static_cast<int64_t>(ctx.nodes.GetSize()) - suffix->nodes_begin;
+        int64_t statement_shift = static_cast<int64_t>(ctx.statements.size()) - suffix->statements_begin;
+        int64_t error_shift = static_cast<int64_t>(ctx.errors.size()) - suffix->errors_begin;
+        int64_t vis_spec_span_shift = static_cast<int64_t>(ctx.vis_spec_spans.size()) - suffix->vis_spec_spans_begin;
+        for (size_t i = suffix->nodes_begin; i < previous.nodes.size(); ++i) {
+            ctx.nodes.PushBack(reuse_node(previous.nodes[i], node_shift, symbol_shift));
+        }
+        for (size_t i = suffix->statements_begin; i < previous.statements.size(); ++i) {
+            auto statement = previous.statements[i];
+            statement.root += node_shift;
+            statement.nodes_begin += node_shift;
+            ctx.statements.push_back(statement);
+        }
+        for (size_t i = suffix->errors_begin; i < previous.errors.size(); ++i) {
+            auto error = previous.errors[i];
+            error.location =
+                buffers::parser::SymbolSpan(error.location.offset() + symbol_shift, error.location.length());
+            ctx.errors.push_back(std::move(error));
+        }
+        for (size_t i = suffix->vis_spec_spans_begin; i < previous.vis_spec_spans.size(); ++i) {
+            auto [begin, end] = previous.vis_spec_spans[i];
+            ctx.vis_spec_spans.emplace_back(begin + symbol_shift, end + symbol_shift);
+        }
+        for (auto iter = std::next(suffix); iter != separators.end(); ++iter) {
+            auto separator = *iter;
+            separator.symbol_id += symbol_shift;
+            separator.nodes_begin += node_shift;
+            separator.statements_begin += statement_shift;
+            separator.errors_begin += error_shift;
+            separator.vis_spec_spans_begin += vis_spec_span_shift;
+            ctx.statement_separators.push_back(separator);
+        }
+        reused_statements += previous.statements.size() - suffix->statements_begin;
+    }
+
+    // Pack the program
+    auto parsed = std::make_shared<ParsedScript>(scanned, std::move(ctx));
+    parsed->reused_statements = reused_statements;
+    return parsed;
+}
+
 }  // namespace dashql::parser
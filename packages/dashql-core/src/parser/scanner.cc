@@ -1,7 +1,9 @@
 #include "dashql/parser/scanner.h"
 
+#include <algorithm>
 #include <charconv>
 #include <deque>
+#include <optional>
 
 #include "dashql/buffers/index_generated.h"
 #include "dashql/exception.h"
@@ -51,15 +53,12 @@ Parser::symbol_type Scanner::ReadInteger(buffers::parser::SymbolSpan loc) {
 /// Read an unquoted identifier
 Parser::symbol_type Scanner::ReadIdentifier(buffers::parser::SymbolSpan loc) {
     auto text = GetInputData().substr(loc.offset(), loc.length());
-    // Convert to lower-case
-    temp_buffer = text;
-    bool all_lower = true;
-    for (size_t i = 0; i < temp_buffer.size(); ++i) {
-        temp_buffer[i] = tolower_fuzzy(temp_buffer[i]);
-        all_lower &= temp_buffer[i] == text[i];
-    }
+    // Convert to lower-case, lower-case identifiers are looked up in the input directly
+    temp_buffer.resize(text.size());
+    bool all_lower = fold_lower_fuzzy(text, temp_buffer.data());
+    std::string_view folded = all_lower ? text : std::string_view{temp_buffer};
     // Check if it's a keyword
-    if (auto k = Keyword::Find(temp_buffer); !!k) {
+    if (auto k = Keyword::Find(folded); !!k) {
         if (k->category == KeywordCategory::VIS_UNRESERVED) {
             output->name_registry.Register(k->name, buffers::parser::TextSpan(loc.offset(), loc.length()));
         }
@@ -68,7 +67,7 @@ Parser::symbol_type Scanner::ReadIdentifier(buffers::parser::SymbolSpan loc) {
     // Add string to dictionary
     std::string_view owned = text;
     if (!all_lower) {
-        owned = output->name_pool.AllocateCopy(temp_buffer);
+        owned = output->name_pool.AllocateCopy(folded);
     }
     size_t id = output->name_registry.Register(owned, buffers::parser::TextSpan(loc.offset(), loc.length())).name_id;
     return Parser::make_IDENT(id, loc);
@@ -111,101 +110,119 @@ Parser::symbol_type Scanner::ReadBitStringLiteral(buffers::parser::SymbolSpan lo
     return Parser::make_BCONST(sx::parser::SymbolSpan(loc.offset(), trimmed.size()));
 }
 
-/// Scan input and produce all tokens
-std::shared_ptr<ScannedScript> Scanner::Scan(const rope::Rope& text, TextVersion text_version,
-                                             CatalogEntryID external_id) {
-    // Function to get next token
-    auto next = [](void* scanner_state_ptr, std::deque<Parser::symbol_type>& lookahead_symbols) {
-        // Have lookahead?
-        Parser::symbol_type current_symbol;
-        if (!lookahead_symbols.empty()) {
-            current_symbol.move(lookahead_symbols.front());
-            lookahead_symbols.pop_front();
-        } else {
-            auto t = dashql_yylex(scanner_state_ptr);
-            current_symbol.move(t);
-        }
+namespace {
 
-        // Requires additional lookahead?
-        switch (current_symbol.kind()) {
-            case Parser::symbol_kind::S_NOT:
-            case Parser::symbol_kind::S_NULLS_P:
-            case Parser::symbol_kind::S_WITH:
-            case Parser::symbol_kind::S_VISUALISE:
-            case Parser::symbol_kind::S_VISUALIZE:
-                break;
-            default:
-                return current_symbol;
-        }
+/// Read the next symbol and rewrite symbols that require additional lookahead
+Parser::symbol_type ReadNextSymbol(void* scanner_state_ptr, std::deque<Parser::symbol_type>& lookahead_symbols) {
+    // Have lookahead?
+    Parser::symbol_type current_symbol;
+    if (!lookahead_symbols.empty()) {
+        current_symbol.move(lookahead_symbols.front());
+        lookahead_symbols.pop_front();
+    } else {
+        auto t = dashql_yylex(scanner_state_ptr);
+        current_symbol.move(t);
+    }
 
-        // Get next token
-        auto next_symbol = dashql_yylex(scanner_state_ptr);
-        auto next_symbol_kind = next_symbol.kind();
-        lookahead_symbols.push_back(std::move(next_symbol));
-
-        // Should replace current token?
-        switch (current_symbol.kind()) {
-            case Parser::symbol_kind::S_NOT:
-                // Replace NOT by NOT_LA if it's followed by BETWEEN, IN, etc
-                switch (next_symbol_kind) {
-                    case Parser::symbol_kind::S_BETWEEN:
-                    case Parser::symbol_kind::S_IN_P:
-                    case Parser::symbol_kind::S_LIKE:
-                    case Parser::symbol_kind::S_ILIKE:
-                    case Parser::symbol_kind::S_SIMILAR:
-                        return Parser::make_NOT_LA(current_symbol.location);
-                    default:
-                        break;
-                }
-                break;
+    // Requires additional lookahead?
+    switch (current_symbol.kind()) {
+        case Parser::symbol_kind::S_NOT:
+        case Parser::symbol_kind::S_NULLS_P:
+        case Parser::symbol_kind::S_WITH:
+        case Parser::symbol_kind::S_VISUALISE:
+        case Parser::symbol_kind::S_VISUALIZE:
+            break;
+        default:
+            return current_symbol;
+    }
 
-            case Parser::symbol_kind::S_NULLS_P:
-                // Replace NULLS_P by NULLS_LA if it's followed by FIRST or LAST
-                switch (next_symbol_kind) {
-                    case Parser::symbol_kind::S_FIRST_P:
-                    case Parser::symbol_kind::S_LAST_P:
-                        return Parser::make_NULLS_LA(current_symbol.location);
-                    default:
-                        break;
-                }
-                break;
-            case Parser::symbol_kind::S_WITH:
-                // Replace WITH by WITH_LA if it's followed by TIME or ORDINALITY
-                switch (next_symbol_kind) {
-                    case Parser::symbol_kind::S_TIME:
-                    case Parser::symbol_kind::S_ORDINALITY:
-                        return Parser::make_WITH_LA(current_symbol.location);
-                    default:
-                        break;
-                }
-                break;
-            case Parser::symbol_kind::S_VISUALISE:
-            case Parser::symbol_kind::S_VISUALIZE:
-                if (next_symbol_kind == Parser::symbol_kind::S_USING) {
-                    auto renderer = dashql_yylex(scanner_state_ptr);
-                    auto renderer_kind = renderer.kind();
-                    lookahead_symbols.push_back(std::move(renderer));
-                    if (renderer_kind == Parser::symbol_kind::S_VEGALITE ||
-                        renderer_kind == Parser::symbol_kind::S_UMAP) {
-                        auto text = current_symbol.kind() == Parser::symbol_kind::S_VISUALISE
-                                        ? std::string_view{"visualise"}
-                                        : std::string_view{"visualize"};
-                        return Parser::make_VISUALIZE_LA(text, current_symbol.location);
-                    }
+    // Get next token
+    auto next_symbol = dashql_yylex(scanner_state_ptr);
+    auto next_symbol_kind = next_symbol.kind();
+    lookahead_symbols.push_back(std::move(next_symbol));
+
+    // Should replace current token?
+    switch (current_symbol.kind()) {
+        case Parser::symbol_kind::S_NOT:
+            // Replace NOT by NOT_LA if it's followed by BETWEEN, IN, etc
+            switch (next_symbol_kind) {
+                case Parser::symbol_kind::S_BETWEEN:
+                case Parser::symbol_kind::S_IN_P:
+                case Parser::symbol_kind::S_LIKE:
+                case Parser::symbol_kind::S_ILIKE:
+                case Parser::symbol_kind::S_SIMILAR:
+                    return Parser::make_NOT_LA(current_symbol.location);
+                default:
+                    break;
+            }
+            break;
+
+        case Parser::symbol_kind::S_NULLS_P:
+            // Replace NULLS_P by NULLS_LA if it's followed by FIRST or LAST
+            switch (next_symbol_kind) {
+                case Parser::symbol_kind::S_FIRST_P:
+                case Parser::symbol_kind::S_LAST_P:
+                    return Parser::make_NULLS_LA(current_symbol.location);
+                default:
+                    break;
+            }
+            break;
+        case Parser::symbol_kind::S_WITH:
+            // Replace WITH by WITH_LA if it's followed by TIME or ORDINALITY
+            switch (next_symbol_kind) {
+                case Parser::symbol_kind::S_TIME:
+                case Parser::symbol_kind::S_ORDINALITY:
+                    return Parser::make_WITH_LA(current_symbol.location);
+                default:
+                    break;
+            }
+            break;
+        case Parser::symbol_kind::S_VISUALISE:
+        case Parser::symbol_kind::S_VISUALIZE:
+            if (next_symbol_kind == Parser::symbol_kind::S_USING) {
+                auto renderer = dashql_yylex(scanner_state_ptr);
+                auto renderer_kind = renderer.kind();
+                lookahead_symbols.push_back(std::move(renderer));
+                if (renderer_kind == Parser::symbol_kind::S_VEGALITE ||
+                    renderer_kind == Parser::symbol_kind::S_UMAP) {
+                    auto text = current_symbol.kind() == Parser::symbol_kind::S_VISUALISE
+                                    ? std::string_view{"visualise"}
+                                    : std::string_view{"visualize"};
+                    return Parser::make_VISUALIZE_LA(text, current_symbol.location);
                 }
-                break;
-            default:
-                break;
+            }
+            break;
+        default:
+            break;
+    }
+    return current_symbol;
+}
+
+/// Is a symbol a keyword that is registered as name by the scanner?
+bool IsKeywordRegisteredAsName(Parser::symbol_kind_type kind) {
+    static const std::vector<bool> registered_keywords = []() {
+        std::vector<bool> registered(Parser::symbol_kind::YYNTOKENS, false);
+        for (auto& keyword : Keyword::GetKeywords()) {
+            if (keyword.category == KeywordCategory::VIS_UNRESERVED) {
+                registered[keyword.parser_symbol] = true;
+            }
         }
-        return current_symbol;
-    };
+        return registered;
+    }();
+    return kind >= 0 && static_cast<size_t>(kind) < registered_keywords.size() && registered_keywords[kind];
+}
 
+}  // namespace
+
+/// Scan input and produce all tokens
+std::shared_ptr<ScannedScript> Scanner::Scan(const rope::Rope& text, TextVersion text_version,
+                                             CatalogEntryID external_id, std::shared_ptr<ArenaBlockPool> block_pool) {
     // Create the scanner
-    Scanner scanner{text, text_version, external_id};
+    Scanner scanner{text, text_version, external_id, std::move(block_pool)};
     // Collect all tokens until we hit EOF
     std::deque<Parser::symbol_type> lookahead_symbols;
     while (true) {
-        auto token = next(scanner.scanner_state_ptr, lookahead_symbols);
+        auto token = ReadNextSymbol(scanner.scanner_state_ptr, lookahead_symbols);
         scanner.output->symbols.PushBack(token);
         if (token.kind() == Parser::symbol_kind::S_YYEOF) break;
     }
@@ -214,5 +231,191 @@ std::shared_ptr<ScannedScript> Scanner::Scan(const rope::Rope& text, TextVersion
     return std::move(scanner.output);
 }
 
+/// Rescan the edited region of a previously scanned script
+std::shared_ptr<ScannedScript> Scanner::Scan(const ScannedScript& previous, const TextEdit& edit,
+                                             const rope::Rope& text, TextVersion text_version,
+                                             CatalogEntryID external_id) {
+    Scanner scanner{text, text_version, external_id, previous.arena.GetBlockPool()};
+    auto& output = *scanner.output;
+    auto& prev_symbols = previous.symbols;
+    // Most names survive an edit, size the name map like the previous one
+    output.name_registry.names_by_text.reserve(previous.name_registry.names_by_text.size());
+    size_t prev_symbol_count = prev_symbols.GetSize();
+    int64_t shift = static_cast<int64_t>(edit.new_length) - static_cast<int64_t>(edit.old_length);
+
+    // Only splice if the edit describes the transition between the two texts.
+    // Otherwise, we fall back to scanning the entire input.
+    bool splice = prev_symbol_count > 0 &&
+                  prev_symbols[prev_symbol_count - 1].kind() == Parser::symbol_kind::S_YYEOF &&
+                  edit.offset + edit.old_length <= previous.GetInput().size() &&
+                  static_cast<int64_t>(previous.GetInput().size()) + shift ==
+                      static_cast<int64_t>(output.GetInput().size());
+
+    // Find the restart point.
+    // We restart after the last semicolon that ends strictly before the edit.
+    // Lookahead rewrites never cross a semicolon, and the scanner is always in its initial state after it.
+    size_t reused_prefix = 0;
+    size_t restart_offset = 0;
+    if (splice) {
+        // Count the symbols that end before the edit
+        size_t lb = 0, ub = prev_symbol_count - 1;
+        while (lb < ub) {
+            size_t mid = lb + (ub - lb) / 2;
+            auto& loc = prev_symbols[mid].location;
+            if ((loc.offset() + loc.length()) < edit.offset) {
+                lb = mid + 1;
+            } else {
+                ub = mid;
+            }
+        }
+        for (size_t i = lb; i > 0; --i) {
+            auto& symbol = prev_symbols[i - 1];
+            if (symbol.kind() == Parser::symbol_kind::S_SEMICOLON) {
+                reused_prefix = i;
+                restart_offset = symbol.location.offset() + symbol.location.length();
+                break;
+            }
+        }
+    }
+
+    // Get the text of a reused name.
+    // Names that point into unchanged text of the previous buffer are redirected to the new buffer.
+    auto* prev_text = previous.text_buffer.data();
+    auto reuse_name_text = [&](std::string_view name) -> std::string_view {
+        if (name.data() >= prev_text && (name.data() + name.size()) <= (prev_text + previous.text_buffer.size())) {
+            size_t name_offset = name.data() - prev_text;
+            if ((name_offset + name.size()) <= edit.offset) {
+                return {output.text_buffer.data() + name_offset, name.size()};
+            }
+            if (name_offset >= (edit.offset + edit.old_length)) {
+                return {output.text_buffer.data() + name_offset + shift, name.size()};
+            }
+        }
+        return output.name_pool.AllocateCopy(name);
+    };
+    // Copy a symbol of the previous script.
+    // Names are registered again in symbol order to get the same name ids as a full scan.
+    auto reuse_symbol = [&](const Parser::symbol_type& prev_symbol, int64_t offset_shift) {
+        auto& symbol = output.symbols.PushBack(prev_symbol);
+        symbol.location =
+            buffers::parser::SymbolSpan(prev_symbol.location.offset() + offset_shift, prev_symbol.location.length());
+        buffers::parser::TextSpan name_loc{symbol.location.offset(), symbol.location.length()};
+        if (symbol.kind() == Parser::symbol_kind::S_IDENT) {
+            auto& prev_name = previous.name_registry.At(prev_symbol.value.as<size_t>());
+            auto existing = output.name_registry.names_by_text.find(prev_name.text);
+            auto name_text =
+                existing != output.name_registry.names_by_text.end() ? existing->first : reuse_name_text(prev_name.text);
+            symbol.value.as<size_t>() = output.name_registry.Register(name_text, name_loc).name_id;
+        } else if (IsKeywordRegisteredAsName(symbol.kind())) {
+            output.name_registry.Register(Keyword::GetKeywordName(symbol.kind()), name_loc);
+        }
+    };
+
+    // Reuse the prefix
+    for (size_t i = 0; i < reused_prefix; ++i) {
+        reuse_symbol(prev_symbols[i], 0);
+    }
+    for (auto& snapshot : previous.lalr_snapshots) {
+        if (snapshot.symbol_id > reused_prefix) break;
+        output.lalr_snapshots.push_back(snapshot);
+    }
+    auto prefix_line_breaks = std::lower_bound(
+        previous.line_breaks.begin(), previous.line_breaks.end(), restart_offset,
+        [](const buffers::parser::TextSpan& span, size_t offset) { return span.offset() < offset; });
+    auto prefix_comments =
+        std::lower_bound(previous.comments.begin(), previous.comments.end(), restart_offset,
+                         [](const buffers::parser::TextSpan& span, size_t offset) { return span.offset() < offset; });
+    output.line_breaks.insert(output.line_breaks.end(), previous.line_breaks.begin(), prefix_line_breaks);
+    output.comments.insert(output.comments.end(), previous.comments.begin(), prefix_comments);
+    for (auto& [loc, message] : previous.errors) {
+        if (loc.offset() < restart_offset) {
+            output.errors.emplace_back(loc, message);
+        }
+    }
+
+    // Rescan until the symbol stream resynchronizes with the previous symbols after the edit.
+    // Resynchronizing at a symbol with the same kind and length at the shifted offset is safe since the scanner
+    // starts every symbol in its initial state and the remaining text is identical.
+    scanner.SeekTo(restart_offset);
+    size_t edit_end = edit.offset + edit.new_length;
+    size_t prev_symbol_id = reused_prefix;
+    std::optional<size_t> resync_symbol;
+    std::optional<size_t> resync_offset;
+    std::deque<Parser::symbol_type> lookahead_symbols;
+    while (true) {
+        auto token = ReadNextSymbol(scanner.scanner_state_ptr, lookahead_symbols);
+        if (token.kind() == Parser::symbol_kind::S_YYEOF) {
+            output.symbols.PushBack(token);
+            break;
+        }
+        if (splice && lookahead_symbols.empty() && token.location.offset() >= edit_end) {
+            size_t prev_offset = token.location.offset() - shift;
+            while (prev_symbol_id < prev_symbol_count && prev_symbols[prev_symbol_id].location.offset() < prev_offset) {
+                ++prev_symbol_id;
+            }
+            if (prev_symbol_id < prev_symbol_count) {
+                auto& prev_symbol = prev_symbols[prev_symbol_id];
+                if (prev_symbol.kind() == token.kind() && prev_symbol.location.offset() == prev_offset &&
+                    prev_symbol.location.length() == token.location.length()) {
+                    resync_symbol = prev_symbol_id;
+                    resync_offset = token.location.offset();
+                    break;
+                }
+            }
+        }
+        output.symbols.PushBack(token);
+    }
+    if (!resync_symbol.has_value()) {
+        if (splice) {
+            output.reused_symbols = ScannedScript::ReusedSymbols{
+                .previous_text_version = previous.text_version,
+                .prefix_count = reused_prefix,
+                .previous_suffix_begin = prev_symbol_count,
+                .suffix_begin = output.symbols.GetSize(),
+            };
+        }
+        return std::move(scanner.output);
+    }
+
+    // Drop everything the scanner produced for the resynchronized symbol, the previous script has it already
+    auto is_resynced = [&](const buffers::parser::TextSpan& span) { return span.offset() >= *resync_offset; };
+    std::erase_if(output.line_breaks, is_resynced);
+    std::erase_if(output.comments, is_resynced);
+    std::erase_if(output.errors, [&](auto& error) { return is_resynced(error.first); });
+
+    // Splice the suffix with shifted offsets
+    size_t prev_resync_offset = *resync_offset - shift;
+    output.reused_symbols = ScannedScript::ReusedSymbols{
+        .previous_text_version = previous.text_version,
+        .prefix_count = reused_prefix,
+        .previous_suffix_begin = *resync_symbol,
+        .suffix_begin = output.symbols.GetSize(),
+    };
+    for (size_t i = *resync_symbol; i < prev_symbol_count; ++i) {
+        reuse_symbol(prev_symbols[i], shift);
+    }
+    auto shift_span = [&](const buffers::parser::TextSpan& span) {
+        return buffers::parser::TextSpan(span.offset() + shift, span.length());
+    };
+    auto suffix_line_breaks = std::lower_bound(
+        previous.line_breaks.begin(), previous.line_breaks.end(), prev_resync_offset,
+        [](const buffers::parser::TextSpan& span, size_t offset) { return span.offset() < offset; });
+    for (auto i = suffix_line_breaks; i != previous.line_breaks.end(); ++i) {
+        output.line_breaks.push_back(shift_span(*i));
+    }
+    auto suffix_comments =
+        std::lower_bound(previous.comments.begin(), previous.comments.end(), prev_resync_offset,
+                         [](const buffers::parser::TextSpan& span, size_t offset) { return span.offset() < offset; });
+    for (auto i = suffix_comments; i != previous.comments.end(); ++i) {
+        output.comments.push_back(shift_span(*i));
+    }
+    for (auto& [loc, message] : previous.errors) {
+        if (loc.offset() >= prev_resync_offset) {
+            output.errors.emplace_back(shift_span(loc), message);
+        }
+    }
+    return std::move(scanner.output);
+}
+
 }  // namespace parser
 }  // namespace dashql
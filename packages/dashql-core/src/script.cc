@@ -6,9 +6,18 @@
 #include <chrono>
 #include <memory>
 #include <optional>
+#include <span>
 #include <unordered_set>
 #include <variant>
 
+#ifndef WASM
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#endif
+
 #include "dashql/analyzer/analyzer.h"
 #include "dashql/analyzer/completion.h"
 #include "dashql/buffers/index_generated.h"
@@ -20,6 +29,7 @@
 #include "dashql/parser/parser.h"
 #include "dashql/parser/scanner.h"
 #include "dashql/script_compiler.h"
+#include "dashql/script_diff.h"
 #include "dashql/visualize/vegalite.h"
 
 namespace dashql {
@@ -27,6 +37,29 @@ namespace dashql {
 /// Helper template for static_assert in generic visitor
 template <typename T> constexpr bool always_false = false;
 
+/// Merge a subsequent edit
+void TextEdit::Merge(size_t edit_offset, size_t removed, size_t inserted) {
+    if (IsEmpty()) {
+        offset = edit_offset;
+        old_length = removed;
+        new_length = inserted;
+        return;
+    }
+    // The end of the edited range in the current text.
+    // Everything after it is still identical to the scanned text.
+    size_t current_end = offset + new_length;
+    size_t edit_end = edit_offset + removed;
+    size_t old_end = offset + old_length;
+    if (edit_end > current_end) {
+        old_end += edit_end - current_end;
+        current_end = edit_end;
+    }
+    size_t begin = std::min(offset, edit_offset);
+    offset = begin;
+    old_length = old_end - begin;
+    new_length = current_end + inserted - removed - begin;
+}
+
 /// Finish a statement
 std::unique_ptr<buffers::parser::StatementT> ParsedScript::Statement::Pack() const {
     auto stmt = std::make_unique<buffers::parser::StatementT>();
@@ -38,11 +71,25 @@ std::unique_ptr<buffers::parser::StatementT> ParsedScript::Statement::Pack() con
 }
 
 /// Constructor
-ScannedScript::ScannedScript(const rope::Rope& text, TextVersion text_version, CatalogEntryID external_id)
-    : external_id(external_id), text_buffer(text.ToString(true)), text_version(text_version) {}
+ScannedScript::ScannedScript(const rope::Rope& text, TextVersion text_version, CatalogEntryID external_id,
+                             std::shared_ptr<ArenaBlockPool> block_pool)
+    : external_id(external_id),
+      text_buffer(text.ToString(true)),
+      text_version(text_version),
+      arena(Arena::DEFAULT_BLOCK_SIZE, std::move(block_pool)),
+      name_pool(&arena),
+      name_registry(&arena),
+      symbols(&arena) {}
 /// Constructor
-ScannedScript::ScannedScript(std::string text, TextVersion text_version, CatalogEntryID external_id)
-    : external_id(external_id), text_buffer(std::move(text)), text_version(text_version) {
+ScannedScript::ScannedScript(std::string text, TextVersion text_version, CatalogEntryID external_id,
+                             std::shared_ptr<ArenaBlockPool> block_pool)
+    : external_id(external_id),
+      text_buffer(std::move(text)),
+      text_version(text_version),
+      arena(Arena::DEFAULT_BLOCK_SIZE, std::move(block_pool)),
+      name_pool(&arena),
+      name_registry(&arena),
+      symbols(&arena) {
     if (text_buffer.size() < 2) {
         text_buffer.resize(2);
     }
@@ -110,13 +157,10 @@ ScannedScript::LocationInfo ScannedScript::FindSymbol(size_t text_offset) {
 
     // Find chunk that contains the text offset.
     // Chunks grow exponentially in size, so this is logarithmic in cost
-    auto chunk_iter = chunks.begin();
-    for (; chunk_iter != chunks.end(); ++chunk_iter) {
-        size_t text_from = chunk_iter->front().location.offset();
-        if (text_from > text_offset) {
-            break;
-        }
-    }
+    // Symbols are sorted by their text offset, so the first symbols of the chunks form a sparse offset index.
+    auto chunk_iter = std::upper_bound(chunks.begin(), chunks.end(), text_offset, [](size_t ofs, const auto& chunk) {
+        return ofs < chunk.front().location.offset();
+    });
 
     // Get previous chunk
     if (chunk_iter > chunks.begin()) {
@@ -217,8 +261,13 @@ ParsedScript::ParsedScript(std::shared_ptr<ScannedScript> scan, parser::ParseCon
       nodes(ctx.nodes.Flatten()),
       statements(std::move(ctx.statements)),
       errors(std::move(ctx.errors)),
-      vis_spec_spans(std::move(ctx.vis_spec_spans)) {
-    for (const auto& node : nodes) {
+      vis_spec_spans(std::move(ctx.vis_spec_spans)),
+      statement_separators(std::move(ctx.statement_separators)),
+      parser_arena_allocations(ctx.arena.GetAllocationCount()),
+      parser_arena_blocks(ctx.arena.GetBlockCount()) {
+    location_ordered_children.resize(nodes.size(), false);
+    for (size_t node_id = 0; node_id < nodes.size(); ++node_id) {
+        auto& node = nodes[node_id];
         switch (node.node_type()) {
             case buffers::parser::NodeType::OBJECT_VIS_VISUALISE:
                 feature_flags |= static_cast<uint32_t>(buffers::parser::ParsedScriptFeature::VISUALIZE);
@@ -226,9 +275,22 @@ ParsedScript::ParsedScript(std::shared_ptr<ScannedScript> scan, parser::ParseCon
             default:
                 break;
         }
+        // Arrays list their elements in source order, attributes of objects may overlap.
+        // Disjoint symbol spans also resolve to disjoint text spans, so we can check the symbol spans.
+        if (node.children_count() >= 2) {
+            bool ordered = true;
+            uint32_t previous_end = 0;
+            for (size_t i = 0; i < node.children_count() && ordered; ++i) {
+                auto loc = nodes[node.children_begin_or_value() + i].symbol_span();
+                ordered = loc.offset() >= previous_end;
+                previous_end = loc.offset() + loc.length();
+            }
+            location_ordered_children[node_id] = ordered;
+        }
     }
     assert(std::is_sorted(statements.begin(), statements.end(),
                           [](auto& l, auto& r) { return l.nodes_begin < r.nodes_begin; }));
+    ScriptDiff::ComputeSubtreeHashes(*this, subtree_hashes);
 }
 
 std::unique_ptr<buffers::parser::StatementT> ParsedScript::PackStatement(size_t statement_id) const {
@@ -464,14 +526,11 @@ std::optional<std::pair<size_t, size_t>> ParsedScript::FindNodeAtOffset(size_t t
     }
     auto& scan = *scanned_script;
     // Find statement that includes the text offset by searching the predecessor of the first statement after the text
-    // offset
-    size_t statement_id = 0;
-    for (; statement_id < statements.size(); ++statement_id) {
-        auto ts = scan.ResolveTextSpan(nodes[statements[statement_id].root].symbol_span());
-        if (ts.offset() > text_offset) {
-            break;
-        }
-    }
+    // offset. Statements are ordered by their text offset, so we binary search the statement roots.
+    auto statement_iter = std::partition_point(statements.begin(), statements.end(), [&](const Statement& statement) {
+        return scan.ResolveTextSpan(nodes[statement.root].symbol_span()).offset() <= text_offset;
+    });
+    size_t statement_id = statement_iter - statements.begin();
     // First statement and begins > text_offset, bail out
     if (statement_id == 0) {
         return std::nullopt;
@@ -486,11 +545,9 @@ std::optional<std::pair<size_t, size_t>> ParsedScript::FindNodeAtOffset(size_t t
             break;
         }
         // Otherwise find the first child that includes the offset
-        // Children are not ordered by location but ideally, there should only be a single match.
         std::optional<size_t> child_exact;
         std::optional<size_t> child_end_plus_1;
-        for (size_t i = 0; i < node.children_count(); ++i) {
-            auto ci = node.children_begin_or_value() + i;
+        auto check_child = [&](size_t ci) {
             auto ts = scan.ResolveTextSpan(nodes[ci].symbol_span());
             auto node_begin = ts.offset();
             auto node_end = node_begin + ts.length();
@@ -505,6 +562,22 @@ std::optional<std::pair<size_t, size_t>> ParsedScript::FindNodeAtOffset(size_t t
                     child_end_plus_1 = ci;
                 }
             }
+        };
+        auto children_begin = node.children_begin_or_value();
+        if (location_ordered_children[iter]) {
+            // The children are ordered and disjoint, only the last child that begins before the offset can match
+            auto children = std::span{nodes}.subspan(children_begin, node.children_count());
+            auto child_iter = std::partition_point(children.begin(), children.end(), [&](auto& child) {
+                return scan.ResolveTextSpan(child.symbol_span()).offset() <= text_offset;
+            });
+            if (child_iter != children.begin()) {
+                check_child(children_begin + (child_iter - children.begin()) - 1);
+            }
+        } else {
+            // Children are not ordered by location but ideally, there should only be a single match.
+            for (size_t i = 0; i < node.children_count(); ++i) {
+                check_child(children_begin + i);
+            }
         }
         auto child = child_exact.has_value() ? child_exact : child_end_plus_1;
         if (!child.has_value()) {
@@ -836,7 +909,20 @@ flatbuffers::Offset<buffers::algebra::Expression> AnalyzedScript::Expression::Pa
 
 /// Constructor
 AnalyzedScript::AnalyzedScript(std::shared_ptr<ParsedScript> parsed, Catalog& catalog)
-    : CatalogEntry(catalog, parsed->external_id), parsed_script(std::move(parsed)), node_markers() {
+    : CatalogEntry(catalog, parsed->external_id),
+      parsed_script(std::move(parsed)),
+      node_markers(),
+      arena(Arena::DEFAULT_BLOCK_SIZE, parsed_script->scanned_script->arena.GetBlockPool()),
+      table_references(&arena),
+      insert_statements(&arena),
+      expressions(&arena),
+      function_arguments(&arena),
+      name_scopes(&arena),
+      name_scopes_by_root_node(decltype(name_scopes_by_root_node)::allocator_type{&arena}),
+      constant_expressions(&arena),
+      visualization_specs(&arena),
+      inference_constraints(&arena),
+      inferred_table_schemas(&arena) {
     assert(parsed_script != nullptr);
     node_markers.resize(parsed_script->GetNodes().size(), buffers::analyzer::SemanticNodeMarkerType::NONE);
 }
@@ -884,19 +970,16 @@ flatbuffers::Offset<buffers::catalog::CatalogEntry> AnalyzedScript::DescribeEntr
 }
 
 /// Get the name search index
-const CatalogEntry::NameSearchIndex& AnalyzedScript::GetNameSearchIndex() {
+const CatalogEntry::NameSearchIndex& AnalyzedScript::GetNameSearchIndex([[maybe_unused]] size_t index) {
+    assert(index == 0);
     if (!name_search_index.has_value()) {
-        auto& index = name_search_index.emplace();
-        auto& names = parsed_script->scanned_script->name_registry.GetChunks();
-        for (auto& names_chunk : names) {
-            for (auto& name : names_chunk) {
-                auto s = name.text;
-                for (size_t i = 1; i <= s.size(); ++i) {
-                    auto suffix = s.substr(s.size() - i);
-                    index.insert({{suffix.data(), suffix.size()}, name});
-                }
-            }
+        auto& registry = parsed_script->scanned_script->name_registry;
+        if (name_search_index_base && name_search_index_base->name_search_index.has_value()) {
+            name_search_index.emplace(registry, *name_search_index_base->name_search_index);
+        } else {
+            name_search_index.emplace(registry);
         }
+        name_search_index_base.reset();
     }
     return name_search_index.value();
 }
@@ -1247,29 +1330,53 @@ void AnalyzedScript::FollowPathUpwards(uint32_t ast_node_id, std::vector<uint32_
 
 Script::Script(Catalog& catalog) : catalog(catalog), catalog_entry_id(catalog.AllocateEntryId()), text(1024) {}
 
-Script::~Script() { catalog.DropScript(*this); }
+Script::~Script() {
+#ifndef WASM
+    // Join the worker before the catalog forgets about the script
+    background_analysis.reset();
+#endif
+    catalog.DropScript(*this);
+}
+
+/// Recycle the buffers of outdated versions?
+void Script::SetBufferRecycling(bool enabled) {
+    if (enabled == (arena_block_pool != nullptr)) {
+        return;
+    }
+    arena_block_pool = enabled ? std::make_shared<ArenaBlockPool>() : nullptr;
+    // Incremental scans inherit the block pool of the previous scan, the next scan has to be a full one
+    pending_scanner_edit.reset();
+}
 
 /// Insert a character at an offet
 void Script::InsertCharAt(size_t char_idx, uint32_t unicode) {
     std::array<std::byte, 6> buffer;
     auto length = dashql::utf8::utf8proc_encode_char(unicode, reinterpret_cast<uint8_t*>(buffer.data()));
     std::string_view encoded{reinterpret_cast<char*>(buffer.data()), static_cast<size_t>(length)};
-    text.Insert(char_idx, encoded);
-    ++text_version;
+    InsertTextAt(char_idx, encoded);
 }
 /// Insert a text at an offet
 void Script::InsertTextAt(size_t char_idx, std::string_view encoded) {
+    if (pending_scanner_edit.has_value()) {
+        pending_scanner_edit->Merge(text.ResolveCodepoint(char_idx), 0, encoded.size());
+    }
     text.Insert(char_idx, encoded);
     ++text_version;
 }
 /// Erase a text at an offet
 void Script::EraseTextRange(size_t char_idx, size_t count) {
+    if (pending_scanner_edit.has_value()) {
+        auto begin = text.ResolveCodepoint(char_idx);
+        auto end = text.ResolveCodepoint(char_idx + count);
+        pending_scanner_edit->Merge(begin, end - begin, 0);
+    }
     text.Remove(char_idx, count);
     ++text_version;
 }
 /// Replace the text in the script
 void Script::ReplaceText(std::string_view encoded) {
     text = rope::Rope{1024, encoded};
+    pending_scanner_edit.reset();
     ++text_version;
 }
 
@@ -1320,16 +1427,11 @@ std::unique_ptr<buffers::statistics::ScriptMemoryStatistics> Script::GetMemorySt
         if (!analyzed) return;
         // Added analyzed before?
         if (registered_analyzed.contains(analyzed)) return;
-        size_t table_column_bytes = 0;
-        for (auto& table_chunk : analyzed->table_declarations.GetChunks()) {
-            for (auto& table : table_chunk) {
-                table_column_bytes += table.table_columns.size() * sizeof(CatalogEntry::TableColumn);
-            }
-        }
         size_t analyzer_description_bytes =
             analyzed->database_references.GetSize() * sizeof(CatalogEntry::DatabaseReference) +
             analyzed->schema_references.GetSize() * sizeof(CatalogEntry::SchemaReference) +
-            analyzed->table_declarations.GetSize() * sizeof(CatalogEntry::TableDeclaration) + table_column_bytes +
+            analyzed->table_declarations.GetSize() * sizeof(CatalogEntry::TableDeclaration) +
+            analyzed->table_column_store.GetColumnByteSize() + analyzed->table_column_store.GetIndexByteSize() +
             analyzed->table_references.GetSize() * sizeof(decltype(analyzed->table_references)::value_type) +
             analyzed->expressions.GetSize() * sizeof(decltype(analyzed->expressions)::value_type) +
             analyzed->function_arguments.GetSize() * sizeof(decltype(analyzed->function_arguments)::value_type) +
@@ -1337,18 +1439,22 @@ std::unique_ptr<buffers::statistics::ScriptMemoryStatistics> Script::GetMemorySt
         size_t analyzer_name_index_bytes = 0;
         size_t analyzer_name_search_index_size = 0;
         if (auto& index = analyzed->name_search_index) {
-            analyzer_name_index_bytes = index->size() * index->average_bytes_per_value();
-            analyzer_name_search_index_size = index->size();
+            analyzer_name_index_bytes = index->GetByteSize();
+            analyzer_name_search_index_size = index->GetSize();
         }
         stats.mutate_analyzer_description_bytes(analyzer_description_bytes);
         stats.mutate_analyzer_name_index_size(analyzer_name_search_index_size);
         stats.mutate_analyzer_name_index_bytes(analyzer_name_index_bytes);
+        stats.mutate_analyzer_arena_allocations(analyzed->arena.GetAllocationCount());
+        stats.mutate_analyzer_arena_blocks(analyzed->arena.GetBlockCount());
 
         // Added parsed before?
         ParsedScript* parsed = analyzed->parsed_script.get();
         if (registered_parsed.contains(parsed)) return;
         size_t parser_ast_bytes = parsed->nodes.size() * sizeof(decltype(parsed->nodes)::value_type);
         stats.mutate_parser_ast_bytes(parser_ast_bytes);
+        stats.mutate_parser_arena_allocations(parsed->parser_arena_allocations);
+        stats.mutate_parser_arena_blocks(parsed->parser_arena_blocks);
 
         // Added scanned before?
         ScannedScript* scanned = parsed->scanned_script.get();
@@ -1358,6 +1464,8 @@ std::unique_ptr<buffers::statistics::ScriptMemoryStatistics> Script::GetMemorySt
         stats.mutate_scanner_input_bytes(scanned->GetInput().size());
         stats.mutate_scanner_symbol_bytes(scanner_symbol_bytes);
         stats.mutate_scanner_name_dictionary_bytes(scanner_dictionary_bytes);
+        stats.mutate_scanner_arena_allocations(scanned->arena.GetAllocationCount());
+        stats.mutate_scanner_arena_blocks(scanned->arena.GetBlockCount());
     };
     registerScript(analyzed_script.get(), memory->mutable_latest_script());
     return memory;
@@ -1373,7 +1481,15 @@ std::unique_ptr<buffers::statistics::ScriptStatisticsT> Script::GetStatistics()
 
 void Script::Scan() {
     auto time_before = std::chrono::steady_clock::now();
-    scanned_script = parser::Scanner::Scan(text, text_version, catalog_entry_id);  // throws on error
+    if (scanned_script != nullptr && pending_scanner_edit.has_value()) {
+        // Only rescan the edited region and splice the previous symbols
+        scanned_script = parser::Scanner::Scan(*scanned_script, *pending_scanner_edit, text, text_version,
+                                               catalog_entry_id);  // throws on error
+    } else {
+        scanned_script =
+            parser::Scanner::Scan(text, text_version, catalog_entry_id, arena_block_pool);  // throws on error
+    }
+    pending_scanner_edit.emplace();
     timing_statistics.mutate_scanner_last_elapsed(
         std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - time_before).count());
 }
@@ -1383,13 +1499,27 @@ void Script::Parse() {
         Scan();
     }
     auto time_before = std::chrono::steady_clock::now();
-    parsed_script = parser::Parser::Parse(scanned_script);
+    if (parsed_script != nullptr && parsed_script->scanned_script != scanned_script) {
+        // Only reparse the statements that were rescanned
+        parsed_script = parser::Parser::Parse(scanned_script, *parsed_script);
+    } else {
+        parsed_script = parser::Parser::Parse(scanned_script);
+    }
     timing_statistics.mutate_parser_last_elapsed(
         std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - time_before).count());
+    auto statement_count = parsed_script->statements.size();
+    timing_statistics.mutate_parser_last_reused_statements(
+        statement_count == 0 ? 0.0 : static_cast<double>(parsed_script->reused_statements) / statement_count);
 }
 
 /// Analyze a script
 void Script::Analyze(bool parse_if_outdated) {
+#ifndef WASM
+    // Don't race the worker for the catalog and the registered names
+    if (background_analysis) {
+        WaitForBackgroundAnalysis();  // throws on error
+    }
+#endif
     if (parse_if_outdated) {
         // Scan the script, if needed
         if (scanned_script == nullptr || scanned_script->text_version != text_version) {
@@ -1413,19 +1543,254 @@ void Script::Analyze(bool parse_if_outdated) {
     }
     // Analyze a script
     auto time_before_analyzing = std::chrono::steady_clock::now();
+    auto previous = analyzed_script;
     analyzed_script = Analyzer::Analyze(parsed_script, catalog);  // throws on error
+    // Derive the name search index from the latest built one
+    if (previous) {
+        if (previous->name_search_index.has_value()) {
+            analyzed_script->name_search_index_base = previous;
+        } else {
+            analyzed_script->name_search_index_base = previous->name_search_index_base;
+        }
+    }
     timing_statistics.mutate_analyzer_last_elapsed(
         std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - time_before_analyzing)
             .count());
 }
 
+#ifndef WASM
+/// The analysis of a script on a background thread
+struct Script::BackgroundAnalysis {
+    /// A snapshot of the script
+    struct Request {
+        /// The text
+        std::string text;
+        /// The text version
+        TextVersion text_version = 0;
+        /// The arena block pool
+        std::shared_ptr<ArenaBlockPool> arena_block_pool;
+    };
+    /// A finished analysis
+    struct Result {
+        /// The text version
+        TextVersion text_version = 0;
+        /// The scanned script
+        std::shared_ptr<ScannedScript> scanned_script;
+        /// The parsed script
+        std::shared_ptr<ParsedScript> parsed_script;
+        /// The analyzed script
+        std::shared_ptr<AnalyzedScript> analyzed_script;
+        /// The error, if the analysis failed
+        std::exception_ptr error;
+        /// The nanoseconds spent in the scanner
+        uint64_t scanner_elapsed = 0;
+        /// The nanoseconds spent in the parser
+        uint64_t parser_elapsed = 0;
+        /// The nanoseconds spent in the analyzer
+        uint64_t analyzer_elapsed = 0;
+    };
+
+    /// The catalog
+    Catalog& catalog;
+    /// The catalog entry id
+    const CatalogEntryID catalog_entry_id;
+    /// The latest requested text version, the worker checks it between the stages
+    std::atomic<TextVersion> latest_version{0};
+    /// Shut down the worker?
+    std::atomic<bool> shutdown{false};
+    /// The mutex guarding the request and the result
+    std::mutex mutex;
+    /// Signals new requests and finished analyses
+    std::condition_variable changed;
+    /// The pending request, if any
+    std::optional<Request> pending_request;
+    /// Is the worker analyzing a request?
+    bool running = false;
+    /// The latest finished analysis that was not adopted yet
+    std::optional<Result> finished;
+    /// The worker thread
+    std::thread worker;
+
+    /// Constructor, spawns the worker
+    BackgroundAnalysis(Catalog& catalog, CatalogEntryID catalog_entry_id)
+        : catalog(catalog), catalog_entry_id(catalog_entry_id), worker([this]() { Run(); }) {}
+    /// Destructor, cancels the running analysis and joins the worker
+    ~BackgroundAnalysis() {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            shutdown = true;
+        }
+        changed.notify_all();
+        worker.join();
+    }
+
+    /// Was the request outdated by a newer one?
+    bool IsCancelled(TextVersion version) const {
+        return shutdown.load(std::memory_order_relaxed) || latest_version.load(std::memory_order_relaxed) != version;
+    }
+    /// Submit a request, replaces a pending one that the worker did not pick up yet
+    void Submit(Request request) {
+        {
+            std::lock_guard<std::mutex> lock{mutex};
+            latest_version = request.text_version;
+            pending_request = std::move(request);
+        }
+        changed.notify_all();
+    }
+    /// Take the finished analysis
+    std::optional<Result> Take() {
+        std::lock_guard<std::mutex> lock{mutex};
+        std::optional<Result> result;
+        result.swap(finished);
+        return result;
+    }
+    /// Wait until the worker is idle and take the finished analysis
+    std::optional<Result> WaitAndTake() {
+        std::unique_lock<std::mutex> lock{mutex};
+        changed.wait(lock, [&]() { return !running && !pending_request.has_value(); });
+        std::optional<Result> result;
+        result.swap(finished);
+        return result;
+    }
+    /// Analyze a request, returns nothing if it was cancelled
+    std::optional<Result> Analyze(const Request& request) {
+        Result result{.text_version = request.text_version};
+        try {
+            auto time_before = std::chrono::steady_clock::now();
+            rope::Rope text{1024, request.text};
+            result.scanned_script = parser::Scanner::Scan(text, request.text_version, catalog_entry_id,
+                                                          request.arena_block_pool);  // throws on error
+            auto time_after_scanning = std::chrono::steady_clock::now();
+            result.scanner_elapsed =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(time_after_scanning - time_before).count();
+            if (IsCancelled(request.text_version)) {
+                return std::nullopt;
+            }
+            result.parsed_script = parser::Parser::Parse(result.scanned_script);  // throws on error
+            auto time_after_parsing = std::chrono::steady_clock::now();
+            result.parser_elapsed =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(time_after_parsing - time_after_scanning).count();
+            if (IsCancelled(request.text_version)) {
+                return std::nullopt;
+            }
+            result.analyzed_script = Analyzer::Analyze(result.parsed_script, catalog);  // throws on error
+            result.analyzer_elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                          std::chrono::steady_clock::now() - time_after_parsing)
+                                          .count();
+        } catch (...) {
+            result.error = std::current_exception();
+        }
+        return result;
+    }
+    /// Run the worker
+    void Run() {
+        std::unique_lock<std::mutex> lock{mutex};
+        while (true) {
+            changed.wait(lock, [&]() { return shutdown || pending_request.has_value(); });
+            if (shutdown) {
+                return;
+            }
+            auto request = std::move(*pending_request);
+            pending_request.reset();
+            running = true;
+            lock.unlock();
+            auto result = Analyze(request);
+            lock.lock();
+            running = false;
+            // A finished analysis is published even if a newer request arrived meanwhile.
+            // Continuous typing would otherwise starve the host of any analysis.
+            if (result.has_value() && (!finished.has_value() || finished->text_version <= result->text_version)) {
+                finished = std::move(result);
+            }
+            changed.notify_all();
+        }
+    }
+};
+
+/// Analyze a snapshot of the script on a background thread
+void Script::AnalyzeInBackground() {
+    if (!background_analysis) {
+        background_analysis = std::make_unique<BackgroundAnalysis>(catalog, catalog_entry_id);
+    }
+    background_analysis->Submit({
+        .text = text.ToString(),
+        .text_version = text_version,
+        .arena_block_pool = arena_block_pool,
+    });
+}
+
+/// Adopt a finished background analysis
+static std::optional<TextVersion> adoptBackgroundAnalysis(Script& script,
+                                                          std::optional<Script::BackgroundAnalysis::Result> result) {
+    if (!result.has_value()) {
+        return std::nullopt;
+    }
+    if (result->error) {
+        std::rethrow_exception(result->error);
+    }
+    // Never replace a newer synchronous analysis
+    if (script.scanned_script && script.scanned_script->text_version >= result->text_version) {
+        return std::nullopt;
+    }
+    auto previous = std::move(script.analyzed_script);
+    script.scanned_script = std::move(result->scanned_script);
+    script.parsed_script = std::move(result->parsed_script);
+    script.analyzed_script = std::move(result->analyzed_script);
+    // Derive the name search index from the latest built one
+    if (previous) {
+        if (previous->name_search_index.has_value()) {
+            script.analyzed_script->name_search_index_base = previous;
+        } else {
+            script.analyzed_script->name_search_index_base = previous->name_search_index_base;
+        }
+    }
+    // Edits since the snapshot were not tracked relative to the adopted scan
+    if (result->text_version == script.text_version) {
+        script.pending_scanner_edit.emplace();
+    } else {
+        script.pending_scanner_edit.reset();
+    }
+    script.timing_statistics.mutate_scanner_last_elapsed(result->scanner_elapsed);
+    script.timing_statistics.mutate_parser_last_elapsed(result->parser_elapsed);
+    script.timing_statistics.mutate_analyzer_last_elapsed(result->analyzer_elapsed);
+    // The cursor must not refer to the replaced versions
+    if (script.cursor) {
+        script.cursor = ScriptCursor::Place(script, script.cursor->text_offset);  // throws on error
+    }
+    return result->text_version;
+}
+
+/// Adopt the latest finished background analysis
+std::optional<TextVersion> Script::PollBackgroundAnalysis() {
+    if (!background_analysis) {
+        return std::nullopt;
+    }
+    return adoptBackgroundAnalysis(*this, background_analysis->Take());  // throws on error
+}
+
+/// Wait for the background analysis of the latest request
+std::optional<TextVersion> Script::WaitForBackgroundAnalysis() {
+    if (!background_analysis) {
+        return std::nullopt;
+    }
+    return adoptBackgroundAnalysis(*this, background_analysis->WaitAndTake());  // throws on error
+}
+#endif
+
 /// Move the cursor to a offset
 const ScriptCursor* Script::MoveCursor(size_t text_offset) {
-    cursor = ScriptCursor::Place(*this, text_offset);  // throws on error
+#ifndef WASM
+    PollBackgroundAnalysis();  // throws on error
+#endif
+    auto time_before_placing = std::chrono::steady_clock::now();
+    cursor = ScriptCursor::Place(*this, text_offset, cursor.get());  // throws on error
+    timing_statistics.mutate_cursor_last_elapsed(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - time_before_placing)
+            .count());
     return cursor.get();
 }
 /// Complete at the cursor
-std::unique_ptr<Completion> Script::CompleteAtCursor(size_t limit) const {
+std::unique_ptr<Completion> Script::CompleteAtCursor(size_t limit) {
     // Fail if the user forgot to move the cursor
     if (cursor == nullptr) {
         throw Exception(buffers::status::StatusCode::COMPLETION_MISSES_CURSOR);
@@ -1435,7 +1800,11 @@ std::unique_ptr<Completion> Script::CompleteAtCursor(size_t limit) const {
         throw Exception(buffers::status::StatusCode::COMPLETION_MISSES_SCANNER_TOKEN);
     }
     // Compute the completion
-    return Completion::Compute(*cursor, limit);  // throws on error
+    if (!completion_cache) {
+        completion_cache = std::make_unique<CompletionCache>();
+    }
+    // Native builds search the name indexes of large catalogs in parallel
+    return Completion::Compute(*cursor, limit, completion_cache.get(), true, true);  // throws on error
 }
 /// Format a script
 std::string Script::Format(const buffers::formatting::FormattingConfigT& config, bool parse_if_outdated) {
@@ -88,24 +88,49 @@ std::vector<ScriptCursor::NameComponent> ScriptCursor::ReadCursorNamePath(sx::pa
     return components;
 }
 
-std::unique_ptr<ScriptCursor> ScriptCursor::Place(const Script& script, size_t text_offset) {
+std::unique_ptr<ScriptCursor> ScriptCursor::Place(const Script& script, size_t text_offset,
+                                                  const ScriptCursor* previous) {
     auto cursor = std::make_unique<ScriptCursor>(script, text_offset);
+    cursor->parsed_script = script.parsed_script;
+    cursor->analyzed_script = script.analyzed_script;
 
     // Has the script been scanned?
     if (script.scanned_script) {
         cursor->scanner_location.emplace(script.scanned_script->FindSymbol(text_offset));
     }
 
+    // Was the previous cursor placed in the same analysis?
+    bool trailing_dot =
+        cursor->scanner_location.has_value() && cursor->scanner_location->current.symbolIsTrailingDot();
+    if (previous && (previous->parsed_script != script.parsed_script ||
+                     previous->analyzed_script != script.analyzed_script || !previous->ast_node_id.has_value())) {
+        previous = nullptr;
+    }
+
     // Has the script been parsed?
     if (script.parsed_script) {
-        // Try to find the ast node the cursor is pointing at
-        auto ast_node = script.parsed_script->FindNodeAtOffset(text_offset);
-        // A trailing-dot token may span into following whitespace. Anchor lookup at the dot so
-        // the cursor remains associated with the qualifier rather than a later sibling node.
-        if (cursor->scanner_location.has_value() && cursor->scanner_location->current.symbolIsTrailingDot()) {
-            const auto dot_offset = cursor->scanner_location->current.symbol.location.offset();
-            if (auto qualifier_node = script.parsed_script->FindNodeAtOffset(dot_offset); qualifier_node.has_value()) {
-                ast_node = qualifier_node;
+        std::optional<std::pair<size_t, size_t>> ast_node;
+        // Is the text offset strictly inside the AST leaf of the previous cursor?
+        // Then searching the AST again would yield the same node.
+        if (previous && !trailing_dot) {
+            auto& leaf = script.parsed_script->nodes[*previous->ast_node_id];
+            auto leaf_span = script.scanned_script->ResolveTextSpan(leaf.symbol_span());
+            if (leaf.children_count() == 0 && leaf_span.offset() < text_offset &&
+                text_offset < (leaf_span.offset() + leaf_span.length())) {
+                ast_node.emplace(*previous->statement_id, *previous->ast_node_id);
+            }
+        }
+        if (!ast_node.has_value()) {
+            // Try to find the ast node the cursor is pointing at
+            ast_node = script.parsed_script->FindNodeAtOffset(text_offset);
+            // A trailing-dot token may span into following whitespace. Anchor lookup at the dot so
+            // the cursor remains associated with the qualifier rather than a later sibling node.
+            if (trailing_dot) {
+                const auto dot_offset = cursor->scanner_location->current.symbol.location.offset();
+                if (auto qualifier_node = script.parsed_script->FindNodeAtOffset(dot_offset);
+                    qualifier_node.has_value()) {
+                    ast_node = qualifier_node;
+                }
             }
         }
         if (ast_node.has_value()) {
@@ -119,8 +144,14 @@ std::unique_ptr<ScriptCursor> ScriptCursor::Place(const Script& script, size_t t
             auto& analyzed = script.analyzed_script;
             if (analyzed && analyzed->parsed_script == script.parsed_script) {
                 // First find all name scopes that the ast node points into.
-                script.analyzed_script->FollowPathUpwards(*cursor->ast_node_id, cursor->ast_path_to_root,
-                                                          cursor->name_scopes);
+                // Reuse them if the previous cursor points at the same node.
+                if (previous && previous->ast_node_id == cursor->ast_node_id && !previous->name_scope_recovered) {
+                    cursor->ast_path_to_root = previous->ast_path_to_root;
+                    cursor->name_scopes = previous->name_scopes;
+                } else {
+                    script.analyzed_script->FollowPathUpwards(*cursor->ast_node_id, cursor->ast_path_to_root,
+                                                              cursor->name_scopes);
+                }
 
                 // Check if there's a table or column ref in the innermost scope containing the node
                 if (cursor->name_scopes.size() != 0) {
@@ -227,7 +258,10 @@ std::unique_ptr<ScriptCursor> ScriptCursor::Place(const Script& script, size_t t
                 });
             }
             if (best_scope != nullptr) {
-                if (cursor->name_scopes.empty()) cursor->name_scopes.emplace_back(*best_scope);
+                if (cursor->name_scopes.empty()) {
+                    cursor->name_scopes.emplace_back(*best_scope);
+                    cursor->name_scope_recovered = true;
+                }
                 cursor->context = ColumnRefContext{std::numeric_limits<uint32_t>::max()};
             }
         }
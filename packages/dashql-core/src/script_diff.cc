@@ -3,6 +3,9 @@
 #include <algorithm>
 #include <cassert>
 #include <cstdint>
+#include <unordered_map>
+
+#include "dashql/utils/murmur3.h"
 
 namespace dashql {
 
@@ -49,6 +52,26 @@ inline std::string_view nodeText(const ParsedScript& script, const Node& node) {
 inline std::string_view nameText(const ParsedScript& script, const Node& node) {
     return script.scanned_script->name_registry.At(node.children_begin_or_value()).text;
 }
+/// Mix a value into a structural hash
+inline uint64_t mixHash(uint64_t hash, uint64_t value) {
+    hash ^= value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    return hash;
+}
+/// Spread the bits of a hash (splitmix64 finalizer), used before summing attribute hashes
+inline uint64_t finalizeHash(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdULL;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+/// Hash a text
+inline uint64_t textHash(std::string_view text) {
+    uint64_t out[2];
+    MurmurHash3_x64_128(text.data(), static_cast<int>(text.size()), 0, out);
+    return out[0];
+}
 /// Resolve the text span of a statement root (empty span if the root is invalid)
 inline TextSpan resolveStatementSpan(const ParsedScript& script, const ParsedScript::Statement& stmt) {
     if (stmt.root >= script.nodes.size()) return TextSpan(0, 0);
@@ -72,6 +95,72 @@ inline void collectSortedChildren(const ParsedScript& script, const Node& node,
 /// Constructor
 ScriptDiff::ScriptDiff(const ParsedScript& source, const ParsedScript& target) : source_(source), target_(target) {}
 
+/// Compute the structural hashes of all subtrees
+void ScriptDiff::ComputeSubtreeHashes(const ParsedScript& script, std::vector<uint64_t>& hashes) {
+    auto& nodes = script.nodes;
+    hashes.resize(nodes.size());
+
+    // The parser emits children before their parents, so a single forward pass sees all child hashes.
+    // The hash covers exactly what CheckDeepEquality compares: equal subtrees always have equal hashes.
+    for (size_t node_id = 0; node_id < nodes.size(); ++node_id) {
+        auto& node = nodes[node_id];
+        auto node_type = node.node_type();
+        uint64_t hash = finalizeHash(typeId(node_type));
+        switch (node_type) {
+            case NodeType::NONE:
+                break;
+            case NodeType::BOOL:
+                hash = mixHash(hash, node.children_begin_or_value());
+                break;
+            case NodeType::NAME:
+                hash = mixHash(hash, textHash(nameText(script, node)));
+                break;
+            case NodeType::OPERATOR:
+            case NodeType::LITERAL_NULL:
+            case NodeType::LITERAL_INTEGER:
+            case NodeType::LITERAL_FLOAT:
+            case NodeType::LITERAL_STRING:
+            case NodeType::LITERAL_INTERVAL:
+                hash = mixHash(hash, textHash(nodeText(script, node)));
+                break;
+            case NodeType::ARRAY: {
+                uint32_t begin = node.children_begin_or_value();
+                uint32_t count = node.children_count();
+                hash = mixHash(hash, count);
+                for (uint32_t i = begin; i < begin + count; ++i) {
+                    assert(i < node_id);
+                    hash = mixHash(hash, hashes[i]);
+                }
+                break;
+            }
+            default: {
+                if (isObjectType(node_type)) {
+                    // Attribute lists are unsorted, so we sum the attribute hashes to be independent of the order.
+                    // Attributes with the same key are compared in grammar order, their rank among the attributes
+                    // with that key is therefore part of the hash. Objects only have a handful of attributes.
+                    uint32_t begin = node.children_begin_or_value();
+                    uint32_t count = node.children_count();
+                    uint64_t attributes = 0;
+                    for (uint32_t i = 0; i < count; ++i) {
+                        assert(begin + i < node_id);
+                        auto key = keyId(nodes[begin + i]);
+                        uint32_t rank = 0;
+                        for (uint32_t j = 0; j < i; ++j) {
+                            rank += keyId(nodes[begin + j]) == key;
+                        }
+                        attributes += finalizeHash(mixHash(mixHash(key, rank), hashes[begin + i]));
+                    }
+                    hash = mixHash(mixHash(hash, count), attributes);
+                } else if (isEnumType(node_type)) {
+                    hash = mixHash(hash, node.children_begin_or_value());
+                }
+                break;
+            }
+        }
+        hashes[node_id] = hash;
+    }
+}
+
 /// Compute the size of a subtree rooted at `root` (memoized DFS)
 size_t ScriptDiff::ComputeTreeSize(const ParsedScript& script, size_t root, std::vector<size_t>& sizes) {
     if (root >= script.nodes.size()) return 0;
@@ -141,6 +230,10 @@ ScriptDiff::SimilarityEstimate ScriptDiff::EstimateSimilarity(const ParsedScript
 
     // Different root node types?
     if (s.node_type() != t.node_type()) return SimilarityEstimate::NOT_EQUAL;
+    // Different structure? Then the text differs as well
+    if (source_.subtree_hashes[source.root] != target_.subtree_hashes[target.root]) {
+        return SimilarityEstimate::SIMILAR;
+    }
 
     // Do a string comparison if the strings are equal in size and number of root attributes.
     // This bypasses the tree diffing for all unchanged statements.
@@ -203,6 +296,12 @@ ScriptDiff::StatementSimilarity ScriptDiff::ComputeSimilarity(const ParsedScript
         auto& s = source_.nodes[source_id];
         auto& t = target_.nodes[target_id];
 
+        // Equal subtrees match with all their nodes, there's no need to descend
+        if (source_.subtree_hashes[source_id] == target_.subtree_hashes[target_id]) {
+            pending[idx].matching_nodes += ComputeTreeSize(source_, source_id, source_subtree_sizes_);
+            continue;
+        }
+
         bool match = true;
         if (s.node_type() != t.node_type()) {
             match = false;
@@ -300,6 +399,7 @@ bool ScriptDiff::CheckDeepEquality(const ParsedScript::Statement& source, const
         auto& t = target_.nodes[target_id];
 
         if (s.node_type() != t.node_type()) return false;
+        if (source_.subtree_hashes[source_id] != target_.subtree_hashes[target_id]) return false;
 
         auto node_type = s.node_type();
         switch (node_type) {
@@ -361,12 +461,24 @@ void ScriptDiff::MapStatements(StatementMappings& unique_pairs, StatementMapping
 
     // We deviate from PatienceDiff slightly here: instead of first making both sides unique and then
     // matching, we assume statements are unique most of the time and compute the mapping directly.
-    // The EstimateSimilarity short-circuit keeps the quadratic behaviour acceptable.
+    // Equal statements have equal root hashes, so we group the target statements by their root hash and only
+    // compare every source statement with the targets in its bucket.
+    std::unordered_map<uint64_t, std::vector<size_t>> targets_by_hash;
+    targets_by_hash.reserve(target_count);
+    for (size_t target_id = 0; target_id < target_count; ++target_id) {
+        auto root = target_.statements[target_id].root;
+        if (root < target_.nodes.size()) {
+            targets_by_hash[target_.subtree_hashes[root]].push_back(target_id);
+        }
+    }
     for (size_t source_id = 0; source_id < source_count; ++source_id) {
         auto& source_stmt = source_.statements[source_id];
+        if (source_stmt.root >= source_.nodes.size()) continue;
+        auto bucket = targets_by_hash.find(source_.subtree_hashes[source_stmt.root]);
+        if (bucket == targets_by_hash.end()) continue;
         std::optional<size_t> match;
 
-        for (size_t target_id = 0; target_id < target_count; ++target_id) {
+        for (auto target_id : bucket->second) {
             auto& target_stmt = target_.statements[target_id];
             switch (EstimateSimilarity(source_stmt, target_stmt)) {
                 case SimilarityEstimate::NOT_EQUAL:
@@ -421,8 +533,9 @@ ScriptDiff::StatementMappings ScriptDiff::FindLCS(const StatementMappings& uniqu
     // Build the piles
     std::vector<Pile> piles;
     for (auto& [source_id, target_id] : unique_pairs) {
-        auto p = std::find_if(piles.begin(), piles.end(),
-                              [t = target_id](Pile& x) { return x.back().target_id >= t; });
+        // The pile tops are sorted by target id, binary search the first pile that can take the pair
+        auto p = std::partition_point(piles.begin(), piles.end(),
+                                      [t = target_id](Pile& x) { return x.back().target_id < t; });
         if (p != piles.end()) {
             auto prev_pile_id = std::max<size_t>(p - piles.begin(), 1) - 1;
             auto prev_pile_size = piles[prev_pile_id].size();
@@ -484,6 +597,10 @@ std::vector<buffers::parser::TextSpan> ScriptDiff::CollectTargetChanges(const Pa
             record(target_id);
             continue;
         }
+        // Equal subtrees contain no changes
+        if (source_.subtree_hashes[source_id] == target_.subtree_hashes[target_id]) {
+            continue;
+        }
 
         auto node_type = s.node_type();
         switch (node_type) {
@@ -1,8 +1,8 @@
 #include "dashql/shell/session_relation_catalog.h"
 
 #include <cstdint>
+#include <cstring>
 #include <optional>
-#include <sstream>
 #include <utility>
 
 #include "dashql/catalog.h"
@@ -15,19 +15,6 @@ using StatementType = buffers::parser::StatementType;
 
 constexpr uint32_t SESSION_RELATION_CATALOG_RANK = 9998;
 constexpr std::string_view SESSION_SCHEMA = "public";
-constexpr std::string_view CATALOG_HEADER = "-- Relations created during this shell session.";
-
-std::string QuoteIdentifier(std::string_view identifier) {
-    std::string quoted;
-    quoted.reserve(identifier.size() + 2);
-    quoted.push_back('"');
-    for (const auto character : identifier) {
-        quoted.push_back(character);
-        if (character == '"') quoted.push_back('"');
-    }
-    quoted.push_back('"');
-    return quoted;
-}
 
 struct StatementTarget {
     std::string database_name;
@@ -51,13 +38,13 @@ std::optional<StatementTarget> ReadTarget(const ParsedScript& parsed, size_t sta
 }  // namespace
 
 SessionRelationCatalog::SessionRelationCatalog(Catalog& catalog)
-    : catalog_{catalog},
-      parser_script_{std::make_unique<Script>(catalog)},
-      catalog_script_{std::make_unique<Script>(catalog)} {
-    catalog_script_->ReplaceText(CATALOG_HEADER);
-}
+    : catalog_{catalog}, parser_script_{std::make_unique<Script>(catalog)} {}
 
-SessionRelationCatalog::~SessionRelationCatalog() = default;
+SessionRelationCatalog::~SessionRelationCatalog() {
+    for (const auto& [_, relation] : relations_) {
+        DropRelation(relation);
+    }
+}
 
 void SessionRelationCatalog::ApplySuccessfulQuery(std::string_view query) {
     parser_script_->ReplaceText(query);
@@ -87,55 +74,75 @@ void SessionRelationCatalog::ApplySuccessfulQuery(std::string_view query) {
     RelationKey key{target->database_name, target->schema_name, target->relation_name};
 
     if (statement_type == StatementType::DROP_TABLE || statement_type == StatementType::DROP_VIEW) {
-        relations_.erase(key);
-    } else {
-        Relation relation{
-            .database_name = target->database_name,
-            .schema_name = target->schema_name,
-            .relation_name = target->relation_name,
-        };
-        for (const auto& table_chunk : analyzed->GetTables().GetChunks()) {
-            for (const auto& table : table_chunk) {
-                if (table.table_name.database_name.get().text != relation.database_name ||
-                    (table.table_name.schema_name.get().text.empty()
-                         ? SESSION_SCHEMA
-                         : table.table_name.schema_name.get().text) != relation.schema_name ||
-                    table.table_name.table_name.get().text != relation.relation_name) {
-                    continue;
-                }
-                relation.columns.reserve(table.table_columns.size());
-                for (const auto& column : table.table_columns) {
-                    relation.columns.emplace_back(column.column_name.get().text);
-                }
-                break;
+        if (auto iter = relations_.find(key); iter != relations_.end()) {
+            DropRelation(iter->second);
+            relations_.erase(iter);
+        }
+        return;
+    }
+
+    Relation relation{
+        .database_name = target->database_name,
+        .schema_name = target->schema_name,
+        .relation_name = target->relation_name,
+    };
+    for (const auto& table_chunk : analyzed->GetTables().GetChunks()) {
+        for (const auto& table : table_chunk) {
+            if (table.table_name.database_name.get().text != relation.database_name ||
+                (table.table_name.schema_name.get().text.empty() ? SESSION_SCHEMA
+                                                                 : table.table_name.schema_name.get().text) !=
+                    relation.schema_name ||
+                table.table_name.table_name.get().text != relation.relation_name) {
+                continue;
+            }
+            relation.columns.reserve(table.table_columns.size());
+            for (const auto& column : table.table_columns) {
+                relation.columns.emplace_back(column.column_name.get().text);
             }
+            break;
         }
-        relations_.insert_or_assign(std::move(key), std::move(relation));
     }
-    ReloadCatalogScript();
+    // Replace a previous relation with the same name
+    if (auto iter = relations_.find(key); iter != relations_.end()) {
+        DropRelation(iter->second);
+        relations_.erase(iter);
+    }
+    LoadRelation(relation);
+    relations_.insert({std::move(key), std::move(relation)});
 }
 
-void SessionRelationCatalog::ReloadCatalogScript() {
-    catalog_script_->ReplaceText(RenderCatalog());
-    catalog_script_->Analyze();
-    catalog_.DropScript(*catalog_script_);
-    catalog_.LoadScript(*catalog_script_, SESSION_RELATION_CATALOG_RANK);
+void SessionRelationCatalog::LoadRelation(Relation& relation) {
+    buffers::catalog::SchemaDescriptorT descriptor;
+    descriptor.database_name = relation.database_name;
+    descriptor.schema_name = relation.schema_name;
+    auto table = std::make_unique<buffers::catalog::SchemaTableT>();
+    table->table_name = relation.relation_name;
+    for (size_t i = 0; i < relation.columns.size(); ++i) {
+        auto column = std::make_unique<buffers::catalog::SchemaTableColumnT>();
+        column->column_name = relation.columns[i];
+        column->ordinal_position = i;
+        table->columns.push_back(std::move(column));
+    }
+    descriptor.tables.push_back(std::move(table));
+
+    flatbuffers::FlatBufferBuilder builder;
+    builder.Finish(buffers::catalog::SchemaDescriptor::Pack(builder, &descriptor));
+    auto buffer = std::make_unique<std::byte[]>(builder.GetSize());
+    std::memcpy(buffer.get(), builder.GetBufferPointer(), builder.GetSize());
+    std::span<const std::byte> data{buffer.get(), builder.GetSize()};
+
+    relation.catalog_entry_id = catalog_.AllocateEntryId();
+    catalog_.AddDescriptorPool(relation.catalog_entry_id, SESSION_RELATION_CATALOG_RANK);
+    try {
+        catalog_.AddSchemaDescriptor(relation.catalog_entry_id, data, std::move(buffer), data.size());
+    } catch (...) {
+        catalog_.DropDescriptorPool(relation.catalog_entry_id);
+        throw;
+    }
 }
 
-std::string SessionRelationCatalog::RenderCatalog() const {
-    std::ostringstream output;
-    output << CATALOG_HEADER;
-    for (const auto& [_, relation] : relations_) {
-        output << "\n\nCREATE TABLE ";
-        if (!relation.database_name.empty()) output << QuoteIdentifier(relation.database_name) << '.';
-        output << QuoteIdentifier(relation.schema_name) << '.' << QuoteIdentifier(relation.relation_name) << " (\n";
-        for (size_t i = 0; i < relation.columns.size(); ++i) {
-            if (i != 0) output << ",\n";
-            output << "    " << QuoteIdentifier(relation.columns[i]) << " VARCHAR";
-        }
-        output << "\n);";
-    }
-    return output.str();
+void SessionRelationCatalog::DropRelation(const Relation& relation) {
+    catalog_.DropDescriptorPool(relation.catalog_entry_id);
 }
 
 }  // namespace dashql::shell
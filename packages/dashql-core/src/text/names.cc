@@ -1,5 +1,8 @@
 #include "dashql/text/names.h"
 
+#include <algorithm>
+#include <limits>
+
 #include "dashql/utils/string_conversion.h"
 
 namespace dashql {
@@ -59,4 +62,150 @@ RegisteredName& NameRegistry::Register(std::string_view text, NameTags tags) {
     }
 }
 
+/// Compare two suffixes
+bool NameSearchIndex::IsLess(const Suffix& l, const Suffix& r) const {
+    if (int c = ReadSuffix(l).compare(ReadSuffix(r)); c != 0) {
+        return c < 0;
+    }
+    // Break ties between equal suffixes of different names by the name text.
+    // This keeps the order independent of the registry that the names belong to.
+    return GetName(l).text < GetName(r).text;
+}
+
+/// Fold a name into the text pool and collect its suffixes
+void NameSearchIndex::AddName(const RegisteredName& name, std::vector<Suffix>& out) {
+    auto name_index = static_cast<uint32_t>(names.size());
+    auto name_begin = static_cast<uint32_t>(text_pool.size());
+    for (char c : name.text) {
+        text_pool.push_back(static_cast<char>(tolower_fuzzy(c)));
+    }
+    names.push_back(name);
+    name_ends.push_back(static_cast<uint32_t>(text_pool.size()));
+    for (size_t i = 1; i <= name.text.size(); ++i) {
+        out.push_back(Suffix{
+            .name_index = name_index,
+            .pool_offset = static_cast<uint32_t>(name_begin + name.text.size() - i),
+        });
+    }
+}
+
+/// Constructor
+NameSearchIndex::NameSearchIndex(const NameRegistry& registry) {
+    size_t pool_size = 0;
+    for (auto& chunk : registry.GetChunks()) {
+        for (auto& name : chunk) {
+            pool_size += name.text.size();
+        }
+    }
+    names.reserve(registry.GetSize());
+    name_ends.reserve(registry.GetSize());
+    text_pool.reserve(pool_size);
+    suffixes.reserve(pool_size);
+    for (auto& chunk : registry.GetChunks()) {
+        for (auto& name : chunk) {
+            if (!name.text.empty()) {
+                AddName(name, suffixes);
+            }
+        }
+    }
+    std::sort(suffixes.begin(), suffixes.end(), [this](const Suffix& l, const Suffix& r) { return IsLess(l, r); });
+    CollectPrefixes();
+}
+
+/// Constructor that derives the index from the index of a previous registry
+NameSearchIndex::NameSearchIndex(const NameRegistry& registry, const NameSearchIndex& previous) {
+    constexpr uint32_t REMOVED = std::numeric_limits<uint32_t>::max();
+
+    // Map the previous names to the names in the new registry
+    std::vector<uint32_t> name_mapping(previous.names.size(), REMOVED);
+    std::vector<bool> carried_over(registry.GetSize(), false);
+    names.reserve(registry.GetSize());
+    name_ends.reserve(registry.GetSize());
+    garbage_bytes = previous.garbage_bytes;
+    for (size_t i = 0; i < previous.names.size(); ++i) {
+        auto& previous_name = previous.names[i].get();
+        auto iter = registry.names_by_text.find(previous_name.text);
+        if (iter == registry.names_by_text.end()) {
+            garbage_bytes += previous_name.text.size();
+            continue;
+        }
+        auto& name = iter->second.get();
+        name_mapping[i] = static_cast<uint32_t>(names.size());
+        carried_over[name.name_id] = true;
+        names.push_back(name);
+        name_ends.push_back(previous.name_ends[i]);
+    }
+
+    // Rebuild the index if most of the text pool belongs to removed names
+    if (garbage_bytes * 2 > previous.text_pool.size()) {
+        *this = NameSearchIndex{registry};
+        return;
+    }
+
+    // Carry over the suffixes of the remaining names, they stay sorted
+    text_pool = previous.text_pool;
+    suffixes.reserve(previous.suffixes.size());
+    for (auto& suffix : previous.suffixes) {
+        if (auto name_index = name_mapping[suffix.name_index]; name_index != REMOVED) {
+            suffixes.push_back(Suffix{.name_index = name_index, .pool_offset = suffix.pool_offset});
+        }
+    }
+
+    // Sort the suffixes of the added names and merge them in
+    std::vector<Suffix> added;
+    for (auto& chunk : registry.GetChunks()) {
+        for (auto& name : chunk) {
+            if (!name.text.empty() && !carried_over[name.name_id]) {
+                AddName(name, added);
+            }
+        }
+    }
+    auto is_less = [this](const Suffix& l, const Suffix& r) { return IsLess(l, r); };
+    std::sort(added.begin(), added.end(), is_less);
+    auto carried_count = suffixes.size();
+    suffixes.insert(suffixes.end(), added.begin(), added.end());
+    std::inplace_merge(suffixes.begin(), suffixes.begin() + carried_count, suffixes.end(), is_less);
+    CollectPrefixes();
+}
+
+/// Collect the suffixes that start at the beginning of a name
+void NameSearchIndex::CollectPrefixes() {
+    prefixes.clear();
+    prefixes.reserve(names.size());
+    for (auto& suffix : suffixes) {
+        if (suffix.pool_offset + GetName(suffix).text.size() == name_ends[suffix.name_index]) {
+            prefixes.push_back(suffix);
+        }
+    }
+}
+
+/// Get the byte size
+size_t NameSearchIndex::GetByteSize() const {
+    return names.capacity() * sizeof(std::reference_wrapper<const RegisteredName>) +
+           name_ends.capacity() * sizeof(uint32_t) + text_pool.capacity() +
+           (suffixes.capacity() + prefixes.capacity()) * sizeof(Suffix);
+}
+
+/// Find all suffixes that start with a text
+std::span<const NameSearchIndex::Suffix> NameSearchIndex::FindSuffixes(std::string_view text) const {
+    return FindSuffixes(text, suffixes);
+}
+
+/// Find the suffixes within a previous result that start with a text
+std::span<const NameSearchIndex::Suffix> NameSearchIndex::FindSuffixes(std::string_view text,
+                                                                      std::span<const Suffix> within) const {
+    std::string folded;
+    folded.reserve(text.size());
+    for (char c : text) {
+        folded.push_back(static_cast<char>(tolower_fuzzy(c)));
+    }
+    std::string_view needle{folded};
+    auto begin = std::lower_bound(within.begin(), within.end(), needle,
+                                  [&](const Suffix& s, std::string_view n) { return ReadSuffix(s) < n; });
+    auto end = std::upper_bound(begin, within.end(), needle, [&](std::string_view n, const Suffix& s) {
+        return n < ReadSuffix(s).substr(0, n.size());
+    });
+    return within.subspan(begin - within.begin(), end - begin);
+}
+
 }  // namespace dashql
@@ -760,6 +760,22 @@ std::string Rope::ToString(bool with_padding) const {
     return buffer;
 }
 
+size_t Rope::ResolveCodepoint(size_t char_idx) const {
+    if (root_node.IsNull() || char_idx >= root_info.utf8_codepoints) {
+        return root_info.text_bytes;
+    }
+    TextStats prefix;
+    auto node = root_node;
+    while (node.Is<InnerNode>()) {
+        auto* inner = node.Get<InnerNode>();
+        auto [child_idx, child_prefix] = inner->FindCodepoint(char_idx - prefix.utf8_codepoints);
+        prefix += child_prefix;
+        node = inner->GetChildNodes()[child_idx];
+    }
+    auto* leaf = node.Get<LeafNode>();
+    return prefix.text_bytes + utf8::codepointToByteIdx(leaf->GetData(), char_idx - prefix.utf8_codepoints);
+}
+
 Rope::TextPosition Rope::ResolveGrapheme(size_t grapheme_idx) const {
     grapheme_idx = std::min(grapheme_idx, static_cast<size_t>(root_info.grapheme_clusters));
     if (root_node.IsNull()) {
@@ -1,5 +1,15 @@
 #include "dashql/utils/string_conversion.h"
 
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#elif defined(__wasm_simd128__)
+#include <wasm_simd128.h>
+#endif
+
 namespace dashql {
 
 const std::array<unsigned char, 256> TOLOWER_ASCII_TABLE{
@@ -17,4 +27,58 @@ const std::array<unsigned char, 256> TOLOWER_ASCII_TABLE{
     242, 243, 244, 245, 246, 247, 248, 249, 250, 251, 252, 253, 254, 255,
 };
 
+namespace {
+
+/// The number of bytes that are folded at once
+constexpr size_t FOLD_BLOCK_SIZE = 16;
+
+/// Fold a block of 16 bytes to lower-case, returns true if the block contained upper-case characters
+inline bool fold_lower_block(const char *in, char *out) {
+#if defined(__SSE2__)
+    // Bytes >= 0x80 are negative as signed chars and never fall into the range
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in));
+    __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(v, _mm_set1_epi8('Z' + 1)));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out), _mm_or_si128(v, _mm_and_si128(upper, _mm_set1_epi8(0x20))));
+    return _mm_movemask_epi8(upper) != 0;
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+    uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t *>(in));
+    uint8x16_t upper = vandq_u8(vcgeq_u8(v, vdupq_n_u8('A')), vcleq_u8(v, vdupq_n_u8('Z')));
+    vst1q_u8(reinterpret_cast<uint8_t *>(out), vorrq_u8(v, vandq_u8(upper, vdupq_n_u8(0x20))));
+    return vmaxvq_u8(upper) != 0;
+#elif defined(__wasm_simd128__)
+    v128_t v = wasm_v128_load(in);
+    v128_t upper = wasm_v128_and(wasm_u8x16_ge(v, wasm_u8x16_splat('A')), wasm_u8x16_le(v, wasm_u8x16_splat('Z')));
+    wasm_v128_store(out, wasm_v128_or(v, wasm_v128_and(upper, wasm_u8x16_splat(0x20))));
+    return wasm_v128_any_true(upper);
+#else
+    bool any_upper = false;
+    for (size_t i = 0; i < FOLD_BLOCK_SIZE; ++i) {
+        auto c = static_cast<unsigned char>(in[i]);
+        any_upper |= c >= 'A' && c <= 'Z';
+        out[i] = static_cast<char>(tolower_fuzzy(c));
+    }
+    return any_upper;
+#endif
+}
+
+}  // namespace
+
+bool fold_lower_fuzzy(std::string_view text, char *out) {
+    bool any_upper = false;
+    size_t i = 0;
+    for (; (i + FOLD_BLOCK_SIZE) <= text.size(); i += FOLD_BLOCK_SIZE) {
+        any_upper |= fold_lower_block(text.data() + i, out + i);
+    }
+    // Most identifiers are shorter than a block.
+    // Pad the remaining bytes instead of folding them one by one, zero bytes are never upper-case.
+    if (auto rest = text.size() - i; rest > 0) {
+        char in_block[FOLD_BLOCK_SIZE] = {};
+        char out_block[FOLD_BLOCK_SIZE];
+        std::memcpy(in_block, text.data() + i, rest);
+        any_upper |= fold_lower_block(in_block, out_block);
+        std::memcpy(out + i, out_block, rest);
+    }
+    return !any_upper;
+}
+
 }  // namespace dashql
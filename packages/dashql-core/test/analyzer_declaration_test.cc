@@ -115,9 +115,9 @@ TEST(AnalyzerDeclarationTest, DerivedTableColumnsAreIndexed) {
     ASSERT_EQ(analyzed->GetTables().GetSize(), 2);
     auto& derived = analyzed->GetTables()[1];
     EXPECT_EQ(derived.ast_statement_id, 1);
-    ASSERT_TRUE(derived.table_columns_by_name.contains("copied_id"));
+    ASSERT_NE(derived.FindColumn("copied_id"), nullptr);
 
-    EXPECT_TRUE(derived.table_columns_by_name.contains("copied_id"));
+    EXPECT_EQ(derived.FindColumn("copied_id")->column_name.get().text, "copied_id");
 }
 
 TEST(AnalyzerDeclarationTest, SetOperationUsesLeftInputColumns) {
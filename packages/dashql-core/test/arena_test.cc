@@ -0,0 +1,156 @@
+#include "dashql/utils/arena.h"
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+
+#include "dashql/catalog.h"
+#include "dashql/script.h"
+#include "dashql/utils/chunk_buffer.h"
+#include "dashql/utils/string_pool.h"
+#include "gtest/gtest.h"
+
+using namespace dashql;
+
+namespace {
+
+TEST(ArenaTest, AllocatesAligned) {
+    Arena arena{64};
+    EXPECT_EQ(arena.GetBlockCount(), 0);
+    auto* a = static_cast<char*>(arena.Allocate(3, 1));
+    auto* b = arena.Allocate(8, 8);
+    auto* c = arena.Allocate(16, 16);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(b) % 8, 0);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(c) % 16, 0);
+    EXPECT_GE(static_cast<char*>(b), a + 3);
+    EXPECT_EQ(arena.GetAllocationCount(), 3);
+    EXPECT_EQ(arena.GetAllocatedBytes(), 27);
+    EXPECT_EQ(arena.GetBlockCount(), 1);
+
+    // Requests exceeding the block size get a block of their own
+    auto* d = arena.Allocate(1000, 8);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(d) % 8, 0);
+    EXPECT_EQ(arena.GetBlockCount(), 2);
+    EXPECT_EQ(arena.GetReservedBytes(), 1064);
+    // The current block is not abandoned
+    arena.Allocate(8, 8);
+    EXPECT_EQ(arena.GetBlockCount(), 2);
+}
+
+TEST(ArenaTest, ChunkBufferInArena) {
+    Arena arena;
+    ChunkBuffer<uint32_t, 16> buffer{&arena};
+    for (uint32_t i = 0; i < 1000; ++i) {
+        buffer.PushBack(i);
+    }
+    for (uint32_t i = 0; i < 1000; ++i) {
+        ASSERT_EQ(buffer[i], i);
+    }
+    // Every chunk is a single arena allocation
+    EXPECT_EQ(arena.GetAllocationCount(), buffer.GetChunks().size());
+
+    // Copies are allocated on the heap
+    auto allocations = arena.GetAllocationCount();
+    ChunkBuffer<uint32_t, 16> copy{buffer};
+    for (uint32_t i = 0; i < 1000; ++i) {
+        copy.PushBack(i);
+    }
+    EXPECT_EQ(copy.GetSize(), 2000);
+    EXPECT_EQ(arena.GetAllocationCount(), allocations);
+}
+
+TEST(ArenaTest, StringPoolInArena) {
+    Arena arena;
+    StringPool<16> pool{&arena};
+    auto foo = pool.AllocateCopy("foo");
+    auto bar = pool.AllocateCopy("barbarbarbarbarbarbar");
+    EXPECT_EQ(foo, "foo");
+    EXPECT_EQ(bar, "barbarbarbarbarbarbar");
+    EXPECT_EQ(pool.GetSize(), 24);
+    EXPECT_EQ(arena.GetAllocationCount(), 2);
+    EXPECT_EQ(arena.GetBlockCount(), 1);
+}
+
+TEST(ArenaTest, UnorderedMapInArena) {
+    Arena arena;
+    using Map = std::unordered_map<uint32_t, uint32_t, std::hash<uint32_t>, std::equal_to<uint32_t>,
+                                   ArenaAllocator<std::pair<const uint32_t, uint32_t>>>;
+    Map map{Map::allocator_type{&arena}};
+    for (uint32_t i = 0; i < 100; ++i) {
+        map.insert({i, i * 2});
+    }
+    for (uint32_t i = 0; i < 100; ++i) {
+        ASSERT_EQ(map.at(i), i * 2);
+    }
+    EXPECT_GE(arena.GetAllocationCount(), 100);
+}
+
+TEST(ArenaTest, ScriptStatisticsReportArenaAllocations) {
+    Catalog catalog;
+    Script script{catalog};
+    script.InsertTextAt(0, "select A, B, C from Foo f, Bar b where f.X = b.Y; select * from Foo;");
+    ASSERT_NO_THROW(script.Analyze());
+
+    auto stats = script.GetStatistics();
+    auto& latest = stats->memory->latest_script();
+    EXPECT_GT(latest.scanner_arena_allocations(), 0);
+    EXPECT_GT(latest.scanner_arena_blocks(), 0);
+    EXPECT_GT(latest.parser_arena_allocations(), 0);
+    EXPECT_GT(latest.parser_arena_blocks(), 0);
+    EXPECT_GT(latest.analyzer_arena_allocations(), 0);
+    EXPECT_GT(latest.analyzer_arena_blocks(), 0);
+    // The stages serve many allocations from few blocks
+    EXPECT_LT(latest.scanner_arena_blocks(), latest.scanner_arena_allocations());
+    EXPECT_LT(latest.analyzer_arena_blocks(), latest.analyzer_arena_allocations());
+}
+
+TEST(ArenaTest, RecyclesBlocks) {
+    auto pool = std::make_shared<ArenaBlockPool>();
+    {
+        Arena arena{64, pool};
+        arena.Allocate(40, 8);
+        arena.Allocate(40, 8);
+        EXPECT_EQ(arena.GetBlockCount(), 2);
+        EXPECT_EQ(pool->GetPooledBlockCount(), 0);
+    }
+    EXPECT_EQ(pool->GetPooledBlockCount(), 2);
+
+    // The next arena draws from the pool
+    Arena arena{64, pool};
+    arena.Allocate(40, 8);
+    EXPECT_EQ(arena.GetBlockCount(), 1);
+    EXPECT_EQ(pool->GetPooledBlockCount(), 1);
+    EXPECT_EQ(pool->GetReusedBlockCount(), 1);
+    // Blocks that are too small are not taken
+    arena.Allocate(200, 8);
+    EXPECT_EQ(pool->GetPooledBlockCount(), 1);
+}
+
+TEST(ArenaTest, ScriptRecyclesBuffers) {
+    constexpr std::string_view text = "select A, b, c from Foo f, bar b where f.X = b.y group by a order by b;";
+    Catalog catalog;
+    Script recycling{catalog};
+    recycling.SetBufferRecycling(true);
+    for (size_t i = 0; i < text.size(); ++i) {
+        recycling.InsertTextAt(i, text.substr(i, 1));
+        ASSERT_NO_THROW(recycling.Analyze());
+    }
+    // Later versions reused the blocks of the versions they replaced
+    ASSERT_NE(recycling.arena_block_pool, nullptr);
+    EXPECT_GT(recycling.arena_block_pool->GetReusedBlockCount(), 0);
+    EXPECT_EQ(recycling.scanned_script->arena.GetBlockPool(), recycling.arena_block_pool);
+    EXPECT_EQ(recycling.analyzed_script->arena.GetBlockPool(), recycling.arena_block_pool);
+
+    // The analysis does not change
+    Script fresh{catalog};
+    fresh.InsertTextAt(0, text);
+    ASSERT_NO_THROW(fresh.Analyze());
+    EXPECT_EQ(recycling.scanned_script->GetSymbols().GetSize(), fresh.scanned_script->GetSymbols().GetSize());
+    EXPECT_EQ(recycling.scanned_script->name_registry.GetSize(), fresh.scanned_script->name_registry.GetSize());
+    EXPECT_EQ(recycling.parsed_script->nodes.size(), fresh.parsed_script->nodes.size());
+    EXPECT_EQ(recycling.analyzed_script->table_references.GetSize(), fresh.analyzed_script->table_references.GetSize());
+    EXPECT_EQ(recycling.analyzed_script->expressions.GetSize(), fresh.analyzed_script->expressions.GetSize());
+}
+
+}  // namespace
@@ -3,9 +3,16 @@
 #include <flatbuffers/buffer.h>
 #include <flatbuffers/flatbuffer_builder.h>
 
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <stdexcept>
+#include <string>
+
 #include "dashql/analyzer/analyzer.h"
 #include "dashql/buffers/index_generated.h"
 #include "dashql/catalog_object.h"
+#include "dashql/exception.h"
 #include "dashql/script.h"
 #include "gtest/gtest.h"
 
@@ -148,4 +155,601 @@ TEST(CatalogTest, FlattenExampleSchema) {
     ASSERT_EQ(flat->schemas()->size(), 1);
 }
 
+/// A packed schema descriptor
+struct PackedDescriptor {
+    /// The buffer
+    std::unique_ptr<const std::byte[]> buffer;
+    /// The buffer size
+    size_t size;
+    /// Get the descriptor data
+    std::span<const std::byte> data() const { return {buffer.get(), size}; }
+};
+
+/// Pack a schema descriptor with tables of the form (table, columns)
+PackedDescriptor PackSchemaDescriptor(std::string_view database_name, std::string_view schema_name,
+                                      std::vector<std::pair<std::string, std::vector<std::string>>> tables) {
+    buffers::catalog::SchemaDescriptorT descriptor;
+    descriptor.database_name = database_name;
+    descriptor.schema_name = schema_name;
+    for (auto& [table_name, column_names] : tables) {
+        auto table = std::make_unique<buffers::catalog::SchemaTableT>();
+        table->table_name = table_name;
+        for (auto& column_name : column_names) {
+            auto column = std::make_unique<buffers::catalog::SchemaTableColumnT>();
+            column->column_name = column_name;
+            column->ordinal_position = table->columns.size();
+            table->columns.push_back(std::move(column));
+        }
+        descriptor.tables.push_back(std::move(table));
+    }
+    flatbuffers::FlatBufferBuilder fb;
+    fb.Finish(buffers::catalog::SchemaDescriptor::Pack(fb, &descriptor));
+    auto buffer = std::make_unique<std::byte[]>(fb.GetSize());
+    std::memcpy(buffer.get(), fb.GetBufferPointer(), fb.GetSize());
+    return {.buffer = std::move(buffer), .size = fb.GetSize()};
+}
+
+TEST(CatalogTest, DescriptorPoolResolvesTables) {
+    Catalog catalog;
+    ASSERT_NO_THROW(catalog.AddDescriptorPool(1, 0));
+    auto descriptor = PackSchemaDescriptor("db1", "schema1", {{"table1", {"a", "b"}}, {"table2", {"c"}}});
+    auto data = descriptor.data();
+    ASSERT_NO_THROW(catalog.AddSchemaDescriptor(1, data, std::move(descriptor.buffer), data.size()));
+
+    // Check the statistics
+    auto stats = catalog.GetStatistics();
+    ASSERT_EQ(stats->entries.size(), 1);
+    EXPECT_EQ(stats->entries[0]->memory->descriptor_buffer_count(), 1);
+    EXPECT_EQ(stats->entries[0]->content->table_count(), 2);
+    EXPECT_EQ(stats->entries[0]->content->table_column_count(), 3);
+    EXPECT_GT(stats->entries[0]->memory->table_column_bytes(), 0);
+    EXPECT_GT(stats->entries[0]->memory->table_column_store_bytes(), 0);
+    EXPECT_EQ(stats->content->database_count(), 1);
+    EXPECT_EQ(stats->content->schema_count(), 1);
+
+    // Flatten the catalog
+    flatbuffers::FlatBufferBuilder fb;
+    fb.Finish(catalog.Flatten(fb));
+    auto flat = flatbuffers::GetRoot<buffers::catalog::FlatCatalog>(fb.GetBufferPointer());
+    ASSERT_EQ(flat->databases()->size(), 1);
+    ASSERT_EQ(flat->schemas()->size(), 1);
+    ASSERT_EQ(flat->tables()->size(), 2);
+    ASSERT_EQ(flat->columns()->size(), 3);
+
+    // Resolve a table of the pool in a script
+    Script script{catalog};
+    script.InsertTextAt(0, "select a from schema1.table1");
+    ASSERT_NO_THROW(script.Analyze());
+    auto& analyzed = script.GetAnalyzedScript();
+    ASSERT_EQ(analyzed->table_references.GetSize(), 1);
+    auto& rel_expr = std::get<AnalyzedScript::TableReference::RelationExpression>(analyzed->table_references[0].inner);
+    ASSERT_TRUE(rel_expr.resolved_table.has_value());
+    EXPECT_EQ(rel_expr.resolved_table->catalog_table_id.UnpackTableID().Pack(), ExternalObjectID(1, 0).Pack());
+
+    // Dropping the pool unresolves the table
+    catalog.DropDescriptorPool(1);
+    ASSERT_NO_THROW(script.Analyze());
+    auto& reanalyzed = script.GetAnalyzedScript();
+    auto& rel_expr2 =
+        std::get<AnalyzedScript::TableReference::RelationExpression>(reanalyzed->table_references[0].inner);
+    EXPECT_FALSE(rel_expr2.resolved_table.has_value());
+}
+
+TEST(CatalogTest, TableColumnStoreIndexesColumns) {
+    Catalog catalog;
+    ASSERT_NO_THROW(catalog.AddDescriptorPool(1, 0));
+    auto descriptor = PackSchemaDescriptor("db1", "schema1", {{"table1", {"z", "a", "m"}}, {"table2", {"m"}}});
+    auto data = descriptor.data();
+    ASSERT_NO_THROW(catalog.AddSchemaDescriptor(1, data, std::move(descriptor.buffer), data.size()));
+    auto other = PackSchemaDescriptor("db1", "schema2", {{"table3", {"a", "m"}}});
+    auto other_data = other.data();
+    ASSERT_NO_THROW(catalog.AddSchemaDescriptor(1, other_data, std::move(other.buffer), other_data.size()));
+
+    // Columns are found in the ranges of their tables and keep their ordinal position
+    Script script{catalog};
+    script.InsertTextAt(0, "select 1");
+    ASSERT_NO_THROW(script.Analyze());
+    auto* table1 = catalog.ResolveTable(ExternalObjectID{1, 0});
+    ASSERT_NE(table1, nullptr);
+    ASSERT_NE(table1->FindColumn("m"), nullptr);
+    EXPECT_EQ(table1->FindColumn("m")->GetColumnIndex(), 2);
+    EXPECT_EQ(table1->FindColumn("z")->GetColumnIndex(), 0);
+    EXPECT_EQ(table1->FindColumn("b"), nullptr);
+
+    // Columns are found by name across all tables and descriptors
+    std::vector<CatalogEntry::TableColumn> columns;
+    script.analyzed_script->ResolveTableColumnsWithCatalog("m", columns);
+    ASSERT_EQ(columns.size(), 3);
+    EXPECT_EQ(columns[0].GetTableID().GetObject(), 0);
+    EXPECT_EQ(columns[1].GetTableID().GetObject(), 1);
+    EXPECT_EQ(columns[2].GetTableID().GetObject(), 2);
+    columns.clear();
+    script.analyzed_script->ResolveTableColumnsWithCatalog("a", columns);
+    EXPECT_EQ(columns.size(), 2);
+}
+
+TEST(CatalogTest, DescriptorPoolRejectsInvalidDescriptors) {
+    Catalog catalog;
+    auto descriptor = PackSchemaDescriptor("db1", "schema1", {{"table1", {"a"}}});
+    auto data = descriptor.data();
+    ASSERT_THROW(catalog.AddSchemaDescriptor(1, data, nullptr, 0), Exception);
+
+    ASSERT_NO_THROW(catalog.AddDescriptorPool(1, 0));
+    ASSERT_THROW(catalog.AddDescriptorPool(1, 0), Exception);
+    ASSERT_NO_THROW(catalog.AddSchemaDescriptor(1, data, std::move(descriptor.buffer), data.size()));
+    auto version = catalog.GetVersion();
+
+    // Table names must be unique within the pool
+    auto collision = PackSchemaDescriptor("db1", "schema1", {{"table2", {"b"}}, {"table1", {"c"}}});
+    auto collision_data = collision.data();
+    ASSERT_THROW(catalog.AddSchemaDescriptor(1, collision_data, std::move(collision.buffer), collision_data.size()),
+                 Exception);
+    // Table names must not be empty
+    auto empty = PackSchemaDescriptor("db1", "schema1", {{"", {"b"}}});
+    auto empty_data = empty.data();
+    ASSERT_THROW(catalog.AddSchemaDescriptor(1, empty_data, std::move(empty.buffer), empty_data.size()), Exception);
+
+    // Rejected descriptors leave the pool untouched
+    EXPECT_EQ(catalog.GetVersion(), version);
+    auto stats = catalog.GetStatistics();
+    ASSERT_EQ(stats->entries.size(), 1);
+    EXPECT_EQ(stats->entries[0]->content->table_count(), 1);
+}
+
+TEST(CatalogTest, DescriptorPoolRejectsCorruptedBuffers) {
+    Catalog catalog;
+    ASSERT_NO_THROW(catalog.AddDescriptorPool(1, 0));
+    auto version = catalog.GetVersion();
+    auto descriptor = PackSchemaDescriptor("db1", "schema1", {{"table1", {"a", "b"}}});
+    auto expect_invalid = [](auto&& add) {
+        try {
+            add();
+            FAIL() << "corrupted descriptor was accepted";
+        } catch (const Exception& e) {
+            EXPECT_EQ(e.GetCode(), buffers::status::StatusCode::CATALOG_DESCRIPTOR_INVALID);
+        }
+    };
+    auto copy = [&](size_t size) {
+        auto buffer = std::make_unique<std::byte[]>(size);
+        std::memcpy(buffer.get(), descriptor.buffer.get(), std::min(size, descriptor.size));
+        return buffer;
+    };
+
+    // Root offset points past the end of the buffer
+    auto root_out_of_bounds = copy(descriptor.size);
+    std::memset(root_out_of_bounds.get(), 0xFF, sizeof(uint32_t));
+    std::span<const std::byte> root_out_of_bounds_data{root_out_of_bounds.get(), descriptor.size};
+    expect_invalid([&]() {
+        catalog.AddSchemaDescriptor(1, root_out_of_bounds_data, std::move(root_out_of_bounds), descriptor.size);
+    });
+    // Buffer is truncated
+    auto truncated_size = descriptor.size / 2;
+    auto truncated = copy(truncated_size);
+    std::span<const std::byte> truncated_data{truncated.get(), truncated_size};
+    expect_invalid([&]() { catalog.AddSchemaDescriptor(1, truncated_data, std::move(truncated), truncated_size); });
+    // Descriptor lists are verified as well
+    auto garbage = copy(descriptor.size);
+    std::memset(garbage.get(), 0xFF, descriptor.size);
+    std::span<const std::byte> garbage_data{garbage.get(), descriptor.size};
+    expect_invalid([&]() { catalog.AddSchemaDescriptors(1, garbage_data, std::move(garbage), descriptor.size); });
+
+    // Rejected buffers leave the pool untouched
+    EXPECT_EQ(catalog.GetVersion(), version);
+    auto data = descriptor.data();
+    ASSERT_NO_THROW(catalog.AddSchemaDescriptor(1, data, std::move(descriptor.buffer), data.size()));
+}
+
+TEST(CatalogTest, ResolvesUnqualifiedTablesByRank) {
+    using RelationExpression = AnalyzedScript::TableReference::RelationExpression;
+    Catalog catalog;
+    Script schema{catalog};
+    schema.InsertTextAt(0, "create table foo (a int); create table bar (b int);");
+    ASSERT_NO_THROW(schema.Analyze());
+    ASSERT_NO_THROW(catalog.LoadScript(schema, 1));
+
+    // The pool ranks before the schema script
+    CatalogEntryID pool_id = 100;
+    ASSERT_NO_THROW(catalog.AddDescriptorPool(pool_id, 0));
+    auto descriptor = PackSchemaDescriptor("db1", "schema1", {{"foo", {"c"}}});
+    auto data = descriptor.data();
+    ASSERT_NO_THROW(catalog.AddSchemaDescriptor(pool_id, data, std::move(descriptor.buffer), data.size()));
+
+    Script script{catalog};
+    script.InsertTextAt(0, "select * from foo, bar, baz");
+    auto find_relation = [&](std::string_view table_name) -> const RelationExpression& {
+        auto& refs = script.GetAnalyzedScript()->table_references;
+        for (size_t i = 0; i < refs.GetSize(); ++i) {
+            auto& rel_expr = std::get<RelationExpression>(refs[i].inner);
+            if (rel_expr.table_name.table_name.get().text == table_name) {
+                return rel_expr;
+            }
+        }
+        throw std::logic_error("missing table reference");
+    };
+    auto resolved_origin = [](const RelationExpression& rel_expr) {
+        return rel_expr.resolved_table->catalog_table_id.UnpackTableID().GetOrigin();
+    };
+
+    ASSERT_NO_THROW(script.Analyze());
+    auto& foo = find_relation("foo");
+    ASSERT_TRUE(foo.resolved_table.has_value());
+    EXPECT_EQ(resolved_origin(foo), pool_id);
+    ASSERT_EQ(foo.resolved_alternatives.size(), 1);
+    EXPECT_EQ(foo.resolved_alternatives[0].catalog_table_id.UnpackTableID().GetOrigin(), schema.GetCatalogEntryId());
+    auto& bar = find_relation("bar");
+    ASSERT_TRUE(bar.resolved_table.has_value());
+    EXPECT_EQ(resolved_origin(bar), schema.GetCatalogEntryId());
+    EXPECT_TRUE(bar.resolved_alternatives.empty());
+    EXPECT_FALSE(find_relation("baz").resolved_table.has_value());
+
+    // Dropping the pool leaves the table of the schema script
+    catalog.DropDescriptorPool(pool_id);
+    ASSERT_NO_THROW(script.Analyze());
+    auto& foo2 = find_relation("foo");
+    ASSERT_TRUE(foo2.resolved_table.has_value());
+    EXPECT_EQ(resolved_origin(foo2), schema.GetCatalogEntryId());
+    EXPECT_TRUE(foo2.resolved_alternatives.empty());
+
+    // Updating the schema script re-indexes its tables
+    schema.ReplaceText("create table baz (a int); create table bar (b int);");
+    ASSERT_NO_THROW(schema.Analyze());
+    ASSERT_NO_THROW(catalog.LoadScript(schema, 1));
+    ASSERT_NO_THROW(script.Analyze());
+    EXPECT_FALSE(find_relation("foo").resolved_table.has_value());
+    EXPECT_TRUE(find_relation("bar").resolved_table.has_value());
+    EXPECT_TRUE(find_relation("baz").resolved_table.has_value());
+
+    // Dropping the schema script unresolves all tables
+    catalog.DropScript(schema);
+    ASSERT_NO_THROW(script.Analyze());
+    EXPECT_FALSE(find_relation("foo").resolved_table.has_value());
+    EXPECT_FALSE(find_relation("bar").resolved_table.has_value());
+    EXPECT_FALSE(find_relation("baz").resolved_table.has_value());
+}
+
+TEST(CatalogTest, MemoizesTableResolutions) {
+    Catalog catalog;
+    Script schema{catalog};
+    schema.InsertTextAt(0, "create table foo (a int);");
+    ASSERT_NO_THROW(schema.Analyze());
+    ASSERT_NO_THROW(catalog.LoadScript(schema, 1));
+
+    // Every statement resolves foo through the catalog, only the first one misses
+    Script script{catalog};
+    script.InsertTextAt(0, "select * from foo; select a from foo; select a from foo f;");
+    ASSERT_NO_THROW(script.Analyze());
+    auto stats = catalog.GetStatistics();
+    ASSERT_NE(stats->resolution, nullptr);
+    EXPECT_EQ(stats->resolution->table_resolution_cache_misses(), 1);
+    EXPECT_EQ(stats->resolution->table_resolution_cache_hits(), 2);
+    EXPECT_EQ(stats->resolution->table_resolution_cache_entries(), 1);
+    EXPECT_EQ(stats->resolution->table_resolution_cache_invalidations(), 0);
+    script.analyzed_script->table_references.ForEach([](size_t, auto& ref) {
+        auto& rel_expr = std::get<AnalyzedScript::TableReference::RelationExpression>(ref.inner);
+        EXPECT_TRUE(rel_expr.resolved_table.has_value());
+    });
+
+    // Modifying the catalog invalidates the memoized resolutions
+    schema.ReplaceText("create table bar (a int);");
+    ASSERT_NO_THROW(schema.Analyze());
+    ASSERT_NO_THROW(catalog.LoadScript(schema, 1));
+    ASSERT_NO_THROW(script.Analyze());
+    stats = catalog.GetStatistics();
+    EXPECT_EQ(stats->resolution->table_resolution_cache_invalidations(), 1);
+    EXPECT_EQ(stats->resolution->table_resolution_cache_misses(), 2);
+    script.analyzed_script->table_references.ForEach([](size_t, auto& ref) {
+        auto& rel_expr = std::get<AnalyzedScript::TableReference::RelationExpression>(ref.inner);
+        EXPECT_FALSE(rel_expr.resolved_table.has_value());
+    });
+}
+
+TEST(CatalogTest, SnapshotsPinCatalogVersions) {
+    Catalog catalog;
+    Script schema{catalog};
+    schema.InsertTextAt(0, "create table foo (a int);");
+    ASSERT_NO_THROW(schema.Analyze());
+    ASSERT_NO_THROW(catalog.LoadScript(schema, 1));
+    ASSERT_NO_THROW(catalog.AddDescriptorPool(100, 0));
+    auto descriptor = PackSchemaDescriptor("db1", "schema1", {{"table1", {"a"}}});
+    auto data = descriptor.data();
+    ASSERT_NO_THROW(catalog.AddSchemaDescriptor(100, data, std::move(descriptor.buffer), data.size()));
+
+    NameRegistry names;
+    auto& empty = names.Register("");
+    auto& db1 = names.Register("db1");
+    auto& schema1 = names.Register("schema1");
+    auto resolve = [&](const CatalogSnapshot& snapshot, RegisteredName& db, RegisteredName& schema,
+                       std::string_view table) {
+        CatalogEntry::QualifiedTableName name{std::nullopt, db, schema, names.Register(table)};
+        CatalogSnapshot::ResolvedTables out;
+        snapshot.ResolveTable(name, 0, out, 2);
+        return out;
+    };
+
+    // Readers share the snapshot until the catalog is modified
+    auto snapshot = catalog.GetSnapshot();
+    EXPECT_EQ(snapshot->GetVersion(), catalog.GetVersion());
+    EXPECT_EQ(catalog.GetSnapshot(), snapshot);
+    auto foo = resolve(*snapshot, empty, empty, "foo");
+    ASSERT_EQ(foo.size(), 1);
+    auto table1 = resolve(*snapshot, db1, schema1, "table1");
+    ASSERT_EQ(table1.size(), 1);
+
+    // Modify the script and the pool while the snapshot is pinned
+    auto version = catalog.GetVersion();
+    schema.ReplaceText("create table bar (a int);");
+    ASSERT_NO_THROW(schema.Analyze());
+    ASSERT_NO_THROW(catalog.LoadScript(schema, 1));
+    auto other = PackSchemaDescriptor("db1", "schema1", {{"table2", {"b"}}});
+    auto other_data = other.data();
+    ASSERT_NO_THROW(catalog.AddSchemaDescriptor(100, other_data, std::move(other.buffer), other_data.size()));
+
+    // The pinned snapshot still sees the old version
+    EXPECT_EQ(snapshot->GetVersion(), version);
+    EXPECT_EQ(resolve(*snapshot, empty, empty, "foo").size(), 1);
+    EXPECT_TRUE(resolve(*snapshot, empty, empty, "bar").empty());
+    EXPECT_TRUE(resolve(*snapshot, db1, schema1, "table2").empty());
+    auto pinned_table1 = resolve(*snapshot, db1, schema1, "table1");
+    ASSERT_EQ(pinned_table1.size(), 1);
+    EXPECT_EQ(&pinned_table1[0].get(), &table1[0].get());
+
+    // The latest snapshot sees the new version
+    auto latest = catalog.GetSnapshot();
+    EXPECT_NE(latest, snapshot);
+    EXPECT_EQ(latest->GetVersion(), catalog.GetVersion());
+    EXPECT_TRUE(resolve(*latest, empty, empty, "foo").empty());
+    EXPECT_EQ(resolve(*latest, empty, empty, "bar").size(), 1);
+    EXPECT_EQ(resolve(*latest, db1, schema1, "table2").size(), 1);
+    auto latest_table1 = resolve(*latest, db1, schema1, "table1");
+    ASSERT_EQ(latest_table1.size(), 1);
+    EXPECT_EQ(latest_table1[0].get().GetTableID().Pack(), table1[0].get().GetTableID().Pack());
+    EXPECT_EQ(latest_table1[0].get().catalog_version, table1[0].get().catalog_version);
+
+    // Scripts resolve against the latest snapshot
+    Script script{catalog};
+    script.InsertTextAt(0, "select * from db1.schema1.table2");
+    ASSERT_NO_THROW(script.Analyze());
+    auto& rel_expr =
+        std::get<AnalyzedScript::TableReference::RelationExpression>(script.analyzed_script->table_references[0].inner);
+    EXPECT_TRUE(rel_expr.resolved_table.has_value());
+    EXPECT_EQ(script.analyzed_script->GetCatalogVersion(), catalog.GetVersion());
+}
+
+TEST(CatalogTest, SnapshotsShareUnmodifiedEntries) {
+    Catalog catalog;
+    Script schema{catalog};
+    schema.InsertTextAt(0, "create table foo (a int);");
+    ASSERT_NO_THROW(schema.Analyze());
+    ASSERT_NO_THROW(catalog.LoadScript(schema, 1));
+    ASSERT_NO_THROW(catalog.AddDescriptorPool(100, 0));
+    auto add_table = [&](std::string_view table_name) {
+        auto descriptor = PackSchemaDescriptor("db1", "schema1", {{std::string{table_name}, {"a"}}});
+        auto data = descriptor.data();
+        catalog.AddSchemaDescriptor(100, data, std::move(descriptor.buffer), data.size());
+    };
+    auto find_entry = [](const CatalogSnapshot& snapshot, CatalogEntryID id) {
+        const CatalogEntry* found = nullptr;
+        snapshot.Iterate([&](CatalogEntryID entry_id, const CatalogEntry& entry) {
+            if (entry_id == id) found = &entry;
+        });
+        return found;
+    };
+    ASSERT_NO_THROW(add_table("table1"));
+
+    // Without pinned snapshots, descriptors are added to the pool in place
+    auto* pool = find_entry(*catalog.GetSnapshot(), 100);
+    ASSERT_NE(pool, nullptr);
+    ASSERT_NO_THROW(add_table("table2"));
+    auto snapshot = catalog.GetSnapshot();
+    EXPECT_EQ(find_entry(*snapshot, 100), pool);
+    EXPECT_EQ(find_entry(*snapshot, schema.GetCatalogEntryId()), schema.analyzed_script.get());
+
+    // A pinned snapshot keeps the pool, the catalog continues with a clone
+    ASSERT_NO_THROW(add_table("table3"));
+    auto latest = catalog.GetSnapshot();
+    EXPECT_EQ(find_entry(*snapshot, 100), pool);
+    EXPECT_NE(find_entry(*latest, 100), pool);
+    EXPECT_EQ(find_entry(*latest, schema.GetCatalogEntryId()), schema.analyzed_script.get());
+    EXPECT_EQ(snapshot->GetDatabases().size(), latest->GetDatabases().size());
+    EXPECT_EQ(snapshot->GetSchemas().size(), latest->GetSchemas().size());
+
+    // Dropping an entry does not affect pinned snapshots
+    catalog.DropScript(schema);
+    EXPECT_NE(find_entry(*latest, schema.GetCatalogEntryId()), nullptr);
+    EXPECT_EQ(find_entry(*catalog.GetSnapshot(), schema.GetCatalogEntryId()), nullptr);
+}
+
+TEST(CatalogTest, DescriptorPoolSharesSegmentsWithSnapshots) {
+    Catalog catalog;
+    ASSERT_NO_THROW(catalog.AddDescriptorPool(100, 0));
+    auto add_tables = [&](size_t begin, size_t end) {
+        std::vector<std::pair<std::string, std::vector<std::string>>> tables;
+        for (size_t i = begin; i < end; ++i) {
+            tables.push_back({"table" + std::to_string(i), {"a", "col" + std::to_string(i)}});
+        }
+        auto descriptor = PackSchemaDescriptor("db1", "schema1", std::move(tables));
+        auto data = descriptor.data();
+        catalog.AddSchemaDescriptor(100, data, std::move(descriptor.buffer), data.size());
+    };
+    auto get_pool = [&]() {
+        DescriptorPool* pool = nullptr;
+        catalog.Iterate([&](CatalogEntryID, CatalogEntry& entry) { pool = dynamic_cast<DescriptorPool*>(&entry); });
+        return pool;
+    };
+    // The registry only holds views, the table names are kept alive here
+    NameRegistry names;
+    std::deque<std::string> table_names;
+    auto& db1 = names.Register("db1");
+    auto& schema1 = names.Register("schema1");
+    auto resolve = [&](const CatalogSnapshot& snapshot, std::string_view table) {
+        auto& table_name = names.Register(table_names.emplace_back(table));
+        CatalogEntry::QualifiedTableName name{std::nullopt, db1, schema1, table_name};
+        CatalogSnapshot::ResolvedTables out;
+        snapshot.ResolveTable(name, 0, out, 2);
+        return out.empty() ? nullptr : &out[0].get();
+    };
+    ASSERT_NO_THROW(add_tables(0, 16));
+
+    // A pinned snapshot shares the declarations with the catalog, only the new table is added
+    auto snapshot = catalog.GetSnapshot();
+    auto* pinned_table = resolve(*snapshot, "table3");
+    ASSERT_NE(pinned_table, nullptr);
+    ASSERT_NO_THROW(add_tables(16, 17));
+    auto latest = catalog.GetSnapshot();
+    EXPECT_EQ(resolve(*latest, "table3"), pinned_table);
+    EXPECT_EQ(resolve(*snapshot, "table16"), nullptr);
+    auto* new_table = resolve(*latest, "table16");
+    ASSERT_NE(new_table, nullptr);
+    EXPECT_EQ(new_table->GetTableID().GetObject(), 16);
+    EXPECT_EQ(catalog.ResolveTable(new_table->GetTableID()), new_table);
+    EXPECT_EQ(catalog.ResolveTable(pinned_table->GetTableID()), pinned_table);
+    ASSERT_NE(get_pool(), nullptr);
+    EXPECT_EQ(get_pool()->GetSegments().size(), 2);
+    snapshot.reset();
+    latest.reset();
+
+    // Every add with a pinned snapshot appends a segment, merging keeps the segment count logarithmic
+    for (size_t i = 17; i < 256; ++i) {
+        auto pinned = catalog.GetSnapshot();
+        ASSERT_NO_THROW(add_tables(i, i + 1));
+        EXPECT_LE(get_pool()->GetSegments().size(), 10);
+    }
+
+    // All tables remain resolvable by id and name
+    latest = catalog.GetSnapshot();
+    for (uint32_t i = 0; i < 256; ++i) {
+        auto* table = resolve(*latest, "table" + std::to_string(i));
+        ASSERT_NE(table, nullptr);
+        EXPECT_EQ(table->GetTableID().GetObject(), i);
+        EXPECT_EQ(catalog.ResolveTable(ExternalObjectID{100, i}), table);
+        ASSERT_NE(table->FindColumn("col" + std::to_string(i)), nullptr);
+    }
+
+    // Columns and names are found in all segments
+    Script script{catalog};
+    script.InsertTextAt(0, "select 1");
+    ASSERT_NO_THROW(script.Analyze());
+    std::vector<CatalogEntry::TableColumn> columns;
+    script.analyzed_script->ResolveTableColumnsWithCatalog("col200", columns);
+    ASSERT_EQ(columns.size(), 1);
+    EXPECT_EQ(columns[0].GetTableID().GetObject(), 200);
+    columns.clear();
+    script.analyzed_script->ResolveTableColumnsWithCatalog("a", columns);
+    EXPECT_EQ(columns.size(), 256);
+    auto* pool = get_pool();
+    size_t prefix_matches = 0;
+    for (size_t i = 0; i < pool->GetNameSearchIndexCount(); ++i) {
+        prefix_matches += pool->GetNameSearchIndex(i).FindPrefixes("table200").size();
+    }
+    EXPECT_EQ(prefix_matches, 1);
+
+    // The segments flatten to a single schema
+    flatbuffers::FlatBufferBuilder fb;
+    fb.Finish(catalog.Flatten(fb));
+    auto flat = flatbuffers::GetRoot<buffers::catalog::FlatCatalog>(fb.GetBufferPointer());
+    EXPECT_EQ(flat->databases()->size(), 1);
+    EXPECT_EQ(flat->schemas()->size(), 1);
+    EXPECT_EQ(flat->tables()->size(), 256);
+    auto stats = catalog.GetStatistics();
+    ASSERT_EQ(stats->entries.size(), 1);
+    EXPECT_EQ(stats->entries[0]->content->table_count(), 256);
+    EXPECT_EQ(stats->entries[0]->memory->descriptor_buffer_count(), 241);
+}
+
+TEST(CatalogTest, FlattenDeltaSinceVersion) {
+    Catalog catalog;
+    Script schema{catalog};
+    schema.InsertTextAt(0, "create table foo (a int);");
+    ASSERT_NO_THROW(schema.Analyze());
+    ASSERT_NO_THROW(catalog.LoadScript(schema, 1));
+    ASSERT_NO_THROW(catalog.AddDescriptorPool(100, 0));
+    auto descriptor = PackSchemaDescriptor("db1", "schema1", {{"table1", {"a", "b"}}});
+    auto data = descriptor.data();
+    ASSERT_NO_THROW(catalog.AddSchemaDescriptor(100, data, std::move(descriptor.buffer), data.size()));
+
+    flatbuffers::FlatBufferBuilder fb;
+    auto flatten_delta = [&](CatalogVersion since_version) {
+        fb.Clear();
+        fb.Finish(catalog.FlattenDelta(fb, since_version));
+        return flatbuffers::GetRoot<buffers::catalog::FlatCatalogDelta>(fb.GetBufferPointer());
+    };
+    auto table_names = [](const buffers::catalog::FlatCatalogFragment& fragment) {
+        auto* flat = flatbuffers::GetRoot<buffers::catalog::FlatCatalog>(fragment.flat_catalog()->data());
+        std::vector<std::string_view> names;
+        for (auto* table : *flat->tables()) {
+            names.push_back(flat->name_dictionary()->Get(table->name_id())->string_view());
+        }
+        return names;
+    };
+
+    // The delta since the beginning contains all entries in ranked order
+    auto delta = flatten_delta(0);
+    EXPECT_EQ(delta->catalog_version(), catalog.GetVersion());
+    EXPECT_FALSE(delta->reset());
+    EXPECT_EQ(delta->dropped_entries()->size(), 0);
+    ASSERT_EQ(delta->updated_entries()->size(), 2);
+    EXPECT_EQ(delta->updated_entries()->Get(0)->catalog_entry_id(), 100);
+    EXPECT_EQ(delta->updated_entries()->Get(0)->rank(), 0);
+    EXPECT_EQ(delta->updated_entries()->Get(1)->catalog_entry_id(), schema.GetCatalogEntryId());
+    EXPECT_EQ(table_names(*delta->updated_entries()->Get(0)), std::vector<std::string_view>{"table1"});
+    EXPECT_EQ(table_names(*delta->updated_entries()->Get(1)), std::vector<std::string_view>{"foo"});
+    auto* pool_flat = flatbuffers::GetRoot<buffers::catalog::FlatCatalog>(
+        delta->updated_entries()->Get(0)->flat_catalog()->data());
+    EXPECT_EQ(pool_flat->columns()->size(), 2);
+
+    // Nothing changed since the current version
+    auto version = catalog.GetVersion();
+    delta = flatten_delta(version);
+    EXPECT_EQ(delta->dropped_entries()->size(), 0);
+    EXPECT_EQ(delta->updated_entries()->size(), 0);
+
+    // A version from the future resets the client
+    delta = flatten_delta(version + 1);
+    EXPECT_TRUE(delta->reset());
+    EXPECT_EQ(delta->dropped_entries()->size(), 0);
+    EXPECT_EQ(delta->updated_entries()->size(), 2);
+
+    // Updating the script only flattens the script again
+    auto* pool_fragment = catalog.GetFlatFragment(100);
+    ASSERT_NE(pool_fragment, nullptr);
+    auto* pool_fragment_data = pool_fragment->buffer.data();
+    schema.ReplaceText("create table bar (a int);");
+    ASSERT_NO_THROW(schema.Analyze());
+    ASSERT_NO_THROW(catalog.LoadScript(schema, 1));
+    delta = flatten_delta(version);
+    EXPECT_EQ(delta->since_version(), version);
+    ASSERT_EQ(delta->updated_entries()->size(), 1);
+    EXPECT_EQ(delta->updated_entries()->Get(0)->catalog_entry_id(), schema.GetCatalogEntryId());
+    EXPECT_EQ(delta->updated_entries()->Get(0)->catalog_version(), catalog.GetVersion());
+    EXPECT_EQ(table_names(*delta->updated_entries()->Get(0)), std::vector<std::string_view>{"bar"});
+
+    // The unchanged pool reuses its cached fragment
+    delta = flatten_delta(0);
+    ASSERT_EQ(delta->updated_entries()->size(), 2);
+    EXPECT_EQ(catalog.GetFlatFragment(100), pool_fragment);
+    EXPECT_EQ(catalog.GetFlatFragment(100)->buffer.data(), pool_fragment_data);
+
+    // Dropped entries are listed
+    version = catalog.GetVersion();
+    catalog.DropDescriptorPool(100);
+    delta = flatten_delta(version);
+    ASSERT_EQ(delta->dropped_entries()->size(), 1);
+    EXPECT_EQ(delta->dropped_entries()->Get(0), 100);
+    EXPECT_EQ(delta->updated_entries()->size(), 0);
+
+    // The full catalog is flattened from the entries
+    fb.Clear();
+    fb.Finish(catalog.Flatten(fb));
+    auto* flat = flatbuffers::GetRoot<buffers::catalog::FlatCatalog>(fb.GetBufferPointer());
+    ASSERT_EQ(flat->tables()->size(), 1);
+    EXPECT_EQ(flat->name_dictionary()->Get(flat->tables()->Get(0)->name_id())->string_view(), "bar");
+
+    // Clearing the catalog forgets the dropped entries
+    catalog.Clear();
+    delta = flatten_delta(version);
+    EXPECT_TRUE(delta->reset());
+    EXPECT_EQ(delta->dropped_entries()->size(), 0);
+    EXPECT_EQ(delta->updated_entries()->size(), 0);
+}
+
 }  // namespace
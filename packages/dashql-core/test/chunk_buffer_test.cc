@@ -1,5 +1,7 @@
 #include "dashql/utils/chunk_buffer.h"
 
+#include <vector>
+
 #include "gtest/gtest.h"
 
 using namespace dashql;
@@ -15,4 +17,31 @@ TEST(ChunkBufferTest, Sequence) {
     ASSERT_EQ(tree.GetSize(), 1024);
 }
 
+TEST(ChunkBufferTest, PushBackNIsContiguous) {
+    ChunkBuffer<uint32_t, 4> buffer;
+    std::vector<uint32_t*> first_values;
+    uint32_t next = 0;
+    for (size_t n : {3, 1, 10, 0, 7, 64}) {
+        std::vector<uint32_t> values(n);
+        for (auto& value : values) {
+            value = next++;
+        }
+        auto appended = buffer.PushBackN(values);
+        ASSERT_EQ(appended.size(), n);
+        for (size_t i = 0; i < n; ++i) {
+            ASSERT_EQ(appended[i], values[i]);
+        }
+        if (n > 0) {
+            first_values.push_back(&appended[0]);
+        }
+    }
+    ASSERT_EQ(buffer.GetSize(), next);
+    for (uint32_t i = 0; i < next; ++i) {
+        ASSERT_EQ(buffer[i], i);
+    }
+    // Earlier values are never moved
+    ASSERT_EQ(*first_values[0], 0);
+    ASSERT_EQ(*first_values.back(), next - 64);
+}
+
 }  // namespace
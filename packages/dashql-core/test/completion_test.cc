@@ -84,6 +84,147 @@ SELECT s_co
     ASSERT_EQ(names, expected_names);
 }
 
+TEST(CompletionTest, ExtendingTheNameReusesIndexLookups) {
+    Catalog catalog;
+    Script schema{catalog};
+    schema.InsertTextAt(0, TPCH_SCHEMA);
+    ASSERT_NO_THROW(schema.Analyze());
+    ASSERT_NO_THROW(catalog.LoadScript(schema, 0));
+
+    auto collect_names = [](const Completion& completion) {
+        std::vector<std::string> names;
+        for (auto& candidate : completion.GetResultCandidates()) {
+            names.emplace_back(candidate.completion_text);
+        }
+        return names;
+    };
+
+    // Type the name character by character
+    Script script{catalog};
+    script.InsertTextAt(0, "select ");
+    std::string text = "select ";
+    for (char c : std::string_view{"c_cus"}) {
+        script.InsertTextAt(text.size(), std::string_view{&c, 1});
+        text += c;
+        ASSERT_NO_THROW(script.Analyze());
+        script.MoveCursor(text.size());
+        auto completion = script.CompleteAtCursor(20);
+
+        // Complete the same text in a fresh script without cached lookups
+        Script fresh{catalog};
+        fresh.InsertTextAt(0, text);
+        ASSERT_NO_THROW(fresh.Analyze());
+        fresh.MoveCursor(text.size());
+        auto expected = fresh.CompleteAtCursor(20);
+        ASSERT_EQ(collect_names(*completion), collect_names(*expected)) << text;
+    }
+    ASSERT_NE(script.completion_cache, nullptr);
+    EXPECT_EQ(script.completion_cache->misses, 1);
+    EXPECT_EQ(script.completion_cache->hits, 4);
+    EXPECT_NE(FindCandidate(*script.CompleteAtCursor(20), "c_custkey"), nullptr);
+
+    // Changing the catalog invalidates the lookups
+    Script other{catalog};
+    other.InsertTextAt(0, "create table c_cust_extra (c_custom int);");
+    ASSERT_NO_THROW(other.Analyze());
+    ASSERT_NO_THROW(catalog.LoadScript(other, 1));
+    auto completion = script.CompleteAtCursor(20);
+    EXPECT_EQ(script.completion_cache->misses, 2);
+    EXPECT_NE(FindCandidate(*completion, "c_custom"), nullptr);
+}
+
+TEST(CompletionTest, PrunesIndexMatchesBelowTopCandidates) {
+    Catalog catalog;
+    std::vector<std::unique_ptr<Script>> schemas;
+    for (size_t i = 0; i < 8; ++i) {
+        auto id = std::to_string(i);
+        auto& schema = schemas.emplace_back(std::make_unique<Script>(catalog));
+        schema->InsertTextAt(0, "create table t_" + id + " (kol_" + id + "_a int, kol_" + id + "_b int, xkol_" + id +
+                                    "_a int, xkol_" + id + "_b int);");
+        ASSERT_NO_THROW(schema->Analyze());
+        ASSERT_NO_THROW(catalog.LoadScript(*schema, i));
+    }
+
+    auto collect_names = [](const Completion& completion) {
+        std::vector<std::string> names;
+        for (auto& candidate : completion.GetResultCandidates()) {
+            names.emplace_back(candidate.completion_text);
+        }
+        return names;
+    };
+
+    std::string_view text = "select kol";
+    Script script{catalog};
+    script.InsertTextAt(0, text);
+    ASSERT_NO_THROW(script.Analyze());
+    const ScriptCursor* cursor = nullptr;
+    ASSERT_NO_THROW(cursor = script.MoveCursor(text.size()));
+    ASSERT_NE(cursor, nullptr);
+
+    // Substring matches like xkol_* cannot outrank the prefix matches once the top-k are settled
+    auto completion = Completion::Compute(*cursor, 5);
+    EXPECT_GT(completion->GetPrunedIndexMatchCount(), 0);
+    for (auto& name : collect_names(*completion)) {
+        EXPECT_FALSE(name.starts_with("xkol")) << name;
+    }
+    EXPECT_NE(FindCandidate(*completion, "kol_0_a"), nullptr);
+
+    // The exhaustive search yields the same top-k candidates
+    auto exhaustive = Completion::Compute(*cursor, 5, nullptr, false);
+    EXPECT_EQ(exhaustive->GetPrunedIndexMatchCount(), 0);
+    auto& pruned_candidates = completion->GetResultCandidates();
+    auto& exhaustive_candidates = exhaustive->GetResultCandidates();
+    ASSERT_EQ(pruned_candidates.size(), exhaustive_candidates.size());
+    for (size_t i = 0; i < pruned_candidates.size(); ++i) {
+        EXPECT_EQ(pruned_candidates[i].completion_text, exhaustive_candidates[i].completion_text) << i;
+        EXPECT_EQ(pruned_candidates[i].score, exhaustive_candidates[i].score) << i;
+    }
+}
+
+TEST(CompletionTest, PrunesIndexesWithoutPrefixMatches) {
+    Catalog catalog;
+    std::vector<std::unique_ptr<Script>> schemas;
+    for (size_t i = 0; i < 16; ++i) {
+        auto id = std::to_string(i);
+        auto& schema = schemas.emplace_back(std::make_unique<Script>(catalog));
+        // The higher ranked entries only hold substring matches
+        if (i < 8) {
+            schema->InsertTextAt(0, "create table t_" + id + " (kol_" + id + "_a int, kol_" + id + "_b int);");
+        } else {
+            schema->InsertTextAt(0, "create table t_" + id + " (xkol_" + id + "_a int, xkol_" + id + "_b int);");
+        }
+        ASSERT_NO_THROW(schema->Analyze());
+        ASSERT_NO_THROW(catalog.LoadScript(*schema, i));
+    }
+
+    std::string_view text = "select kol";
+    Script script{catalog};
+    script.InsertTextAt(0, text);
+    ASSERT_NO_THROW(script.Analyze());
+    const ScriptCursor* cursor = nullptr;
+    ASSERT_NO_THROW(cursor = script.MoveCursor(text.size()));
+    ASSERT_NE(cursor, nullptr);
+
+    // The entries without prefix matches cannot lift unknown names into the top-k candidates
+    auto completion = Completion::Compute(*cursor, 5);
+    EXPECT_GT(completion->GetPrunedIndexCount(), 0);
+    auto exhaustive = Completion::Compute(*cursor, 5, nullptr, false);
+    EXPECT_EQ(exhaustive->GetPrunedIndexCount(), 0);
+    auto parallel = Completion::Compute(*cursor, 5, nullptr, true, true);
+    EXPECT_EQ(parallel->GetPrunedIndexCount(), completion->GetPrunedIndexCount());
+
+    // All searches yield the same top-k candidates
+    auto& pruned_candidates = completion->GetResultCandidates();
+    for (auto* other : {exhaustive.get(), parallel.get()}) {
+        auto& other_candidates = other->GetResultCandidates();
+        ASSERT_EQ(pruned_candidates.size(), other_candidates.size());
+        for (size_t i = 0; i < pruned_candidates.size(); ++i) {
+            EXPECT_EQ(pruned_candidates[i].completion_text, other_candidates[i].completion_text) << i;
+            EXPECT_EQ(pruned_candidates[i].score, other_candidates[i].score) << i;
+        }
+    }
+}
+
 TEST(CompletionTest, DotCompletionBeforeLaterCteLines) {
     Catalog catalog;
     Script schema{catalog};
@@ -234,4 +234,30 @@ TEST(CursorTest, TableRef) {
          });
 }
 
+TEST(CursorTest, ReusesPathWithinLeaf) {
+    Catalog catalog;
+    Script script{catalog};
+    std::string_view text =
+        "select r_regionkey from region;\nselect n_nationkey, n_name from nation n where n.n_name = 'x';";
+    script.InsertTextAt(0, text);
+    ASSERT_NO_THROW(script.Analyze());
+
+    // Sweep the cursor over the text and compare with cursors that are placed without a previous cursor
+    for (size_t offset = 0; offset <= text.size(); ++offset) {
+        SCOPED_TRACE(std::string{"CURSOR "} + std::to_string(offset));
+        const ScriptCursor* moved = nullptr;
+        ASSERT_NO_THROW(moved = script.MoveCursor(offset));
+        auto fresh = ScriptCursor::Place(script, offset);
+        ASSERT_EQ(moved->statement_id, fresh->statement_id);
+        ASSERT_EQ(moved->ast_node_id, fresh->ast_node_id);
+        ASSERT_EQ(moved->ast_path_to_root, fresh->ast_path_to_root);
+        ASSERT_EQ(moved->name_scopes.size(), fresh->name_scopes.size());
+        for (size_t i = 0; i < moved->name_scopes.size(); ++i) {
+            ASSERT_EQ(&moved->name_scopes[i].get(), &fresh->name_scopes[i].get());
+        }
+        ASSERT_EQ(moved->context.index(), fresh->context.index());
+    }
+    EXPECT_GT(script.GetStatistics()->timings->cursor_last_elapsed(), 0);
+}
+
 }  // namespace
@@ -24,4 +24,23 @@ TEST(KeywordsTest, ScannerTokenIdsMatchGeneratedParser) {
     EXPECT_EQ(Keyword::Find("graph_table")->scanner_token, Parser::token::FQL_GRAPH_TABLE);
 }
 
+TEST(KeywordsTest, FindsAllKeywords) {
+    ASSERT_NO_THROW(Keyword::CheckIntegrity());
+    for (auto& keyword : Keyword::GetKeywords()) {
+        auto* found = Keyword::Find(keyword.name);
+        ASSERT_NE(found, nullptr) << keyword.name;
+        EXPECT_EQ(found->name, keyword.name);
+        EXPECT_EQ(found->scanner_token, keyword.scanner_token);
+    }
+}
+
+TEST(KeywordsTest, RejectsNonKeywords) {
+    // Share the length and the first and last bytes with keywords
+    for (auto text : {"", "selxct", "analyzx", "xmlattributez", "padding_iner", "paddinginner", "selects", "s"}) {
+        EXPECT_EQ(Keyword::Find(text), nullptr) << text;
+    }
+    // Lookups expect folded text
+    EXPECT_EQ(Keyword::Find("SELECT"), nullptr);
+}
+
 }  // namespace
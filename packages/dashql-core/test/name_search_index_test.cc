@@ -0,0 +1,128 @@
+#include <string_view>
+#include <vector>
+
+#include "dashql/text/names.h"
+#include "gtest/gtest.h"
+
+using namespace dashql;
+
+namespace {
+
+std::vector<std::string_view> find(const NameSearchIndex& index, std::string_view text) {
+    std::vector<std::string_view> out;
+    for (auto& suffix : index.FindSuffixes(text)) {
+        out.push_back(index.GetName(suffix).text);
+    }
+    return out;
+}
+
+std::vector<std::string_view> findPrefixes(const NameSearchIndex& index, std::string_view text) {
+    std::vector<std::string_view> out;
+    for (auto& prefix : index.FindPrefixes(text)) {
+        out.push_back(index.GetName(prefix).text);
+    }
+    return out;
+}
+
+TEST(NameSearchIndexTest, Empty) {
+    NameRegistry registry;
+    registry.Register("");
+    NameSearchIndex index{registry};
+    ASSERT_EQ(index.GetSize(), 0);
+    ASSERT_TRUE(find(index, "foo").empty());
+}
+
+TEST(NameSearchIndexTest, SubstringMatches) {
+    NameRegistry registry;
+    registry.Register("Customer");
+    registry.Register("customer_id");
+    registry.Register("order");
+    registry.Register("CUST");
+    NameSearchIndex index{registry};
+    ASSERT_EQ(index.GetSize(), 8 + 11 + 5 + 4);
+
+    // Matches are ordered by the matching suffix, ignoring case
+    ASSERT_EQ(find(index, "cust"), (std::vector<std::string_view>{"CUST", "Customer", "customer_id"}));
+    ASSERT_EQ(find(index, "CUST"), (std::vector<std::string_view>{"CUST", "Customer", "customer_id"}));
+    // Equal suffixes are ordered by the name text
+    ASSERT_EQ(find(index, "er"), (std::vector<std::string_view>{"Customer", "order", "customer_id"}));
+    ASSERT_EQ(find(index, "_ID"), (std::vector<std::string_view>{"customer_id"}));
+    ASSERT_TRUE(find(index, "xyz").empty());
+    ASSERT_TRUE(find(index, "customer_ids").empty());
+}
+
+TEST(NameSearchIndexTest, PrefixMatches) {
+    NameRegistry registry;
+    registry.Register("customer_id");
+    registry.Register("Customer");
+    registry.Register("id_customer");
+    registry.Register("aaa");
+    NameSearchIndex index{registry};
+
+    // Every name is matched once, a name that equals the text comes first
+    ASSERT_EQ(findPrefixes(index, "CUSTOMER"), (std::vector<std::string_view>{"Customer", "customer_id"}));
+    ASSERT_EQ(findPrefixes(index, "id"), (std::vector<std::string_view>{"id_customer"}));
+    ASSERT_EQ(findPrefixes(index, "a"), (std::vector<std::string_view>{"aaa"}));
+    ASSERT_EQ(findPrefixes(index, "").size(), 4);
+    ASSERT_TRUE(findPrefixes(index, "omer").empty());
+}
+
+TEST(NameSearchIndexTest, RepeatedSubstrings) {
+    NameRegistry registry;
+    registry.Register("aaa");
+    NameSearchIndex index{registry};
+    // Every suffix starting with the text is a match
+    ASSERT_EQ(find(index, "a").size(), 3);
+    ASSERT_EQ(find(index, "aa").size(), 2);
+    ASSERT_EQ(find(index, "aaa").size(), 1);
+    ASSERT_EQ(find(index, "").size(), 3);
+}
+
+TEST(NameSearchIndexTest, DeriveFromPrevious) {
+    NameRegistry previous_registry;
+    previous_registry.Register("Customer");
+    previous_registry.Register("order");
+    previous_registry.Register("cust_id");
+    previous_registry.Register("orders_total");
+    NameSearchIndex previous{previous_registry};
+
+    NameRegistry registry;
+    registry.Register("");
+    registry.Register("order");
+    registry.Register("region");
+    registry.Register("Customer");
+    registry.Register("orders_total");
+    NameSearchIndex derived{registry, previous};
+    NameSearchIndex rebuilt{registry};
+
+    ASSERT_EQ(derived.GetSize(), rebuilt.GetSize());
+    for (std::string_view text : {"", "o", "or", "ORDER", "er", "cust", "_id", "gion", "total", "x"}) {
+        SCOPED_TRACE(text);
+        ASSERT_EQ(find(derived, text), find(rebuilt, text));
+        ASSERT_EQ(findPrefixes(derived, text), findPrefixes(rebuilt, text));
+    }
+    // Derived names refer to the new registry
+    for (auto& suffix : derived.FindSuffixes("")) {
+        auto& name = derived.GetName(suffix);
+        ASSERT_EQ(&registry.At(name.name_id), &name);
+    }
+}
+
+TEST(NameSearchIndexTest, DeriveFromPreviousWithMostNamesRemoved) {
+    NameRegistry previous_registry;
+    previous_registry.Register("a_very_long_column_name");
+    previous_registry.Register("another_long_column_name");
+    previous_registry.Register("x");
+    NameSearchIndex previous{previous_registry};
+
+    NameRegistry registry;
+    registry.Register("x");
+    registry.Register("y");
+    NameSearchIndex derived{registry, previous};
+    NameSearchIndex rebuilt{registry};
+    ASSERT_EQ(derived.GetSize(), 2);
+    ASSERT_EQ(derived.GetByteSize(), rebuilt.GetByteSize());
+    ASSERT_EQ(find(derived, ""), find(rebuilt, ""));
+}
+
+}  // namespace
@@ -2,8 +2,10 @@
 
 #include <algorithm>
 #include <optional>
+#include <string>
 
 #include "dashql/buffers/index_generated.h"
+#include "dashql/catalog.h"
 #include "dashql/formatter/formatter.h"
 #include "dashql/parser/parse_context.h"
 #include "dashql/parser/scanner.h"
@@ -58,6 +60,65 @@ static std::shared_ptr<ParsedScript> ParseString(std::string_view text) {
     return Parser::Parse(scanned);
 }
 
+TEST(ParserTest, FindNodeAtOffsetMatchesExhaustiveDescent) {
+    std::string text = "select 1; select ";
+    for (size_t i = 0; i < 64; ++i) {
+        text += (i == 0 ? "" : ", ") + std::string{"col"} + std::to_string(i) + " + f(a, b, c)";
+    }
+    text += " from t1, t2 where x in (1, 2, 3, 4, 5, 6, 7, 8) and y between 1 and 2;\n";
+    text += "create table foo (a int, b int, c varchar(10), d int);";
+    auto parsed = ParseString(text);
+    ASSERT_EQ(parsed->errors.size(), 0);
+    ASSERT_EQ(parsed->statements.size(), 3);
+    auto& scan = *parsed->scanned_script;
+
+    // Descend by checking every child of every node
+    auto find_exhaustive = [&](size_t text_offset) -> std::optional<std::pair<size_t, size_t>> {
+        std::optional<size_t> statement_id;
+        for (size_t i = 0; i < parsed->statements.size(); ++i) {
+            auto root = parsed->statements[i].root;
+            if (scan.ResolveTextSpan(parsed->nodes[root].symbol_span()).offset() <= text_offset) {
+                statement_id = i;
+            }
+        }
+        if (!statement_id.has_value()) {
+            return std::nullopt;
+        }
+        size_t iter = parsed->statements[*statement_id].root;
+        while (parsed->nodes[iter].children_count() > 0) {
+            auto& node = parsed->nodes[iter];
+            std::optional<size_t> child_exact;
+            std::optional<size_t> child_end_plus_1;
+            for (size_t i = 0; i < node.children_count(); ++i) {
+                auto ci = node.children_begin_or_value() + i;
+                auto ts = scan.ResolveTextSpan(parsed->nodes[ci].symbol_span());
+                if (ts.offset() <= text_offset) {
+                    if (ts.offset() + ts.length() > text_offset) {
+                        child_exact = ci;
+                    } else if (ts.offset() + ts.length() == text_offset) {
+                        child_end_plus_1 = ci;
+                    }
+                }
+            }
+            auto child = child_exact.has_value() ? child_exact : child_end_plus_1;
+            if (!child.has_value()) break;
+            iter = *child;
+        }
+        return std::make_pair(*statement_id, iter);
+    };
+
+    // Wide arrays are binary searched
+    size_t ordered = 0;
+    for (size_t i = 0; i < parsed->nodes.size(); ++i) {
+        ordered += parsed->location_ordered_children[i] && parsed->nodes[i].children_count() >= 8;
+    }
+    EXPECT_GE(ordered, 2);
+
+    for (size_t offset = 0; offset <= text.size(); ++offset) {
+        ASSERT_EQ(parsed->FindNodeAtOffset(offset), find_exhaustive(offset)) << "offset=" << offset;
+    }
+}
+
 TEST(ParserTest, ExposesNormalizedStatementMetadata) {
     struct TestCase {
         std::string_view input;
@@ -405,6 +466,43 @@ TEST(ParserTest, RestoresCapturedPrefixStateStack) {
     }
 }
 
+TEST(ParserTest, ResumesPrefixParsesAtStatementBoundaries) {
+    std::string text;
+    for (size_t i = 0; i < 100; ++i) {
+        text += "select a, b + " + std::to_string(i) + " from t where x = 1 group by a;\n";
+        if (i == 50) text += "select from where;\n";
+    }
+    text += "select a from t where ";
+    rope::Rope buffer{1024};
+    buffer.Insert(0, text);
+    auto scanned = Scanner::Scan(buffer, 0, 2);
+    auto& symbols = scanned->GetSymbols();
+
+    // Collect the cursor symbols at the end, in the middle and at the begin
+    std::vector<ChunkBufferEntryID> cursors;
+    for (auto offset : {text.size() - 6, text.find("x = 1", text.size() / 2), text.find("b + 3")}) {
+        ChunkBufferEntryID cursor{0, 0};
+        while (!symbols.IsAtEOF(cursor) && symbols[cursor].location.offset() < offset) {
+            cursor = symbols.GetNext(cursor);
+        }
+        cursors.push_back(cursor);
+    }
+
+    for (auto& cursor : cursors) {
+        auto resumed = Parser::ParseUntilWithSnapshot(*scanned, cursor);
+        ASSERT_FALSE(scanned->lalr_snapshots.empty());
+
+        // Parse the prefix from the beginning without boundary snapshots
+        ParseContext context{*scanned};
+        Parser parser{context};
+        Parser::PrefixSnapshot expected;
+        parser.ParsePrefixToTarget(cursor, expected);
+        ASSERT_TRUE(expected.reached_target);
+        EXPECT_EQ(resumed.prefix.reached_target, expected.reached_target);
+        EXPECT_EQ(resumed.prefix.state_stack, expected.state_stack);
+    }
+}
+
 TEST(ParserTest, DetectsParsedScriptFeatures) {
     auto plain = ParseString("SELECT '|>' AS operator_text");
     EXPECT_EQ(plain->feature_flags, 0u);
@@ -452,4 +550,150 @@ VISUALIZE USING vegalite (mark => bar)
     EXPECT_EQ(source->node_type(), buffers::parser::NodeType::OBJECT_SQL_SELECT);
 }
 
+TEST(ParserTest, IncrementalParse) {
+    Catalog catalog;
+    Script script{catalog};
+    script.InsertTextAt(0, R"SQL(
+        create table Foo (a int, "B" text);
+        select a, b, name from foo where a not between 1 and 2;
+        select * from bar where;
+        select $1 from baz;
+        select 1;
+    )SQL");
+    script.Parse();
+
+    // Compare the incrementally parsed script with a full parse of the same text
+    auto check = [&](bool expect_reuse) {
+        script.Parse();
+        auto& have = *script.parsed_script;
+        auto expected = Parser::Parse(Scanner::Scan(script.text, script.text_version, script.catalog_entry_id));
+        auto& have_names = have.scanned_script->name_registry;
+        auto& expected_names = expected->scanned_script->name_registry;
+        ASSERT_EQ(have.nodes.size(), expected->nodes.size());
+        for (size_t i = 0; i < have.nodes.size(); ++i) {
+            auto& l = have.nodes[i];
+            auto& r = expected->nodes[i];
+            ASSERT_EQ(l.node_type(), r.node_type()) << i;
+            ASSERT_EQ(l.attribute_key(), r.attribute_key()) << i;
+            ASSERT_EQ(l.parent(), r.parent()) << i;
+            ASSERT_EQ(l.symbol_span().offset(), r.symbol_span().offset()) << i;
+            ASSERT_EQ(l.symbol_span().length(), r.symbol_span().length()) << i;
+            ASSERT_EQ(l.children_count(), r.children_count()) << i;
+            // Child node ids, name ids and values are shifted when splicing, they must match exactly
+            ASSERT_EQ(l.children_begin_or_value(), r.children_begin_or_value()) << i;
+            if (l.node_type() == buffers::parser::NodeType::NAME) {
+                ASSERT_EQ(have_names.At(l.children_begin_or_value()).text,
+                          expected_names.At(r.children_begin_or_value()).text)
+                    << i;
+            }
+        }
+        ASSERT_EQ(have.subtree_hashes, expected->subtree_hashes);
+        ASSERT_EQ(have.statements.size(), expected->statements.size());
+        for (size_t i = 0; i < have.statements.size(); ++i) {
+            ASSERT_EQ(have.statements[i].type, expected->statements[i].type) << i;
+            ASSERT_EQ(have.statements[i].root, expected->statements[i].root) << i;
+            ASSERT_EQ(have.statements[i].nodes_begin, expected->statements[i].nodes_begin) << i;
+            ASSERT_EQ(have.statements[i].node_count, expected->statements[i].node_count) << i;
+        }
+        ASSERT_EQ(have.errors.size(), expected->errors.size());
+        for (size_t i = 0; i < have.errors.size(); ++i) {
+            ASSERT_EQ(have.errors[i].location.offset(), expected->errors[i].location.offset()) << i;
+            ASSERT_EQ(have.errors[i].message, expected->errors[i].message) << i;
+        }
+        ASSERT_EQ(have.statement_separators.size(), expected->statement_separators.size());
+        for (size_t i = 0; i < have.statement_separators.size(); ++i) {
+            ASSERT_EQ(have.statement_separators[i].symbol_id, expected->statement_separators[i].symbol_id) << i;
+            ASSERT_EQ(have.statement_separators[i].nodes_begin, expected->statement_separators[i].nodes_begin) << i;
+            ASSERT_EQ(have.statement_separators[i].statements_begin,
+                      expected->statement_separators[i].statements_begin)
+                << i;
+            ASSERT_EQ(have.statement_separators[i].errors_begin, expected->statement_separators[i].errors_begin) << i;
+            ASSERT_EQ(have.statement_separators[i].vis_spec_spans_begin,
+                      expected->statement_separators[i].vis_spec_spans_begin)
+                << i;
+        }
+        ASSERT_EQ(have.vis_spec_spans, expected->vis_spec_spans);
+        ASSERT_EQ(have_names.GetSize(), expected_names.GetSize());
+        for (size_t i = 0; i < have_names.GetSize(); ++i) {
+            ASSERT_EQ(have_names.At(i).text, expected_names.At(i).text) << i;
+        }
+        if (expect_reuse) {
+            ASSERT_GT(have.reused_statements, 0u);
+            ASSERT_GT(script.timing_statistics.parser_last_reused_statements(), 0.0);
+        }
+    };
+
+    auto text = script.ToString();
+    // Extend an identifier in the second statement
+    script.InsertTextAt(text.find("foo where"), "x");
+    check(true);
+    // Break the fourth statement
+    text = script.ToString();
+    script.InsertTextAt(text.find("from baz"), "from ");
+    check(true);
+    // Fix the broken third statement, the parser no longer swallows the fourth one
+    text = script.ToString();
+    script.InsertTextAt(text.find("where;") + 5, " true");
+    check(true);
+    // Add an empty statement
+    text = script.ToString();
+    script.InsertTextAt(text.find("select 1"), ";");
+    check(true);
+    // Remove a statement separator
+    text = script.ToString();
+    script.EraseTextRange(text.find(");") + 1, 1);
+    check(true);
+    // Edit the last statement
+    text = script.ToString();
+    script.InsertTextAt(text.find("select 1") + 8, "0");
+    check(true);
+    // Replace the entire text
+    script.ReplaceText("select 1; select 2;");
+    check(false);
+}
+
+TEST(ParserTest, SubtreeHashesOnlyChangeInEditedSubtree) {
+    auto parse = [](std::string_view text) {
+        rope::Rope buffer{128};
+        buffer.Insert(0, text);
+        return Parser::Parse(Scanner::Scan(buffer, 0, 2));
+    };
+    auto before = parse("select a from foo where a = 1; select b from bar where b = 2; select c from baz where c = 3;");
+    auto after = parse("select a from foo where a = 1; select x from bar where b = 2; select c from baz where c = 3;");
+    ASSERT_EQ(before->statements.size(), 3);
+    ASSERT_EQ(before->nodes.size(), after->nodes.size());
+    ASSERT_EQ(before->subtree_hashes.size(), before->nodes.size());
+    ASSERT_EQ(after->subtree_hashes.size(), after->nodes.size());
+
+    // Collect the nodes with a changed hash
+    std::vector<bool> changed(before->nodes.size(), false);
+    size_t changed_count = 0;
+    for (size_t i = 0; i < before->nodes.size(); ++i) {
+        changed[i] = before->subtree_hashes[i] != after->subtree_hashes[i];
+        changed_count += changed[i];
+    }
+    // Only the edited name and its ancestors in the second statement change
+    auto& edited = before->statements[1];
+    ASSERT_TRUE(changed[edited.root]);
+    ASSERT_LT(changed_count, edited.node_count);
+    for (size_t i = 0; i < before->nodes.size(); ++i) {
+        if (!changed[i]) {
+            continue;
+        }
+        EXPECT_GE(i, edited.nodes_begin) << i;
+        EXPECT_LT(i, edited.nodes_begin + edited.node_count) << i;
+        if (i != edited.root) {
+            EXPECT_TRUE(changed[after->nodes[i].parent()]) << i;
+        }
+    }
+    // Exactly one leaf changed
+    size_t changed_leaves = 0;
+    for (size_t i = 0; i < after->nodes.size(); ++i) {
+        changed_leaves += changed[i] && after->nodes[i].node_type() == buffers::parser::NodeType::NAME;
+    }
+    EXPECT_EQ(changed_leaves, 1);
+    EXPECT_EQ(before->subtree_hashes[before->statements[0].root], after->subtree_hashes[after->statements[0].root]);
+    EXPECT_EQ(before->subtree_hashes[before->statements[2].root], after->subtree_hashes[after->statements[2].root]);
+}
+
 }  // namespace
@@ -0,0 +1,217 @@
+#include "dashql/utils/persistent_map.h"
+
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "dashql/utils/hash.h"
+#include "dashql/utils/persistent_hash_map.h"
+#include "gtest/gtest.h"
+
+using namespace dashql;
+
+namespace {
+
+template <typename Tree, typename Expected> void expectEqual(const Tree& tree, const Expected& expected) {
+    ASSERT_EQ(tree.size(), expected.size());
+    auto iter = tree.begin();
+    for (auto& [key, value] : expected) {
+        ASSERT_NE(iter, tree.end());
+        ASSERT_EQ(iter->first, key);
+        ASSERT_EQ(iter->second, value);
+        ++iter;
+    }
+    ASSERT_EQ(iter, tree.end());
+}
+
+template <typename Map, typename Expected> void expectEqualHashed(const Map& map, const Expected& expected) {
+    ASSERT_EQ(map.size(), expected.size());
+    for (auto& [key, value] : expected) {
+        auto* found = map.find(key);
+        ASSERT_NE(found, nullptr) << key;
+        ASSERT_EQ(*found, value);
+    }
+    size_t visited = 0;
+    map.ForEach([&](auto& key, auto& value) {
+        auto iter = expected.find(key);
+        ASSERT_NE(iter, expected.end());
+        ASSERT_EQ(iter->second, value);
+        ++visited;
+    });
+    ASSERT_EQ(visited, expected.size());
+}
+
+TEST(PersistentMapTest, InsertEraseRandom) {
+    std::mt19937 rng{42};
+    PersistentMap<uint32_t, uint32_t> tree;
+    std::map<uint32_t, uint32_t> expected;
+    for (size_t i = 0; i < 20000; ++i) {
+        uint32_t key = rng() % 2000;
+        if (rng() % 3 == 0) {
+            ASSERT_EQ(tree.erase(key), expected.erase(key) == 1);
+        } else {
+            ASSERT_EQ(tree.insert({key, static_cast<uint32_t>(i)}), expected.insert({key, i}).second);
+        }
+    }
+    expectEqual(tree, expected);
+}
+
+TEST(PersistentMapTest, Bounds) {
+    PersistentMap<uint32_t, uint32_t> tree;
+    std::map<uint32_t, uint32_t> expected;
+    for (uint32_t i = 0; i < 1000; i += 3) {
+        tree.insert({i, i});
+        expected.insert({i, i});
+    }
+    for (uint32_t i = 0; i < 1010; ++i) {
+        auto lb = tree.lower_bound(i);
+        auto expected_lb = expected.lower_bound(i);
+        if (expected_lb == expected.end()) {
+            ASSERT_EQ(lb, tree.end());
+        } else {
+            ASSERT_NE(lb, tree.end());
+            ASSERT_EQ(lb->first, expected_lb->first);
+        }
+        auto ub = tree.upper_bound(i);
+        auto expected_ub = expected.upper_bound(i);
+        if (expected_ub == expected.end()) {
+            ASSERT_EQ(ub, tree.end());
+        } else {
+            ASSERT_NE(ub, tree.end());
+            ASSERT_EQ(ub->first, expected_ub->first);
+        }
+        size_t n = 0;
+        for (auto iter = lb; iter != ub; ++iter) {
+            ++n;
+        }
+        ASSERT_EQ(n, static_cast<size_t>(std::distance(expected_lb, expected_ub)));
+        ASSERT_EQ(tree.find(i) != tree.end(), expected.contains(i));
+        ASSERT_EQ(tree.contains(i), expected.contains(i));
+    }
+}
+
+TEST(PersistentMapTest, TupleKeys) {
+    PersistentSet<std::tuple<std::string_view, uint32_t>> set;
+    set.insert({"b", 2});
+    set.insert({"a", 1});
+    set.insert({"b", 1});
+    set.insert({"c", 0});
+    std::vector<std::tuple<std::string_view, uint32_t>> in_b;
+    for (auto iter = set.lower_bound({"b", 0}), end = set.lower_bound({"c", 0}); iter != end; ++iter) {
+        in_b.push_back(*iter);
+    }
+    ASSERT_EQ(in_b.size(), 2);
+    ASSERT_EQ(std::get<1>(in_b[0]), 1);
+    ASSERT_EQ(std::get<1>(in_b[1]), 2);
+}
+
+TEST(PersistentMapTest, CopiesAreNotAffectedByModifications) {
+    std::mt19937 rng{7};
+    PersistentMap<uint32_t, uint32_t> tree;
+    std::map<uint32_t, uint32_t> expected;
+    std::vector<std::pair<PersistentMap<uint32_t, uint32_t>, std::map<uint32_t, uint32_t>>> versions;
+    for (size_t i = 0; i < 5000; ++i) {
+        uint32_t key = rng() % 500;
+        if (rng() % 2 == 0) {
+            tree.erase(key);
+            expected.erase(key);
+        } else {
+            tree.insert({key, static_cast<uint32_t>(i)});
+            expected.insert({key, i});
+        }
+        if (i % 250 == 0) {
+            versions.push_back({tree, expected});
+        }
+    }
+    expectEqual(tree, expected);
+    for (auto& [version_tree, version_expected] : versions) {
+        expectEqual(version_tree, version_expected);
+    }
+    tree.clear();
+    for (auto& [version_tree, version_expected] : versions) {
+        expectEqual(version_tree, version_expected);
+    }
+}
+
+TEST(PersistentHashMapTest, InsertEraseRandom) {
+    std::mt19937 rng{42};
+    PersistentHashMap<std::string, uint32_t, StringHasher> map;
+    std::unordered_map<std::string, uint32_t> expected;
+    for (size_t i = 0; i < 20000; ++i) {
+        auto key = std::to_string(rng() % 3000);
+        if (rng() % 3 == 0) {
+            ASSERT_EQ(map.erase(std::string_view{key}), expected.erase(key) == 1);
+        } else {
+            auto [value, inserted] = map.try_emplace(key, i);
+            auto [expected_iter, expected_inserted] = expected.insert({key, i});
+            ASSERT_EQ(inserted, expected_inserted);
+            ASSERT_EQ(value, expected_iter->second);
+        }
+    }
+    expectEqualHashed(map, expected);
+}
+
+/// A hasher that maps all keys to few hash values to exercise collisions
+struct CollidingHasher {
+    size_t operator()(uint32_t key) const { return key % 3; }
+};
+
+TEST(PersistentHashMapTest, Collisions) {
+    PersistentHashMap<uint32_t, uint32_t, CollidingHasher> map;
+    std::unordered_map<uint32_t, uint32_t> expected;
+    for (uint32_t i = 0; i < 100; ++i) {
+        map.try_emplace(i, i);
+        expected.insert({i, i});
+    }
+    expectEqualHashed(map, expected);
+    auto copy = map;
+    auto copy_expected = expected;
+    for (uint32_t i = 0; i < 100; i += 2) {
+        ASSERT_TRUE(map.erase(i));
+        expected.erase(i);
+    }
+    *map.find_mutable(1u) = 42;
+    expected[1] = 42;
+    expectEqualHashed(map, expected);
+    expectEqualHashed(copy, copy_expected);
+}
+
+TEST(PersistentHashMapTest, CopiesAreNotAffectedByModifications) {
+    std::mt19937 rng{7};
+    PersistentHashMap<uint32_t, std::vector<uint32_t>> map;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> expected;
+    std::vector<std::pair<decltype(map), decltype(expected)>> versions;
+    for (uint32_t i = 0; i < 5000; ++i) {
+        uint32_t key = rng() % 300;
+        switch (rng() % 3) {
+            case 0:
+                map.erase(key);
+                expected.erase(key);
+                break;
+            case 1:
+                map.try_emplace(key).first.push_back(i);
+                expected[key].push_back(i);
+                break;
+            case 2:
+                if (auto* values = map.find_mutable(key)) {
+                    values->clear();
+                    expected[key].clear();
+                }
+                break;
+        }
+        if (i % 250 == 0) {
+            versions.push_back({map, expected});
+        }
+    }
+    expectEqualHashed(map, expected);
+    for (auto& [version_map, version_expected] : versions) {
+        expectEqualHashed(version_map, version_expected);
+    }
+}
+
+}  // namespace
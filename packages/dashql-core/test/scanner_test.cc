@@ -263,4 +263,105 @@ TEST(ScannerTest, TrailingComments) {
     ASSERT_EQ(scanned->comments.size(), 1);
 }
 
+TEST(ScannerTest, IncrementalRescan) {
+    Catalog catalog;
+    Script script{catalog};
+    script.InsertTextAt(0, R"SQL(
+        create table Foo (a int, "B" text); -- first
+        select a, b from foo where a not between 1 and 2;
+        /* block */ select * from bar;
+        select 'x', y from baz;
+    )SQL");
+    script.Scan();
+
+    // Compare the incrementally scanned script with a full scan of the same text
+    auto check = [&]() {
+        script.Scan();
+        auto& have = *script.scanned_script;
+        auto expected = parser::Scanner::Scan(script.text, script.text_version, script.catalog_entry_id);
+        ASSERT_EQ(have.GetInput(), expected->GetInput());
+        ASSERT_EQ(have.symbols.GetSize(), expected->symbols.GetSize());
+        for (size_t i = 0; i < have.symbols.GetSize(); ++i) {
+            auto& l = have.symbols[i];
+            auto& r = expected->symbols[i];
+            ASSERT_EQ(l.kind(), r.kind()) << i;
+            ASSERT_EQ(l.location.offset(), r.location.offset()) << i;
+            ASSERT_EQ(l.location.length(), r.location.length()) << i;
+            if (l.kind() == parser::Parser::symbol_kind::S_IDENT) {
+                ASSERT_EQ(l.value.as<size_t>(), r.value.as<size_t>()) << i;
+                ASSERT_EQ(have.name_registry.At(l.value.as<size_t>()).text,
+                          expected->name_registry.At(r.value.as<size_t>()).text);
+            }
+        }
+        ASSERT_EQ(have.name_registry.GetSize(), expected->name_registry.GetSize());
+        ASSERT_EQ(have.line_breaks.size(), expected->line_breaks.size());
+        for (size_t i = 0; i < have.line_breaks.size(); ++i) {
+            ASSERT_EQ(have.line_breaks[i].offset(), expected->line_breaks[i].offset());
+        }
+        ASSERT_EQ(have.comments.size(), expected->comments.size());
+        for (size_t i = 0; i < have.comments.size(); ++i) {
+            ASSERT_EQ(have.comments[i].offset(), expected->comments[i].offset());
+            ASSERT_EQ(have.comments[i].length(), expected->comments[i].length());
+        }
+        ASSERT_EQ(have.errors.size(), expected->errors.size());
+    };
+
+    // Get the symbol ids of the statement separators
+    auto semicolons = [&]() {
+        std::vector<size_t> ids;
+        for (size_t i = 0; i < script.scanned_script->symbols.GetSize(); ++i) {
+            if (script.scanned_script->symbols[i].kind() == parser::Parser::symbol_kind::S_SEMICOLON) {
+                ids.push_back(i);
+            }
+        }
+        return ids;
+    };
+    // Get the reused symbols of the latest scan
+    auto reused = [&]() {
+        EXPECT_TRUE(script.scanned_script->reused_symbols.has_value());
+        return script.scanned_script->reused_symbols.value_or(ScannedScript::ReusedSymbols{});
+    };
+
+    auto text = script.ToString();
+    // Extend an identifier in the second statement.
+    // The first statement is reused and the rescan resynchronizes right after the identifier.
+    script.InsertTextAt(text.find("foo where"), "x");
+    check();
+    auto semis = semicolons();
+    ASSERT_EQ(semis.size(), 4);
+    EXPECT_EQ(reused().prefix_count, semis[0] + 1);
+    EXPECT_LT(reused().suffix_begin, semis[1]);
+    EXPECT_EQ(reused().previous_suffix_begin, reused().suffix_begin);
+    // Rename a table in the third statement
+    text = script.ToString();
+    script.EraseTextRange(text.find("bar"), 3);
+    script.InsertTextAt(text.find("bar"), "Qux");
+    check();
+    semis = semicolons();
+    EXPECT_EQ(reused().prefix_count, semis[1] + 1);
+    EXPECT_LE(reused().suffix_begin, semis[2]);
+    // Open a string literal that swallows the rest of the script
+    text = script.ToString();
+    script.InsertTextAt(text.find("select *"), "'");
+    check();
+    EXPECT_EQ(reused().prefix_count, semis[1] + 1);
+    // Close it again
+    text = script.ToString();
+    script.EraseTextRange(text.find("'select *"), 1);
+    check();
+    EXPECT_EQ(reused().prefix_count, semis[1] + 1);
+    // Remove a statement separator.
+    // No statement ends before the edit, but everything after the separator is reused.
+    text = script.ToString();
+    script.EraseTextRange(text.find("; -- first"), 1);
+    check();
+    semis = semicolons();
+    EXPECT_EQ(reused().prefix_count, 0);
+    EXPECT_LT(reused().suffix_begin, semis[0]);
+    EXPECT_EQ(reused().previous_suffix_begin, reused().suffix_begin + 1);
+    // Replace the entire text
+    script.ReplaceText("select 1; select 2;");
+    check();
+}
+
 }  // namespace
@@ -1,5 +1,12 @@
 #include "dashql/script.h"
 
+#include <flatbuffers/flatbuffer_builder.h>
+
+#include <cstring>
+#include <memory>
+#include <span>
+#include <string>
+
 #include "dashql/buffers/index_generated.h"
 #include "dashql/catalog.h"
 #include "dashql/exception.h"
@@ -181,4 +188,131 @@ TEST(ScriptTest, ConvertsTextSpanToString) {
     EXPECT_EQ(script.ToString(TextSpan(100, 1)), "");
 }
 
+TEST(ScriptTest, BackgroundAnalysisPublishesLatestVersion) {
+    constexpr std::string_view text = "select a, b from foo f, bar b where f.x = b.y;";
+    Catalog catalog;
+    Script script{catalog};
+    for (size_t i = 0; i < text.size(); ++i) {
+        script.InsertTextAt(i, text.substr(i, 1));
+        script.AnalyzeInBackground();
+        // Published versions are stale at worst, never inconsistent
+        auto* cursor = script.MoveCursor(i + 1);
+        ASSERT_NE(cursor, nullptr);
+        EXPECT_EQ(cursor->analyzed_script, script.analyzed_script);
+        if (script.analyzed_script) {
+            EXPECT_EQ(script.analyzed_script->parsed_script, script.parsed_script);
+            EXPECT_EQ(script.parsed_script->scanned_script, script.scanned_script);
+            EXPECT_LE(script.scanned_script->text_version, script.text_version);
+        }
+    }
+    ASSERT_NO_THROW(script.WaitForBackgroundAnalysis());
+    ASSERT_NE(script.analyzed_script, nullptr);
+    EXPECT_EQ(script.scanned_script->text_version, script.text_version);
+    EXPECT_EQ(script.cursor->analyzed_script, script.analyzed_script);
+
+    // The published analysis is up to date, analyzing synchronously keeps it
+    auto analyzed = script.analyzed_script;
+    ASSERT_NO_THROW(script.Analyze());
+    EXPECT_EQ(script.analyzed_script, analyzed);
+
+    // The analysis does not change
+    Script fresh{catalog};
+    fresh.InsertTextAt(0, text);
+    ASSERT_NO_THROW(fresh.Analyze());
+    EXPECT_EQ(script.parsed_script->nodes.size(), fresh.parsed_script->nodes.size());
+    EXPECT_EQ(script.analyzed_script->table_references.GetSize(), fresh.analyzed_script->table_references.GetSize());
+    EXPECT_EQ(script.analyzed_script->expressions.GetSize(), fresh.analyzed_script->expressions.GetSize());
+
+    // Completions see the published analysis
+    script.MoveCursor(text.find("foo") + 1);
+    ASSERT_NO_THROW(script.CompleteAtCursor(10));
+}
+
+TEST(ScriptTest, BackgroundAnalysisAfterCatalogChange) {
+    Catalog catalog;
+    Script schema{catalog};
+    schema.InsertTextAt(0, "create table foo (a int, b int);");
+    ASSERT_NO_THROW(schema.Analyze());
+
+    Script script{catalog};
+    script.InsertTextAt(0, "select a from foo;");
+    script.AnalyzeInBackground();
+    ASSERT_NO_THROW(script.WaitForBackgroundAnalysis());
+    ASSERT_NE(script.analyzed_script, nullptr);
+    using RelationExpression = AnalyzedScript::TableReference::RelationExpression;
+    auto* rel_expr = std::get_if<RelationExpression>(&script.analyzed_script->table_references[0].inner);
+    ASSERT_NE(rel_expr, nullptr);
+    EXPECT_FALSE(rel_expr->resolved_table.has_value());
+
+    // The catalog is modified while no analysis is running
+    ASSERT_NO_THROW(catalog.LoadScript(schema, 0));
+    script.AnalyzeInBackground();
+    ASSERT_NO_THROW(script.WaitForBackgroundAnalysis());
+    rel_expr = std::get_if<RelationExpression>(&script.analyzed_script->table_references[0].inner);
+    ASSERT_NE(rel_expr, nullptr);
+    EXPECT_TRUE(rel_expr->resolved_table.has_value());
+}
+
+TEST(ScriptTest, BackgroundAnalysisWhileModifyingCatalog) {
+    constexpr size_t ITERATIONS = 32;
+    constexpr CatalogEntryID POOL_ID = 1000;
+    Catalog catalog;
+    ASSERT_NO_THROW(catalog.AddDescriptorPool(POOL_ID, 0));
+
+    // Pack a schema descriptor with a single table
+    auto pack_descriptor = [](std::string table_name) {
+        buffers::catalog::SchemaDescriptorT descriptor;
+        descriptor.database_name = "db1";
+        descriptor.schema_name = "schema1";
+        auto table = std::make_unique<buffers::catalog::SchemaTableT>();
+        table->table_name = std::move(table_name);
+        auto column = std::make_unique<buffers::catalog::SchemaTableColumnT>();
+        column->column_name = "a";
+        table->columns.push_back(std::move(column));
+        descriptor.tables.push_back(std::move(table));
+        flatbuffers::FlatBufferBuilder fb;
+        fb.Finish(buffers::catalog::SchemaDescriptor::Pack(fb, &descriptor));
+        auto buffer = std::make_unique<std::byte[]>(fb.GetSize());
+        std::memcpy(buffer.get(), fb.GetBufferPointer(), fb.GetSize());
+        return std::make_pair(std::move(buffer), fb.GetSize());
+    };
+
+    auto last = std::to_string(ITERATIONS - 1);
+    Script script{catalog};
+    script.InsertTextAt(0, "select * from t_" + last + ", schema1.d_" + last);
+
+    // Load scripts and descriptors while the worker analyzes every edit
+    std::vector<std::unique_ptr<Script>> schemas;
+    for (size_t i = 0; i < ITERATIONS; ++i) {
+        script.InsertTextAt(script.ToString().size(), " ");
+        script.AnalyzeInBackground();
+
+        auto id = std::to_string(i);
+        auto& schema = schemas.emplace_back(std::make_unique<Script>(catalog));
+        schema->InsertTextAt(0, "create table t_" + id + " (a int);");
+        ASSERT_NO_THROW(schema->Analyze());
+        ASSERT_NO_THROW(catalog.LoadScript(*schema, 1));
+
+        auto [buffer, size] = pack_descriptor("d_" + id);
+        std::span<const std::byte> data{buffer.get(), size};
+        ASSERT_NO_THROW(catalog.AddSchemaDescriptor(POOL_ID, data, std::move(buffer), size));
+        ASSERT_NO_THROW(script.PollBackgroundAnalysis());
+    }
+    ASSERT_NO_THROW(script.WaitForBackgroundAnalysis());
+    ASSERT_NE(script.analyzed_script, nullptr);
+    EXPECT_EQ(script.scanned_script->text_version, script.text_version);
+
+    // An analysis started after the last modification resolves both tables
+    script.InsertTextAt(script.ToString().size(), " ");
+    script.AnalyzeInBackground();
+    ASSERT_NO_THROW(script.WaitForBackgroundAnalysis());
+    ASSERT_EQ(script.analyzed_script->table_references.GetSize(), 2);
+    using RelationExpression = AnalyzedScript::TableReference::RelationExpression;
+    for (size_t i = 0; i < 2; ++i) {
+        auto* rel_expr = std::get_if<RelationExpression>(&script.analyzed_script->table_references[i].inner);
+        ASSERT_NE(rel_expr, nullptr);
+        EXPECT_TRUE(rel_expr->resolved_table.has_value()) << i;
+    }
+}
+
 }  // namespace
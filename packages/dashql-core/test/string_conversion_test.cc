@@ -47,4 +47,34 @@ TEST(StringConversionTest, EmbeddedQuotesAreDoubled) {
     EXPECT_EQ(quote("a\"b"), "\"a\"\"b\"");
 }
 
+TEST(StringConversionTest, FoldLowerMatchesScalar) {
+    // Cover the padded tail and multiple blocks, including bytes next to the upper-case range and non-ASCII bytes
+    std::string alphabet = "@AZ[`az{_$09\x80\xC1\xFF";
+    for (size_t n = 0; n < 40; ++n) {
+        for (size_t shift = 0; shift < alphabet.size(); ++shift) {
+            std::string text;
+            for (size_t i = 0; i < n; ++i) {
+                text.push_back(alphabet[(i * 7 + shift) % alphabet.size()]);
+            }
+            std::string out(n, '\0');
+            bool all_lower = fold_lower_fuzzy(text, out.data());
+            std::string expected = text;
+            for (auto& c : expected) {
+                c = static_cast<char>(tolower_fuzzy(c));
+            }
+            EXPECT_EQ(out, expected);
+            EXPECT_EQ(all_lower, !anyupper_fuzzy(text));
+        }
+    }
+}
+
+TEST(StringConversionTest, FoldLowerDetectsLowerCase) {
+    std::string out(32, '\0');
+    EXPECT_TRUE(fold_lower_fuzzy("ss_sold_date_sk", out.data()));
+    EXPECT_FALSE(fold_lower_fuzzy("SS_SOLD_DATE_SK", out.data()));
+    EXPECT_EQ(out.substr(0, 15), "ss_sold_date_sk");
+    EXPECT_FALSE(fold_lower_fuzzy("customer_demographicS", out.data()));
+    EXPECT_EQ(out.substr(0, 21), "customer_demographics");
+}
+
 }  // namespace
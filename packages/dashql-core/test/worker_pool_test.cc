@@ -0,0 +1,60 @@
+#include "dashql/utils/worker_pool.h"
+
+#include <atomic>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+using namespace dashql;
+
+namespace {
+
+TEST(WorkerPoolTest, RunsEveryIterationOnce) {
+    WorkerPool pool{3};
+    for (size_t n : {0, 1, 2, 7, 1000}) {
+        std::vector<std::atomic<size_t>> runs(n);
+        pool.ParallelFor(n, [&](size_t i) { runs[i].fetch_add(1); });
+        for (size_t i = 0; i < n; ++i) {
+            ASSERT_EQ(runs[i].load(), 1) << "n=" << n << " i=" << i;
+        }
+    }
+}
+
+TEST(WorkerPoolTest, ReusesWorkersAcrossLoops) {
+    WorkerPool pool{4};
+    std::vector<size_t> values(64);
+    for (size_t loop = 0; loop < 500; ++loop) {
+        pool.ParallelFor(values.size(), [&](size_t i) { values[i] += i; });
+    }
+    for (size_t i = 0; i < values.size(); ++i) {
+        ASSERT_EQ(values[i], 500 * i);
+    }
+}
+
+TEST(WorkerPoolTest, SerializesLoopsOfDifferentThreads) {
+    WorkerPool pool{2};
+    std::atomic<size_t> sum{0};
+    std::vector<std::thread> callers;
+    for (size_t t = 0; t < 4; ++t) {
+        callers.emplace_back([&]() {
+            for (size_t loop = 0; loop < 100; ++loop) {
+                pool.ParallelFor(10, [&](size_t i) { sum.fetch_add(i); });
+            }
+        });
+    }
+    for (auto& caller : callers) {
+        caller.join();
+    }
+    ASSERT_EQ(sum.load(), 4 * 100 * 45);
+}
+
+TEST(WorkerPoolTest, WithoutWorkers) {
+    WorkerPool pool{0};
+    std::vector<size_t> order;
+    pool.ParallelFor(5, [&](size_t i) { order.push_back(i); });
+    ASSERT_EQ(order, (std::vector<size_t>{0, 1, 2, 3, 4}));
+}
+
+}  // namespace